@@ -25,6 +25,9 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef __SSE2__
+#   include <emmintrin.h>
+#endif
 
 #include "common.h"
 #include "parser.h"
@@ -49,7 +52,7 @@ ly_vecode(const struct ly_ctx *ctx)
 
     struct ly_err_item *i;
 
-    i = ly_err_first(ctx);
+    i = ly_err_first_int(ctx);
     if (i) {
         return i->prev->vecode;
     }
@@ -64,7 +67,7 @@ ly_errmsg(const struct ly_ctx *ctx)
 
     struct ly_err_item *i;
 
-    i = ly_err_first(ctx);
+    i = ly_err_first_int(ctx);
     if (i) {
         return i->prev->msg;
     }
@@ -79,8 +82,9 @@ ly_errpath(const struct ly_ctx *ctx)
 
     struct ly_err_item *i;
 
-    i = ly_err_first(ctx);
+    i = ly_err_first_int(ctx);
     if (i) {
+        ly_err_path_finish(i->prev);
         return i->prev->path;
     }
 
@@ -94,7 +98,7 @@ ly_errapptag(const struct ly_ctx *ctx)
 
     struct ly_err_item *i;
 
-    i = ly_err_first(ctx);
+    i = ly_err_first_int(ctx);
     if (i) {
         return i->prev->apptag;
     }
@@ -102,16 +106,79 @@ ly_errapptag(const struct ly_ctx *ctx)
     return NULL;
 }
 
+struct ly_err_item *
+ly_err_first_int(const struct ly_ctx *ctx)
+{
+    if (!ctx) {
+        return NULL;
+    }
+
+    return pthread_getspecific(ctx->errlist_key);
+}
+
+uint32_t
+ly_err_count(const struct ly_err_item *eitem)
+{
+    uint32_t count = 0;
+
+    for (; eitem; eitem = eitem->next) {
+        if (eitem->level == LY_LLERR) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+struct ly_err_item *
+ly_err_detach(const struct ly_ctx *ctx)
+{
+    struct ly_err_item *first;
+
+    first = pthread_getspecific(ctx->errlist_key);
+    pthread_setspecific(ctx->errlist_key, NULL);
+
+    return first;
+}
+
+void
+ly_err_attach(const struct ly_ctx *ctx, struct ly_err_item *eitem)
+{
+    struct ly_err_item *first, *last;
+
+    if (!eitem) {
+        return;
+    }
+
+    first = pthread_getspecific(ctx->errlist_key);
+    last = eitem->prev;
+    if (!first) {
+        pthread_setspecific(ctx->errlist_key, eitem);
+    } else {
+        /* append the items */
+        ((struct ly_err_item_int *)first)->err_count += ((struct ly_err_item_int *)eitem)->err_count;
+        first->prev->next = eitem;
+        eitem->prev = first->prev;
+        first->prev = last;
+    }
+
+    ly_errno = last->no;
+}
+
 API struct ly_err_item *
 ly_err_first(const struct ly_ctx *ctx)
 {
     FUN_IN;
 
-    if (!ctx) {
-        return NULL;
+    struct ly_err_item *first, *i;
+
+    first = ly_err_first_int(ctx);
+
+    /* the caller may traverse all the items */
+    for (i = first; i; i = i->next) {
+        ly_err_path_finish(i);
     }
 
-    return pthread_getspecific(ctx->errlist_key);
+    return first;
 }
 
 void
@@ -136,7 +203,7 @@ ly_err_clean(struct ly_ctx *ctx, struct ly_err_item *eitem)
 
     struct ly_err_item *i, *first;
 
-    first = ly_err_first(ctx);
+    first = ly_err_first_int(ctx);
     if (first == eitem) {
         eitem = NULL;
     }
@@ -146,6 +213,7 @@ ly_err_clean(struct ly_ctx *ctx, struct ly_err_item *eitem)
         assert(i);
         i->next = NULL;
         first->prev = i;
+        ((struct ly_err_item_int *)first)->err_count -= ly_err_count(eitem);
         /* free this err and newer */
         ly_err_free(eitem);
         /* update errno */
@@ -1375,8 +1443,12 @@ lyb_hash(struct lys_node *sibling, uint8_t collision_id)
     LYB_HASH hash;
 
 #ifdef LY_ENABLED_CACHE
-    if ((collision_id < LYS_NODE_HASH_COUNT) && sibling->hash[collision_id]) {
-        return sibling->hash[collision_id];
+    /* the hash may be computed by several (LYB parser) threads at once, they all store the same value */
+    if (collision_id < LYS_NODE_HASH_COUNT) {
+        hash = __atomic_load_n(&sibling->hash[collision_id], __ATOMIC_RELAXED);
+        if (hash) {
+            return hash;
+        }
     }
 #endif
 
@@ -1404,7 +1476,7 @@ lyb_hash(struct lys_node *sibling, uint8_t collision_id)
     /* save this hash */
 #ifdef LY_ENABLED_CACHE
     if (collision_id < LYS_NODE_HASH_COUNT) {
-        sibling->hash[collision_id] = hash;
+        __atomic_store_n(&sibling->hash[collision_id], hash, __ATOMIC_RELAXED);
     }
 #endif
 
@@ -1463,3 +1535,46 @@ ly_strlen_utf8(const char *str)
     for (len = 0, clen = strlen(str), ptr = str; *ptr && len < clen; ++len, ptr += UTF8LEN(*ptr));
     return len;
 }
+
+size_t
+ly_strlen_noesc(const char *str, size_t len, int json)
+{
+    size_t i = 0;
+    unsigned char c;
+#ifdef __SSE2__
+    __m128i v, m;
+    int mask;
+
+    /* only whole blocks inside the string are loaded, the rest is checked below */
+    for (; i + 16 <= len; i += 16) {
+        v = _mm_loadu_si128((const __m128i *)(str + i));
+        m = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+        if (json) {
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+            /* control characters, min(v, 0x1f) == v means v <= 0x1f */
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v));
+        } else {
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('&')));
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('<')));
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('>')));
+        }
+        mask = _mm_movemask_epi8(m);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < len; ++i) {
+        c = str[i];
+        if (json) {
+            if ((c < 0x20) || (c == '"') || (c == '\\')) {
+                break;
+            }
+        } else if ((c == '&') || (c == '<') || (c == '>') || (c == '"')) {
+            break;
+        }
+    }
+
+    return i;
+}
@@ -30,6 +30,7 @@
 #include "parser.h"
 #include "tree_internal.h"
 #include "resolve.h"
+#include "validation.h"
 
 /*
  * counter for references to the extensions plugins (for the number of contexts)
@@ -69,6 +70,205 @@ static struct internal_modules_s {
     {"ietf-yang-library", IETF_YANG_LIB_REV, (const char*)ietf_yang_library_2019_01_04_yin, 1, LYS_IN_YIN}
 };
 
+/**
+ * @brief Check a module matching the searched key and remember it if it is the best match so far.
+ *
+ * @param[in] mod Module with the matching key.
+ * @param[in] revision Requested revision, NULL for the newest (or implemented) one.
+ * @param[in] with_disabled Whether disabled modules can match.
+ * @param[in] implemented Whether only the implemented module is requested, used only without \p revision.
+ * @param[in,out] result Best matching module so far.
+ * @return 1 if \p result is final and the search can stop, 0 otherwise.
+ */
+static int
+ly_ctx_get_module_match(struct lys_module *mod, const char *revision, int with_disabled, int implemented,
+                        struct lys_module **result)
+{
+    if (!with_disabled && mod->disabled) {
+        /* skip the disabled modules */
+        return 0;
+    }
+
+    if (!revision) {
+        /* compare revisons and remember the newest one */
+        if (*result) {
+            if (!mod->rev_size) {
+                /* the current have no revision, keep the previous with some revision */
+                return 0;
+            }
+            if ((*result)->rev_size && strcmp(mod->rev[0].date, (*result)->rev[0].date) < 0) {
+                /* the previous found matching module has a newer revision */
+                return 0;
+            }
+        }
+        if (implemented) {
+            if (mod->implemented) {
+                /* we have the implemented revision */
+                *result = mod;
+                return 1;
+            }
+            /* do not remember the result, we are supposed to return the implemented revision
+             * not the newest one */
+            return 0;
+        }
+
+        /* remember the current match and search for newer version */
+        *result = mod;
+    } else if (mod->rev_size && !strcmp(revision, mod->rev[0].date)) {
+        /* matching revision */
+        *result = mod;
+        return 1;
+    }
+
+    return 0;
+}
+
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Record of the module index, every module of the context is stored under its name and its namespace.
+ */
+struct ly_ctx_mod_idx_rec {
+    const char *key;            /* module name or namespace */
+    size_t key_len;             /* length of key */
+    int by_ns;                  /* whether key is the namespace */
+    struct lys_module *mod;     /* indexed module, NULL in lookup records */
+};
+
+static int
+ly_ctx_mod_idx_equal(void *val1_p, void *val2_p, int mod, void *UNUSED(cb_data))
+{
+    struct ly_ctx_mod_idx_rec *rec1, *rec2;
+
+    rec1 = (struct ly_ctx_mod_idx_rec *)val1_p;
+    rec2 = (struct ly_ctx_mod_idx_rec *)val2_p;
+
+    if (rec1->by_ns != rec2->by_ns) {
+        return 0;
+    }
+    if (mod) {
+        /* removing (or inserting) a specific module */
+        return rec1->mod == rec2->mod;
+    }
+    return (rec1->key_len == rec2->key_len) && !strncmp(rec1->key, rec2->key, rec1->key_len);
+}
+
+static uint32_t
+ly_ctx_mod_idx_hash(const char *key, size_t key_len, int by_ns)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, key, key_len);
+    hash = dict_hash_multi(hash, by_ns ? "n" : "m", 1);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+int
+ly_ctx_mod_idx_add(struct lys_module *module)
+{
+    struct hash_table *ht = module->ctx->models.idx;
+    struct ly_ctx_mod_idx_rec rec;
+
+    if (!ht) {
+        return EXIT_SUCCESS;
+    }
+
+    rec.mod = module;
+    for (rec.by_ns = 0; rec.by_ns < 2; ++rec.by_ns) {
+        rec.key = rec.by_ns ? module->ns : module->name;
+        rec.key_len = strlen(rec.key);
+        if (lyht_insert(ht, &rec, ly_ctx_mod_idx_hash(rec.key, rec.key_len, rec.by_ns), NULL) == -1) {
+            LOGINT(module->ctx);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+void
+ly_ctx_mod_idx_remove(struct lys_module *module)
+{
+    struct hash_table *ht = module->ctx->models.idx;
+    struct ly_ctx_mod_idx_rec rec;
+
+    if (!ht) {
+        return;
+    }
+
+    rec.mod = module;
+    for (rec.by_ns = 0; rec.by_ns < 2; ++rec.by_ns) {
+        rec.key = rec.by_ns ? module->ns : module->name;
+        if (!rec.key) {
+            /* not parsed completely, cannot be in the index */
+            return;
+        }
+        rec.key_len = strlen(rec.key);
+        /* the module may not be in the index (failed parsing), it is fine */
+        lyht_remove(ht, &rec, ly_ctx_mod_idx_hash(rec.key, rec.key_len, rec.by_ns));
+    }
+
+    /* lookups would move the records in place of the removed ones, but they must not modify the index
+     * because modules can be searched for by several threads at once (LYB parser threads) */
+    lyht_rehash(ht);
+}
+
+int
+ly_ctx_mod_idx_next(const struct ly_ctx *ctx, const char *key, size_t key_len, int by_ns, struct lys_module **module)
+{
+    struct ly_ctx_mod_idx_rec rec, prev, *match;
+    uint32_t hash;
+    int r;
+
+    if (!ctx->models.idx) {
+        return -1;
+    }
+
+    rec.key = key;
+    rec.key_len = key_len ? key_len : strlen(key);
+    rec.by_ns = by_ns;
+    rec.mod = NULL;
+    hash = ly_ctx_mod_idx_hash(rec.key, rec.key_len, by_ns);
+
+    if (!*module) {
+        r = lyht_find(ctx->models.idx, &rec, hash, (void **)&match);
+    } else {
+        /* find the record of the previous module and continue from it */
+        prev = rec;
+        prev.mod = *module;
+        r = lyht_find_next(ctx->models.idx, &prev, hash, (void **)&match);
+    }
+    while (!r && !ly_ctx_mod_idx_equal(&rec, match, 0, NULL)) {
+        /* different key with the same hash */
+        r = lyht_find_next(ctx->models.idx, match, hash, (void **)&match);
+    }
+
+    *module = r ? NULL : match->mod;
+    return r ? 1 : 0;
+}
+
+#else
+
+int
+ly_ctx_mod_idx_add(struct lys_module *UNUSED(module))
+{
+    return EXIT_SUCCESS;
+}
+
+void
+ly_ctx_mod_idx_remove(struct lys_module *UNUSED(module))
+{
+    return;
+}
+
+int
+ly_ctx_mod_idx_next(const struct ly_ctx *UNUSED(ctx), const char *UNUSED(key), size_t UNUSED(key_len),
+                    int UNUSED(by_ns), struct lys_module **UNUSED(module))
+{
+    return -1;
+}
+
+#endif
+
 API unsigned int
 ly_ctx_internal_modules_count(struct ly_ctx *ctx)
 {
@@ -98,6 +298,17 @@ ly_ctx_new(const char *search_dir, int options)
     /* dictionary */
     lydict_init(&ctx->dict);
 
+#ifdef LY_ENABLED_CACHE
+    /* schema node index, created on demand */
+    pthread_rwlock_init(&ctx->snode_idx_lock, NULL);
+
+    /* unique indexes of data, created on demand */
+    pthread_mutex_init(&ctx->uniq_idx_lock, NULL);
+#endif
+
+    /* validation metrics, disabled by default */
+    pthread_mutex_init(&ctx->vmetrics_lock, NULL);
+
     /* plugins */
     ly_load_plugins();
 
@@ -113,6 +324,11 @@ ly_ctx_new(const char *search_dir, int options)
     ctx->models.flags = options;
     ctx->models.used = 0;
     ctx->models.size = 16;
+#ifdef LY_ENABLED_CACHE
+    /* module index */
+    ctx->models.idx = lyht_new(64, sizeof(struct ly_ctx_mod_idx_rec), ly_ctx_mod_idx_equal, NULL, 1);
+    LY_CHECK_ERR_GOTO(!ctx->models.idx, LOGMEM(NULL), error);
+#endif
     if (search_dir) {
         search_dir_list = strdup(search_dir);
         LY_CHECK_ERR_GOTO(!search_dir_list, LOGMEM(NULL), error);
@@ -532,6 +748,15 @@ ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_n
         return;
     }
 
+#ifdef LY_ENABLED_CACHE
+    /* module index, it would only be rehashed after removing each module */
+    lyht_free(ctx->models.idx);
+    ctx->models.idx = NULL;
+
+    /* unique indexes of data trees not freed, they refer to the schemas */
+    lyv_unique_index_clean(ctx);
+#endif
+
     /* models list */
     for (; ctx->models.used > 0; ctx->models.used--) {
         /* remove the applied deviations and augments */
@@ -551,6 +776,19 @@ ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_n
     ly_err_clean(ctx, 0);
     pthread_key_delete(ctx->errlist_key);
 
+#ifdef LY_ENABLED_CACHE
+    /* schema node index */
+    lys_node_idx_clear(ctx);
+    pthread_rwlock_destroy(&ctx->snode_idx_lock);
+
+    /* unique indexes of data */
+    pthread_mutex_destroy(&ctx->uniq_idx_lock);
+#endif
+
+    /* validation metrics */
+    lyv_vmetrics_free(ctx);
+    pthread_mutex_destroy(&ctx->vmetrics_lock);
+
     /* dictionary */
     lydict_clean(&ctx->dict);
 
@@ -647,20 +885,26 @@ static const struct lys_module *
 ly_ctx_get_module_by(const struct ly_ctx *ctx, const char *key, size_t key_len, int offset, const char *revision,
                      int with_disabled, int implemented)
 {
-    int i;
+    int i, r;
     char *val;
-    struct lys_module *result = NULL;
+    struct lys_module *result = NULL, *mod = NULL;
 
     if (!ctx || !key) {
         LOGARG;
         return NULL;
     }
 
-    for (i = 0; i < ctx->models.used; i++) {
-        if (!with_disabled && ctx->models.list[i]->disabled) {
-            /* skip the disabled modules */
-            continue;
+    /* the result does not depend on the order of the modules, use the index if available */
+    while (!(r = ly_ctx_mod_idx_next(ctx, key, key_len, offset == offsetof(struct lys_module, ns), &mod))) {
+        if (ly_ctx_get_module_match(mod, revision, with_disabled, implemented, &result)) {
+            break;
         }
+    }
+    if (r != -1) {
+        return result;
+    }
+
+    for (i = 0; i < ctx->models.used; i++) {
         /* use offset to get address of the pointer to string (char**), remember that offset is in
          * bytes, so we have to cast the pointer to the module to (char*), finally, we want to have
          * string not the pointer to string
@@ -670,38 +914,8 @@ ly_ctx_get_module_by(const struct ly_ctx *ctx, const char *key, size_t key_len,
             continue;
         }
 
-        if (!revision) {
-            /* compare revisons and remember the newest one */
-            if (result) {
-                if (!ctx->models.list[i]->rev_size) {
-                    /* the current have no revision, keep the previous with some revision */
-                    continue;
-                }
-                if (result->rev_size && strcmp(ctx->models.list[i]->rev[0].date, result->rev[0].date) < 0) {
-                    /* the previous found matching module has a newer revision */
-                    continue;
-                }
-            }
-            if (implemented) {
-                if (ctx->models.list[i]->implemented) {
-                    /* we have the implemented revision */
-                    result = ctx->models.list[i];
-                    break;
-                } else {
-                    /* do not remember the result, we are supposed to return the implemented revision
-                     * not the newest one */
-                    continue;
-                }
-            }
-
-            /* remember the current match and search for newer version */
-            result = ctx->models.list[i];
-        } else {
-            if (ctx->models.list[i]->rev_size && !strcmp(revision, ctx->models.list[i]->rev[0].date)) {
-                /* matching revision */
-                result = ctx->models.list[i];
-                break;
-            }
+        if (ly_ctx_get_module_match(ctx->models.list[i], revision, with_disabled, implemented, &result)) {
+            break;
         }
     }
 
@@ -35,6 +35,9 @@ struct ly_modules_list {
     uint8_t parsed_submodules_count;
     uint16_t module_set_id;
     int flags; /* see @ref contextoptions. */
+#ifdef LY_ENABLED_CACHE
+    struct hash_table *idx; /* module index by name and namespace, see ly_ctx_mod_idx_next() */
+#endif
 };
 
 struct ly_ctx {
@@ -49,6 +52,15 @@ struct ly_ctx {
 #endif
     pthread_key_t errlist_key;
     uint8_t internal_module_count;
+    struct hash_table *vmetrics;    /* validation metrics, NULL if disabled, see lyd_vmetrics_enable() */
+    pthread_mutex_t vmetrics_lock;
+#ifdef LY_ENABLED_CACHE
+    struct hash_table *snode_idx;   /* schema node index, see lys_node_idx_find() */
+    pthread_rwlock_t snode_idx_lock; /* lookups share it, only building (a part of) the index is exclusive */
+    struct hash_table *uniq_idx;    /* unique indexes of data list instances by their parent, see lyv_data_unique() */
+    uint32_t uniq_idx_count;        /* number of parents in uniq_idx, read without the lock */
+    pthread_mutex_t uniq_idx_lock;
+#endif
 };
 
 #endif /* LY_CONTEXT_H_ */
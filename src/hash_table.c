@@ -283,6 +283,40 @@ lydict_insert(struct ly_ctx *ctx, const char *value, size_t len)
     return result;
 }
 
+static int
+lydict_ptr_eq(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    /* only the same string can be referenced */
+    return ((struct dict_rec *)val1_p)->value == ((struct dict_rec *)val2_p)->value;
+}
+
+const char *
+lydict_ref(struct ly_ctx *ctx, const char *value, uint32_t hash)
+{
+    struct dict_rec rec, *match = NULL;
+    values_equal_cb val_equal;
+
+    assert(value && (hash == dict_hash(value, strlen(value))));
+
+    rec.value = (char *)value;
+    rec.refcount = 0;
+
+    pthread_mutex_lock(&ctx->dict.lock);
+    val_equal = lyht_set_cb(ctx->dict.hash_tab, lydict_ptr_eq);
+    if (!lyht_find(ctx->dict.hash_tab, &rec, hash, (void **)&match)) {
+        match->refcount++;
+    }
+    lyht_set_cb(ctx->dict.hash_tab, val_equal);
+    pthread_mutex_unlock(&ctx->dict.lock);
+
+    if (!match) {
+        /* not from this dictionary */
+        LOGINT(ctx);
+        return lydict_insert(ctx, value, 0);
+    }
+    return value;
+}
+
 API const char *
 lydict_insert_zc(struct ly_ctx *ctx, char *value)
 {
@@ -916,3 +950,14 @@ lyht_remove(struct hash_table *ht, void *val_p, uint32_t hash)
 {
     return lyht_remove_with_resize_cb(ht, val_p, hash, NULL);
 }
+
+int
+lyht_rehash(struct hash_table *ht)
+{
+    if (!ht->invalid) {
+        /* nothing to drop */
+        return 0;
+    }
+
+    return lyht_resize(ht, 0);
+}
@@ -115,6 +115,18 @@ void lydict_init(struct dict_table *dict);
  */
 void lydict_clean(struct dict_table *dict);
 
+/**
+ * @brief Add another reference to a string already stored in the dictionary.
+ *
+ * Unlike lydict_insert(), the hash of the string is not computed and the string is not compared.
+ *
+ * @param[in] ctx Context with the dictionary.
+ * @param[in] value String stored in the dictionary of \p ctx.
+ * @param[in] hash Hash of \p value, as returned by lyd_value_hash().
+ * @return \p value.
+ */
+const char *lydict_ref(struct ly_ctx *ctx, const char *value, uint32_t hash);
+
 /**
  * @brief Get a specific record from a hash table.
  *
@@ -245,4 +257,13 @@ int lyht_remove(struct hash_table *ht, void *val_p, uint32_t hash);
  */
 int lyht_remove_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash, values_equal_cb resize_val_equal);
 
+/**
+ * @brief Rehash a hash table to drop all its removed records. Searching a table without any
+ * removed records does not modify it so it can then be searched by several threads at once.
+ *
+ * @param[in] ht Hash table to rehash.
+ * @return 0 on success, -1 on error.
+ */
+int lyht_rehash(struct hash_table *ht);
+
 #endif /* LY_HASH_TABLE_H_ */
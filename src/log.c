@@ -31,6 +31,9 @@ volatile uint8_t ly_log_level = LY_LLWRN;
 volatile uint8_t ly_log_opts = LY_LOLOG | LY_LOSTORE_LAST;
 static void (*ly_log_clb)(LY_LOG_LEVEL level, const char *msg, const char *path);
 static volatile int path_flag = 1;
+static volatile uint32_t ly_log_errlimit_cnt = 0;
+/* whether the last error was discarded because of the error limit */
+static THREAD_LOCAL int log_errlimit_dropped;
 volatile int ly_log_dbg_groups = 0;
 
 API LY_LOG_LEVEL
@@ -51,6 +54,15 @@ ly_log_options(int opts)
     return prev;
 }
 
+API uint32_t
+ly_log_errlimit(uint32_t limit)
+{
+    uint32_t prev = ly_log_errlimit_cnt;
+
+    ly_log_errlimit_cnt = limit;
+    return prev;
+}
+
 API void
 ly_verb_dbg(int dbg_groups)
 {
@@ -76,27 +88,29 @@ API void
 
 /* !! spends all string parameters !! */
 static int
-log_store(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vecode, char *msg, char *path, char *apptag)
+log_store(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vecode, char *msg, char *path,
+          enum LY_VLOG_ELEM path_type, const void *path_elem, char *apptag)
 {
-    struct ly_err_item *eitem, *last;
+    struct ly_err_item *eitem, *last, *first;
 
     assert(ctx && (level < LY_LLVRB));
 
-    eitem = pthread_getspecific(ctx->errlist_key);
+    eitem = first = pthread_getspecific(ctx->errlist_key);
     if (!eitem) {
         /* if we are only to fill in path, there must have been an error stored */
         assert(msg);
-        eitem = malloc(sizeof *eitem);
+        eitem = first = malloc(sizeof(struct ly_err_item_int));
         if (!eitem) {
             goto mem_fail;
         }
         eitem->prev = eitem;
         eitem->next = NULL;
+        ((struct ly_err_item_int *)eitem)->err_count = 0;
 
         pthread_setspecific(ctx->errlist_key, eitem);
     } else if (!msg) {
         /* only filling the path */
-        assert(path);
+        assert(path || path_elem);
 
         /* find last error */
         eitem = eitem->prev;
@@ -105,6 +119,8 @@ log_store(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vec
                 /* fill the path */
                 free(eitem->path);
                 eitem->path = path;
+                ((struct ly_err_item_int *)eitem)->path_type = path_type;
+                ((struct ly_err_item_int *)eitem)->path_elem = path_elem;
                 return 0;
             }
             eitem = eitem->prev;
@@ -113,13 +129,16 @@ log_store(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vec
         assert(0);
     } else if ((log_opt != ILO_STORE) && ((ly_log_opts & LY_LOSTORE_LAST) == LY_LOSTORE_LAST)) {
         /* overwrite last message */
+        if (eitem->level == LY_LLERR) {
+            --((struct ly_err_item_int *)first)->err_count;
+        }
         free(eitem->msg);
         free(eitem->path);
         free(eitem->apptag);
     } else {
         /* store new message */
         last = eitem->prev;
-        eitem->prev = malloc(sizeof *eitem);
+        eitem->prev = malloc(sizeof(struct ly_err_item_int));
         if (!eitem->prev) {
             goto mem_fail;
         }
@@ -136,6 +155,11 @@ log_store(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vec
     eitem->msg = msg;
     eitem->path = path;
     eitem->apptag = apptag;
+    ((struct ly_err_item_int *)eitem)->path_type = path_type;
+    ((struct ly_err_item_int *)eitem)->path_elem = path_elem;
+    if (level == LY_LLERR) {
+        ++((struct ly_err_item_int *)first)->err_count;
+    }
     return 0;
 
 mem_fail:
@@ -146,10 +170,82 @@ mem_fail:
     return -1;
 }
 
+/**
+ * @brief Check whether the limit of stored errors was reached so that an error would be discarded.
+ */
+static int
+log_errlimit_reached(const struct ly_ctx *ctx, LY_LOG_LEVEL level)
+{
+    struct ly_err_item *first;
+
+    if (!ly_log_errlimit_cnt || !ctx || (level != LY_LLERR) || (log_opt == ILO_STORE)
+            || !(ly_log_opts & LY_LOSTORE) || ((ly_log_opts & LY_LOSTORE_LAST) == LY_LOSTORE_LAST)) {
+        return 0;
+    }
+
+    first = ly_err_first_int(ctx);
+    return first && (((struct ly_err_item_int *)first)->err_count >= ly_log_errlimit_cnt);
+}
+
+/**
+ * @brief Check whether the path of a message would be used at all.
+ *
+ * @param[in] ctx Context used.
+ * @param[in] level Message level.
+ * @param[in] path_only Whether only the path related to the previous error is being logged.
+ * @return 1 if the path is needed, 0 if the message is going to be thrown away or the path never printed nor stored.
+ */
+static int
+log_path_needed(const struct ly_ctx *ctx, LY_LOG_LEVEL level, int path_only)
+{
+    if (!path_flag) {
+        return 0;
+    }
+
+    if ((log_opt == ILO_ERR2WRN) && (level == LY_LLERR)) {
+        level = LY_LLWRN;
+    }
+    if ((log_opt == ILO_IGNORE) || (level > ly_log_level)) {
+        return 0;
+    }
+
+    if (path_only ? log_errlimit_dropped : log_errlimit_reached(ctx, level)) {
+        return 0;
+    }
+
+    if ((level < LY_LLVRB) && ctx && ((ly_log_opts & LY_LOSTORE) || (log_opt == ILO_STORE))) {
+        /* stored */
+        return 1;
+    }
+    if ((ly_log_opts & LY_LOLOG) && (log_opt != ILO_STORE)) {
+        /* printed */
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get a copy of the path of the previous error.
+ */
+static char *
+log_prev_path(const struct ly_ctx *ctx)
+{
+    struct ly_err_item *first;
+
+    first = ly_err_first_int(ctx);
+    if (!first) {
+        return NULL;
+    }
+
+    ly_err_path_finish(first->prev);
+    return first->prev->path ? strdup(first->prev->path) : NULL;
+}
+
 /* !! spends path !! */
 static void
 log_vprintf(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE vecode, char *path,
-            const char *format, va_list args)
+            enum LY_VLOG_ELEM path_type, const void *path_elem, const char *format, va_list args)
 {
     char *msg = NULL;
     int free_strs;
@@ -170,6 +266,18 @@ log_vprintf(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE v
         ly_errno = no;
     }
 
+    if (format ? log_errlimit_reached(ctx, level) : log_errlimit_dropped) {
+        /* too many errors already stored, discard this one (or the path of the discarded one) */
+        if (format) {
+            log_errlimit_dropped = 1;
+        }
+        free(path);
+        return;
+    }
+    if (format && (level == LY_LLERR)) {
+        log_errlimit_dropped = 0;
+    }
+
     if ((no == LY_EVALID) && (vecode == LYVE_SUCCESS)) {
         /* assume we are inheriting the error, so inherit vecode as well */
         vecode = ly_vecode(ctx);
@@ -178,9 +286,9 @@ log_vprintf(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE v
     /* store the error/warning (if we need to store errors internally, it does not matter what are the user log options) */
     if ((level < LY_LLVRB) && ctx && ((ly_log_opts & LY_LOSTORE) || (log_opt == ILO_STORE))) {
         if (!format) {
-            assert(path);
+            assert(path || path_elem);
             /* postponed print of path related to the previous error, do not rewrite stored original message */
-            if (log_store(ctx, level, no, vecode, NULL, path, NULL)) {
+            if (log_store(ctx, level, no, vecode, NULL, path, path_type, path_elem, NULL)) {
                 return;
             }
             msg = "Path is related to the previous error message.";
@@ -190,12 +298,14 @@ log_vprintf(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, LY_VECODE v
                 free(path);
                 return;
             }
-            if (log_store(ctx, level, no, vecode, msg, path, NULL)) {
+            if (log_store(ctx, level, no, vecode, msg, path, path_type, path_elem, NULL)) {
                 return;
             }
         }
         free_strs = 0;
     } else {
+        /* deferred paths are only ever stored */
+        assert(!path_elem);
         if (vasprintf(&msg, format, args) == -1) {
             LOGMEM(ctx);
             free(path);
@@ -228,7 +338,7 @@ ly_log(const struct ly_ctx *ctx, LY_LOG_LEVEL level, LY_ERR no, const char *form
     va_list ap;
 
     va_start(ap, format);
-    log_vprintf(ctx, level, no, 0, NULL, format, ap);
+    log_vprintf(ctx, level, no, 0, NULL, LY_VLOG_NONE, NULL, format, ap);
     va_end(ap);
 }
 
@@ -278,7 +388,7 @@ ly_log_dbg(int group, const char *format, ...)
     }
 
     va_start(ap, format);
-    log_vprintf(NULL, LY_LLDBG, 0, 0, NULL, dbg_format, ap);
+    log_vprintf(NULL, LY_LLDBG, 0, 0, NULL, LY_VLOG_NONE, NULL, dbg_format, ap);
     va_end(ap);
     free(dbg_format);
 }
@@ -307,7 +417,7 @@ lyext_log(const struct ly_ctx *ctx, LY_LOG_LEVEL level, const char *plugin, cons
     }
 
     va_start(ap, format);
-    log_vprintf(ctx, level, (level == LY_LLERR ? LY_EPLUGIN : 0), 0, NULL, plugin_msg, ap);
+    log_vprintf(ctx, level, (level == LY_LLERR ? LY_EPLUGIN : 0), 0, NULL, LY_VLOG_NONE, NULL, plugin_msg, ap);
     va_end(ap);
 
     free(plugin_msg);
@@ -331,13 +441,10 @@ lyext_vlog(const struct ly_ctx *ctx, LY_VECODE vecode, const char *plugin, const
     va_list ap;
     int ret;
 
-    if (path_flag && (etype != LY_VLOG_NONE)) {
+    if ((etype != LY_VLOG_NONE) && log_path_needed(ctx, LY_LLERR, 0)) {
         if (etype == LY_VLOG_PREV) {
             /* use previous path */
-            const struct ly_err_item *first = ly_err_first(ctx);
-            if (first && first->prev->path) {
-                path = strdup(first->prev->path);
-            }
+            path = log_prev_path(ctx);
         } else {
             /* print path */
             if (!elem) {
@@ -362,7 +469,7 @@ lyext_vlog(const struct ly_ctx *ctx, LY_VECODE vecode, const char *plugin, const
 
     va_start(ap, format);
     /* path is spent and should not be freed! */
-    log_vprintf(ctx, LY_LLERR, LY_EVALID, vecode, path, plugin_msg, ap);
+    log_vprintf(ctx, LY_LLERR, LY_EVALID, vecode, path, LY_VLOG_NONE, NULL, plugin_msg, ap);
     va_end(ap);
 
     free(plugin_msg);
@@ -851,27 +958,29 @@ ly_vlog(const struct ly_ctx *ctx, LY_ECODE ecode, enum LY_VLOG_ELEM elem_type, c
     va_list ap;
     const char *fmt;
     char* path = NULL;
-    const struct ly_err_item *first;
+    const void *path_elem = NULL;
 
-    if ((ecode == LYE_PATH) && !path_flag) {
-        return;
+    if (!log_path_needed(ctx, LY_LLERR, ecode == LYE_PATH)) {
+        if (ecode == LYE_PATH) {
+            return;
+        }
+        /* the message is still processed, but without any path */
+        elem_type = LY_VLOG_NONE;
     }
 
-    if (path_flag && (elem_type != LY_VLOG_NONE)) {
-        if (elem_type == LY_VLOG_PREV) {
-            /* use previous path */
-            first = ly_err_first(ctx);
-            if (first && first->prev->path) {
-                path = strdup(first->prev->path);
-            }
+    if (elem_type == LY_VLOG_PREV) {
+        /* use previous path */
+        path = log_prev_path(ctx);
+    } else if (elem_type != LY_VLOG_NONE) {
+        /* print path */
+        if (!elem) {
+            /* top-level */
+            path = strdup("/");
+        } else if ((elem_type == LY_VLOG_LYD) && ctx && (log_opt == ILO_STORE)) {
+            /* the error will most likely be discarded, generate the path only if needed */
+            path_elem = elem;
         } else {
-            /* print path */
-            if (!elem) {
-                /* top-level */
-                path = strdup("/");
-            } else {
-                ly_vlog_build_path(elem_type, elem, &path, 0, 0);
-            }
+            ly_vlog_build_path(elem_type, elem, &path, 0, 0);
         }
     }
 
@@ -880,14 +989,14 @@ ly_vlog(const struct ly_ctx *ctx, LY_ECODE ecode, enum LY_VLOG_ELEM elem_type, c
     switch (ecode) {
     case LYE_SPEC:
         fmt = va_arg(ap, char *);
-        log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, path, fmt, ap);
+        log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, path, elem_type, path_elem, fmt, ap);
         break;
     case LYE_PATH:
-        assert(path);
-        log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, path, NULL, ap);
+        assert(path || path_elem);
+        log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, path, elem_type, path_elem, NULL, ap);
         break;
     default:
-        log_vprintf(ctx, LY_LLERR, LY_EVALID, ecode2vecode[ecode], path, ly_errs[ecode], ap);
+        log_vprintf(ctx, LY_LLERR, LY_EVALID, ecode2vecode[ecode], path, elem_type, path_elem, ly_errs[ecode], ap);
         break;
     }
     va_end(ap);
@@ -898,16 +1007,12 @@ ly_vlog_str(const struct ly_ctx *ctx, enum LY_VLOG_ELEM elem_type, const char *s
 {
     va_list ap;
     char *path = NULL, *fmt, *ptr;
-    const struct ly_err_item *first;
 
     assert((elem_type == LY_VLOG_NONE) || (elem_type == LY_VLOG_PREV));
 
-    if (elem_type == LY_VLOG_PREV) {
+    if ((elem_type == LY_VLOG_PREV) && log_path_needed(ctx, LY_LLERR, 0)) {
         /* use previous path */
-        first = ly_err_first(ctx);
-        if (first && first->prev->path) {
-            path = strdup(first->prev->path);
-        }
+        path = log_prev_path(ctx);
     }
 
     if (strchr(str, '%')) {
@@ -924,15 +1029,33 @@ ly_vlog_str(const struct ly_ctx *ctx, enum LY_VLOG_ELEM elem_type, const char *s
 
     va_start(ap, str);
     /* path is spent and should not be freed! */
-    log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, path, fmt, ap);
+    log_vprintf(ctx, LY_LLERR, LY_EVALID, LYVE_SUCCESS, path, LY_VLOG_NONE, NULL, fmt, ap);
     va_end(ap);
 
     free(fmt);
 }
 
+void
+ly_err_path_finish(struct ly_err_item *eitem)
+{
+    struct ly_err_item_int *ieitem = (struct ly_err_item_int *)eitem;
+    char *path = NULL;
+
+    if (!ieitem->path_elem) {
+        return;
+    }
+
+    ly_vlog_build_path(ieitem->path_type, ieitem->path_elem, &path, 0, 0);
+    ieitem->path_elem = NULL;
+
+    free(eitem->path);
+    eitem->path = path;
+}
+
 API void
 ly_err_print(struct ly_err_item *eitem)
 {
+    ly_err_path_finish(eitem);
     if (ly_log_opts & LY_LOLOG) {
         if (ly_log_clb) {
             ly_log_clb(eitem->level, eitem->msg, eitem->path);
@@ -949,7 +1072,7 @@ static void
 err_print(struct ly_ctx *ctx, struct ly_err_item *last_eitem)
 {
     if (!last_eitem) {
-        last_eitem = pthread_getspecific(ctx->errlist_key);
+        last_eitem = ly_err_first_int(ctx);
     } else {
         /* this last was already stored before, do not write it again */
         last_eitem = last_eitem->next;
@@ -1010,6 +1133,7 @@ err_clean(struct ly_ctx *ctx, struct ly_err_item *prev_eitem, int keep)
 
         /* put the context errlist in order */
         pthread_setspecific(ctx->errlist_key, prev_eitem);
+        ((struct ly_err_item_int *)prev_eitem)->err_count = (prev_eitem->level == LY_LLERR) ? 1 : 0;
         assert(!prev_eitem->prev->next || (prev_eitem->prev->next == prev_eitem));
         prev_eitem->prev->next = NULL;
         prev_eitem->prev = prev_eitem;
@@ -1030,7 +1154,7 @@ ly_ilo_change(struct ly_ctx *ctx, enum int_log_opts new_ilo, enum int_log_opts *
     if (new_ilo == ILO_STORE) {
         /* only in this case the errors are only temporarily stored */
         assert(ctx && prev_last_eitem);
-        *prev_last_eitem = (struct ly_err_item *)ly_err_first(ctx);
+        *prev_last_eitem = ly_err_first_int(ctx);
         if (*prev_last_eitem) {
             *prev_last_eitem = (*prev_last_eitem)->prev;
         }
@@ -1044,6 +1168,8 @@ ly_ilo_change(struct ly_ctx *ctx, enum int_log_opts new_ilo, enum int_log_opts *
 void
 ly_ilo_restore(struct ly_ctx *ctx, enum int_log_opts prev_ilo, struct ly_err_item *prev_last_eitem, int keep_and_print)
 {
+    struct ly_err_item *eitem;
+
     assert(log_opt != ILO_LOG);
     if (log_opt != ILO_STORE) {
         /* nothing to print or free */
@@ -1056,6 +1182,12 @@ ly_ilo_restore(struct ly_ctx *ctx, enum int_log_opts prev_ilo, struct ly_err_ite
 
     log_opt = prev_ilo;
     if (keep_and_print) {
+        if (log_opt != ILO_STORE) {
+            /* the errors are leaving the internal storage, the elements may not exist later */
+            for (eitem = prev_last_eitem ? prev_last_eitem->next : ly_err_first_int(ctx); eitem; eitem = eitem->next) {
+                ly_err_path_finish(eitem);
+            }
+        }
         err_print(ctx, prev_last_eitem);
     }
     err_clean(ctx, prev_last_eitem, keep_and_print);
@@ -1067,7 +1199,7 @@ ly_err_last_set_apptag(const struct ly_ctx *ctx, const char *apptag)
     struct ly_err_item *i;
 
     if (log_opt != ILO_IGNORE) {
-        i = ly_err_first(ctx);
+        i = ly_err_first_int(ctx);
         if (i) {
             i = i->prev;
             i->apptag = strdup(apptag);
@@ -19,6 +19,7 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
@@ -39,6 +40,11 @@
 
 #define LYP_URANGE_LEN 19
 
+#ifdef LY_ENABLED_CACHE
+/* lock for compiling patterns of types not compiled when their schema was parsed */
+static pthread_mutex_t pattern_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 static char *lyp_ublock2urange[][2] = {
     {"BasicLatin", "[\\x{0000}-\\x{007F}]"},
     {"Latin-1Supplement", "[\\x{0080}-\\x{00FF}]"},
@@ -598,13 +604,65 @@ validate_length_range(uint8_t kind, uint64_t unum, int64_t snum, int64_t fnum, u
     return EXIT_SUCCESS;
 }
 
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Compile all the patterns of a type, which were not compiled when its schema was parsed
+ * (such as types of extension instances). Can be called from several threads at once.
+ *
+ * @param[in] ctx libyang context for logging.
+ * @param[in] type String type with patterns.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+validate_pattern_precompile(struct ly_ctx *ctx, struct lys_type *type)
+{
+    void **patterns_pcre;
+    unsigned int i;
+    int ret = EXIT_SUCCESS;
+
+    pthread_mutex_lock(&pattern_lock);
+
+    if (__atomic_load_n(&type->info.str.patterns_pcre, __ATOMIC_ACQUIRE)) {
+        /* compiled by another thread in the meantime */
+        goto cleanup;
+    }
+
+    patterns_pcre = calloc(2 * type->info.str.pat_count, sizeof *patterns_pcre);
+    LY_CHECK_ERR_GOTO(!patterns_pcre, LOGMEM(ctx); ret = EXIT_FAILURE, cleanup);
+
+    for (i = 0; i < type->info.str.pat_count; ++i) {
+        if (lyp_precompile_pattern(ctx, &type->info.str.patterns[i].expr[1], (pcre **)&patterns_pcre[i * 2],
+                                   (pcre_extra **)&patterns_pcre[i * 2 + 1])) {
+            while (i--) {
+                pcre_free((pcre *)patterns_pcre[2 * i]);
+                pcre_free_study((pcre_extra *)patterns_pcre[2 * i + 1]);
+            }
+            free(patterns_pcre);
+            ret = EXIT_FAILURE;
+            goto cleanup;
+        }
+    }
+
+    /* publish the complete array, lock-free readers must see it only with all the compiled patterns */
+    __atomic_store_n(&type->info.str.patterns_pcre, patterns_pcre, __ATOMIC_RELEASE);
+
+cleanup:
+    pthread_mutex_unlock(&pattern_lock);
+    return ret;
+}
+
+#endif
+
 /* logs directly */
 static int
 validate_pattern(struct ly_ctx *ctx, const char *val_str, struct lys_type *type, struct lyd_node *node)
 {
     int rc;
     unsigned int i;
-#ifndef LY_ENABLED_CACHE
+#ifdef LY_ENABLED_CACHE
+    void **patterns_pcre;
+#else
     pcre *precomp;
 #endif
 
@@ -614,30 +672,38 @@ validate_pattern(struct ly_ctx *ctx, const char *val_str, struct lys_type *type,
         val_str = "";
     }
 
-    if (type->der && validate_pattern(ctx, val_str, &type->der->type, node)) {
-        return EXIT_FAILURE;
+    if (type->der) {
+        /* the patterns of the typedef (and all its base types) may be checked by a user type plugin */
+        rc = type->der->module ? lytype_validate(type->der, val_str) : -1;
+        if ((rc == 1) && (log_opt == ILO_IGNORE)) {
+            /* no need to find the pattern for the error message */
+            return EXIT_FAILURE;
+        } else if (rc && validate_pattern(ctx, val_str, &type->der->type, node)) {
+            return EXIT_FAILURE;
+        }
     }
 
 #ifdef LY_ENABLED_CACHE
-    /* there is no cache, build it */
-    if (!type->info.str.patterns_pcre && type->info.str.pat_count) {
-        type->info.str.patterns_pcre = malloc(2 * type->info.str.pat_count * sizeof *type->info.str.patterns_pcre);
-        LY_CHECK_ERR_RETURN(!type->info.str.patterns_pcre, LOGMEM(ctx), -1);
-
-        for (i = 0; i < type->info.str.pat_count; ++i) {
-            if (lyp_precompile_pattern(ctx, &type->info.str.patterns[i].expr[1],
-                                       (pcre**)&type->info.str.patterns_pcre[i * 2],
-                                       (pcre_extra**)&type->info.str.patterns_pcre[i * 2 + 1])) {
-                return EXIT_FAILURE;
-            }
+    /* patterns are normally compiled when the schema is parsed, otherwise compile them now */
+    patterns_pcre = __atomic_load_n(&type->info.str.patterns_pcre, __ATOMIC_ACQUIRE);
+    if (!patterns_pcre && type->info.str.pat_count) {
+        if (validate_pattern_precompile(ctx, type)) {
+            return EXIT_FAILURE;
         }
+        patterns_pcre = __atomic_load_n(&type->info.str.patterns_pcre, __ATOMIC_ACQUIRE);
     }
 #endif
 
     for (i = 0; i < type->info.str.pat_count; ++i) {
 #ifdef LY_ENABLED_CACHE
-        rc = pcre_exec((pcre *)type->info.str.patterns_pcre[2 * i], (pcre_extra *)type->info.str.patterns_pcre[2 * i + 1],
+        rc = pcre_exec((pcre *)patterns_pcre[2 * i], (pcre_extra *)patterns_pcre[2 * i + 1],
                        val_str, strlen(val_str), 0, 0, NULL, 0);
+# ifdef PCRE_ERROR_JIT_STACKLIMIT
+        if (rc == PCRE_ERROR_JIT_STACKLIMIT) {
+            /* JIT stack is too small for this value, match it without JIT */
+            rc = pcre_exec((pcre *)patterns_pcre[2 * i], NULL, val_str, strlen(val_str), 0, 0, NULL, 0);
+        }
+# endif
 #else
         if (lyp_check_pattern(ctx, &type->info.str.patterns[i].expr[1], &precomp)) {
             return EXIT_FAILURE;
@@ -950,13 +1016,18 @@ int
 lyp_precompile_pattern(struct ly_ctx *ctx, const char *pattern, pcre** pcre_cmp, pcre_extra **pcre_std)
 {
     const char *err_msg = NULL;
+    int options = 0;
 
     if (lyp_check_pattern(ctx, pattern, pcre_cmp)) {
         return EXIT_FAILURE;
     }
 
     if (pcre_std && pcre_cmp) {
-        (*pcre_std) = pcre_study(*pcre_cmp, 0, &err_msg);
+#ifdef PCRE_STUDY_JIT_COMPILE
+        /* use JIT if libpcre supports it, it is silently ignored otherwise */
+        options |= PCRE_STUDY_JIT_COMPILE;
+#endif
+        (*pcre_std) = pcre_study(*pcre_cmp, options, &err_msg);
         if (err_msg) {
             LOGWRN(ctx, "Studying pattern \"%s\" failed (%s).", pattern, err_msg);
         }
@@ -1984,7 +2055,7 @@ lyp_parse_value(struct lys_type *type, const char **value_, struct lyxml_elem *x
 
     /* search user types in case this value is supposed to be stored in a custom way */
     if (store && ret->der && ret->der->module) {
-        c = lytype_store(ret->der->module, ret->der->name, value_, val);
+        c = lytype_store(ret->der, value_, val);
         if (c == -1) {
             if (leaf) {
                 LOGPATH(ctx, LY_VLOG_LYD, leaf);
@@ -3697,6 +3768,9 @@ lyp_ctx_add_module(struct lys_module *module)
         module->ctx->models.size *= 2;
         module->ctx->models.list = newlist;
     }
+    if (ly_ctx_mod_idx_add(module)) {
+        return -1;
+    }
     module->ctx->models.list[module->ctx->models.used++] = module;
     module->ctx->models.module_set_id++;
 
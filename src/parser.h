@@ -256,13 +256,12 @@ struct lyext_plugin *ext_get_plugin(const char *name, const char *module, const
 /**
  * @brief Try to store a value as a user type defined by a plugin.
  *
- * @param[in] mod Module of the type.
- * @param[in] type_name Type (typedef) name.
+ * @param[in] tpdf Typedef of the type, with a module.
  * @param[in,out] value_str Stored string value, can be overwritten by the user store callback.
  * @param[in,out] value Filled value to be overwritten by the user store callback.
  * @return 0 on successful storing, 1 if the type is not a user type, -1 on error.
  */
-int lytype_store(const struct lys_module *mod, const char *type_name, const char **value_str, lyd_val *value);
+int lytype_store(struct lys_tpdf *tpdf, const char **value_str, lyd_val *value);
 
 /**
  * @brief Free a user type stored value.
@@ -273,4 +272,32 @@ int lytype_store(const struct lys_module *mod, const char *type_name, const char
  */
 void lytype_free(const struct lys_type *type, lyd_val value, const char *value_str);
 
+/**
+ * @brief Try to validate a value of a user type using its plugin instead of the type patterns.
+ *
+ * @param[in] tpdf Typedef of the type, with a module.
+ * @param[in] value_str String value.
+ * @return 0 if the value matches the patterns, 1 if it does not, -1 if it must be checked using the patterns.
+ */
+int lytype_validate(struct lys_tpdf *tpdf, const char *value_str);
+
+/**
+ * @brief Duplicate a user type stored value, using the plugin duplicate callback if possible.
+ *
+ * @param[in] orig_tpdf Typedef of the original value type, with a module.
+ * @param[in] orig Original stored value.
+ * @param[in] tpdf Typedef of the duplicated value type, with a module.
+ * @param[in,out] value_str Stored string value of the duplicate, can be overwritten by the user store callback.
+ * @param[in,out] value Value of the duplicate to be overwritten.
+ * @return 0 on success, 1 if the type is not a user type, -1 on error.
+ */
+int lytype_dup(struct lys_tpdf *orig_tpdf, lyd_val orig, struct lys_tpdf *tpdf, const char **value_str, lyd_val *value);
+
+/**
+ * @brief Forget the cached plugin of a typedef that is being freed.
+ *
+ * @param[in] tpdf Freed typedef.
+ */
+void lytype_tpdf_forget(const struct lys_tpdf *tpdf);
+
 #endif /* LY_PARSER_H_ */
@@ -515,12 +515,6 @@ inval:
         return 0;
     }
 
-#ifdef LY_ENABLED_CACHE
-    /* calculate the hash and insert it into parent */
-    lyd_hash((struct lyd_node *)leaf);
-    lyd_insert_hash((struct lyd_node *)leaf);
-#endif
-
     if (leaf->schema->nodetype == LYS_LEAFLIST) {
         /* repeat until end-array */
         len += skip_ws(&data[len]);
@@ -849,6 +843,50 @@ json_skip_unknown(struct ly_ctx *ctx, struct lyd_node *parent, const char *data,
     return 0;
 }
 
+/**
+ * @brief Find the schema node of a JSON member. Does not log.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] parent Schema parent, NULL for top-level nodes.
+ * @param[in] mod Module of the top-level nodes, module of unprefixed nodes otherwise.
+ * @param[in] prefix Member name prefix (module name), if any.
+ * @param[in] name Member name.
+ * @return Found schema node, NULL if not found.
+ */
+static struct lys_node *
+json_data_find_schemanode(struct ly_ctx *ctx, const struct lys_node *parent, const struct lys_module *mod,
+                          const char *prefix, const char *name)
+{
+    const struct lys_module *node_mod = NULL;
+    const struct lys_node *snode = NULL;
+
+    /* use the schema node index, if possible */
+    if (parent) {
+        node_mod = prefix ? ly_ctx_get_module(ctx, prefix, NULL, 1) : mod;
+    }
+    if (!parent || node_mod) {
+        switch (lys_node_idx_find(parent, mod, node_mod, NULL, name, strlen(name), 0, 0, &snode)) {
+        case 0:
+            return (struct lys_node *)snode;
+        case 1:
+            return NULL;
+        default:
+            break;
+        }
+    }
+
+    while ((snode = lys_getnext(snode, parent, mod, 0))) {
+        if (strcmp(snode->name, name)) {
+            continue;
+        }
+        if (!parent || (prefix && !strcmp(lys_node_module(snode)->name, prefix))
+                || (!prefix && (lys_node_module(snode) == mod))) {
+            break;
+        }
+    }
+    return (struct lys_node *)snode;
+}
+
 static unsigned int
 json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *schema_parent, struct lyd_node **parent,
                 struct lyd_node *first_sibling, struct lyd_node *prev, struct attr_cont **attrs, int options,
@@ -969,11 +1007,7 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
                 }
             } else {
                 /* get the proper schema node */
-                while ((schema = (struct lys_node *) lys_getnext(schema, NULL, module, 0))) {
-                    if (!strcmp(schema->name, name)) {
-                        break;
-                    }
-                }
+                schema = json_data_find_schemanode(ctx, NULL, module, NULL, name);
             }
         }
     } else {
@@ -1003,21 +1037,9 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
         }
 
         if (schema_parent) {
-            while ((schema = (struct lys_node *)lys_getnext(schema, schema_parent, NULL, 0))) {
-                if (!strcmp(schema->name, name)
-                        && ((prefix && !strcmp(lys_node_module(schema)->name, prefix))
-                        || (!prefix && (lys_node_module(schema) == lys_node_module(schema_parent))))) {
-                    break;
-                }
-            }
+            schema = json_data_find_schemanode(ctx, schema_parent, lys_node_module(schema_parent), prefix, name);
         } else {
-            while ((schema = (struct lys_node *)lys_getnext(schema, (*parent)->schema, NULL, 0))) {
-                if (!strcmp(schema->name, name)
-                        && ((prefix && !strcmp(lys_node_module(schema)->name, prefix))
-                        || (!prefix && (lys_node_module(schema) == lyd_node_module(*parent))))) {
-                    break;
-                }
-            }
+            schema = json_data_find_schemanode(ctx, (*parent)->schema, lyd_node_module(*parent), prefix, name);
         }
     }
 
@@ -1171,12 +1193,6 @@ attr_repeat:
             goto error;
         }
 
-#ifdef LY_ENABLED_CACHE
-        /* calculate the hash and insert it into parent */
-        lyd_hash(result);
-        lyd_insert_hash(result);
-#endif
-
         len += r;
         len += skip_ws(&data[len]);
         break;
@@ -1201,12 +1217,6 @@ attr_repeat:
             *act_notif = result;
         }
 
-#ifdef LY_ENABLED_CACHE
-        /* calculate the hash and insert it into parent */
-        lyd_hash(result);
-        lyd_insert_hash(result);
-#endif
-
         if (data[len] != '{') {
             LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, result, "JSON data (missing begin-object)");
             goto error;
@@ -1286,14 +1296,6 @@ attr_repeat:
                 }
             } while (data[len] == ',');
 
-#ifdef LY_ENABLED_CACHE
-            /* calculate the hash and insert it into parent */
-            if (!((struct lys_node_list *)list->schema)->keys_size) {
-                lyd_hash(list);
-                lyd_insert_hash(list);
-            }
-#endif
-
             /* store attributes */
             if (store_attrs(ctx, attrs_aux, list->child, options)) {
                 goto error;
@@ -1533,6 +1535,11 @@ lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct l
         result = reply_top;
     }
 
+#ifdef LY_ENABLED_CACHE
+    /* hash the whole parsed tree at once */
+    lyd_hash_siblings(result);
+#endif
+
     if (!result && (options & LYD_OPT_STRICT)) {
         LOGERR(ctx, LY_EVALID, "Model for the data to be linked with not found.");
         goto error;
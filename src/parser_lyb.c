@@ -17,6 +17,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "libyang.h"
 #include "common.h"
@@ -192,6 +194,105 @@ error:
     return -1;
 }
 
+/**
+ * @brief String from the string table of compact LYB data.
+ */
+struct lyb_str {
+    const char *str;    /* string in the dictionary */
+    uint32_t hash;      /* its dictionary hash */
+};
+
+static int
+lyb_read_varint(uint64_t *num, const char *data, struct lyb_state *lybs)
+{
+    int r, ret = 0, i;
+    uint8_t byte;
+
+    *num = 0;
+    for (i = 0; i < LYB_VARINT_MAX_BYTES; ++i) {
+        ret += (r = lyb_read(data, &byte, sizeof byte, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+
+        *num |= (uint64_t)(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) {
+            return ret;
+        }
+    }
+
+    LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB variable-length number.");
+    return -1;
+}
+
+static int
+lyb_read_value_string(const char *data, const char **value_str, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint64_t idx = 0;
+    char *str;
+
+    if (lybs->flags & LYB_HEADER_COMPACT) {
+        /* index in the string table, 0 if followed by the string itself */
+        ret += (r = lyb_read_varint(&idx, data, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+        if (idx > lybs->str_count) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB string table index %" PRIu64 ".", idx);
+            return -1;
+        } else if (idx) {
+            *value_str = lydict_ref(lybs->ctx, lybs->strs[idx - 1].str, lybs->strs[idx - 1].hash);
+            return ret;
+        }
+    }
+
+    ret += (r = lyb_read_string(data, &str, 0, lybs));
+    LYB_HAVE_READ_RETURN(r, data, -1);
+
+    *value_str = lydict_insert_zc(lybs->ctx, str);
+    return ret;
+}
+
+static int
+lyb_read_compact_number(LY_DATA_TYPE value_type, const char *data, lyd_val *value, struct lyb_state *lybs)
+{
+    int ret;
+    uint64_t num;
+    int64_t snum;
+
+    ret = lyb_read_varint(&num, data, lybs);
+    if (ret < 0) {
+        return -1;
+    }
+
+    /* zigzag encoding of signed numbers */
+    snum = (int64_t)(num >> 1) ^ -(int64_t)(num & 1);
+
+    switch (value_type) {
+    case LY_TYPE_INT16:
+        value->int16 = snum;
+        break;
+    case LY_TYPE_UINT16:
+        value->uint16 = num;
+        break;
+    case LY_TYPE_INT32:
+        value->int32 = snum;
+        break;
+    case LY_TYPE_UINT32:
+        value->uint32 = num;
+        break;
+    case LY_TYPE_DEC64:
+    case LY_TYPE_INT64:
+        value->int64 = snum;
+        break;
+    case LY_TYPE_UINT64:
+        value->uint64 = num;
+        break;
+    default:
+        LOGINT(lybs->ctx);
+        return -1;
+    }
+
+    return ret;
+}
+
 static void
 lyb_read_stop_subtree(struct lyb_state *lybs)
 {
@@ -358,17 +459,12 @@ lyb_parse_val_1(struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_fl
 {
     int r, ret;
     size_t i;
-    char *str = NULL;
     uint8_t byte;
     uint64_t num;
 
     if (value_flags & LY_VALUE_USER) {
         /* just read value_str */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            *value_str = lydict_insert_zc(lybs->ctx, str);
-        }
-        return ret;
+        return lyb_read_value_string(data, value_str, lybs);
     }
 
     /* find the correct structure, go through leafrefs and typedefs */
@@ -385,24 +481,23 @@ lyb_parse_val_1(struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_fl
         break;
     }
 
+    if ((lybs->flags & LYB_HEADER_COMPACT) && LYB_COMPACT_NUMBER(value_type)) {
+        /* read a variable-length number */
+        return lyb_read_compact_number(value_type, data, value, lybs);
+    }
+
     switch (value_type) {
     case LY_TYPE_INST:
     case LY_TYPE_IDENT:
     case LY_TYPE_UNION:
         /* we do not actually fill value now, but value_str */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            *value_str = lydict_insert_zc(lybs->ctx, str);
-        }
+        ret = lyb_read_value_string(data, value_str, lybs);
         break;
     case LY_TYPE_BINARY:
     case LY_TYPE_STRING:
     case LY_TYPE_UNKNOWN:
         /* read string */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            value->string = lydict_insert_zc(lybs->ctx, str);
-        }
+        ret = lyb_read_value_string(data, &value->string, lybs);
         break;
     case LY_TYPE_BITS:
         value->bit = calloc(type->info.bits.count, sizeof *value->bit);
@@ -875,6 +970,109 @@ error:
     return -1;
 }
 
+/**
+ * @brief Schema children of one parent sorted by their collision ID 0 hash, created once per parse.
+ */
+struct lyb_sib_lookup {
+    const void *parent;                 /* schema parent or module of top-level nodes */
+    struct lys_node **snodes;           /* children sorted by the hash, in lys_getnext() order for the same hash */
+    uint32_t start[LYB_HASH_MASK + 2];  /* index of the first child with a (masked) hash, the last one is the count */
+};
+
+static int
+lyb_sib_lookup_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyb_sib_lookup *val1 = *(struct lyb_sib_lookup **)val1_p;
+    struct lyb_sib_lookup *val2 = *(struct lyb_sib_lookup **)val2_p;
+
+    return (val1->parent == val2->parent);
+}
+
+static struct lyb_sib_lookup *
+lyb_sib_lookup_get(const struct lys_node *sparent, const struct lys_module *mod, struct lyb_state *lybs)
+{
+    struct lyb_sib_lookup *lookup, key, *key_p = &key, **match;
+    struct lys_node *sibling;
+    uint32_t ht_hash, pos[LYB_HASH_MASK + 1], count;
+    int i;
+
+    key.parent = sparent ? (const void *)sparent : (const void *)mod;
+    ht_hash = dict_hash_multi(0, (const char *)&key.parent, sizeof key.parent);
+    ht_hash = dict_hash_multi(ht_hash, NULL, 0);
+
+    if (!lybs->sib_lookup) {
+        lybs->sib_lookup = lyht_new(8, sizeof key_p, lyb_sib_lookup_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RETURN(!lybs->sib_lookup, LOGMEM(lybs->ctx), NULL);
+    } else if (!lyht_find(lybs->sib_lookup, &key_p, ht_hash, (void **)&match)) {
+        return *match;
+    }
+
+    lookup = calloc(1, sizeof *lookup);
+    LY_CHECK_ERR_RETURN(!lookup, LOGMEM(lybs->ctx), NULL);
+    lookup->parent = key.parent;
+
+    /* count the children with each hash, skip schema nodes from models not present during printing */
+    count = 0;
+    sibling = NULL;
+    while ((sibling = (struct lys_node *)lys_getnext(sibling, sparent, mod, 0))) {
+        if (lyb_has_schema_model(sibling, lybs->models, lybs->mod_count)) {
+            ++lookup->start[(lyb_hash(sibling, 0) & LYB_HASH_MASK) + 1];
+            ++count;
+        }
+    }
+    for (i = 1; i < LYB_HASH_MASK + 2; ++i) {
+        lookup->start[i] += lookup->start[i - 1];
+    }
+
+    /* sort them */
+    if (count) {
+        lookup->snodes = malloc(count * sizeof *lookup->snodes);
+        LY_CHECK_ERR_GOTO(!lookup->snodes, LOGMEM(lybs->ctx), error);
+        memcpy(pos, lookup->start, sizeof pos);
+
+        sibling = NULL;
+        while ((sibling = (struct lys_node *)lys_getnext(sibling, sparent, mod, 0))) {
+            if (lyb_has_schema_model(sibling, lybs->models, lybs->mod_count)) {
+                lookup->snodes[pos[lyb_hash(sibling, 0) & LYB_HASH_MASK]++] = sibling;
+            }
+        }
+    }
+
+    if (lyht_insert(lybs->sib_lookup, &lookup, ht_hash, NULL)) {
+        LOGINT(lybs->ctx);
+        goto error;
+    }
+    return lookup;
+
+error:
+    free(lookup->snodes);
+    free(lookup);
+    return NULL;
+}
+
+static void
+lyb_sib_lookup_free(struct lyb_state *lybs)
+{
+    struct ht_rec *hrec;
+    struct lyb_sib_lookup *lookup;
+    uint32_t i;
+
+    if (!lybs->sib_lookup) {
+        return;
+    }
+
+    for (i = 0; i < lybs->sib_lookup->size; ++i) {
+        hrec = lyht_get_rec(lybs->sib_lookup->recs, lybs->sib_lookup->rec_size, i);
+        if (hrec->hits > 0) {
+            lookup = *(struct lyb_sib_lookup **)hrec->val;
+            free(lookup->snodes);
+            free(lookup);
+        }
+    }
+    lyht_free(lybs->sib_lookup);
+    lybs->sib_lookup = NULL;
+}
+
 static int
 lyb_is_schema_hash_match(struct lys_node *sibling, LYB_HASH *hash, uint8_t hash_count)
 {
@@ -898,7 +1096,9 @@ lyb_parse_schema_hash(const struct lys_node *sparent, const struct lys_module *m
 {
     int r, ret = 0;
     uint8_t i, j;
+    uint32_t k;
     struct lys_node *sibling;
+    struct lyb_sib_lookup *lookup;
     LYB_HASH hash[LYB_HASH_BITS - 1];
 
     assert((sparent || mod) && (!sparent || !mod));
@@ -957,12 +1157,16 @@ lyb_parse_schema_hash(const struct lys_node *sparent, const struct lys_module *m
         sparent = sibling;
     }
 
-    /* find our node with matching hashes */
+    /* find our node with matching hashes among the children with the same first hash */
+    lookup = lyb_sib_lookup_get(sparent, mod, lybs);
+    if (!lookup) {
+        return -1;
+    }
     sibling = NULL;
-    while ((sibling = (struct lys_node *)lys_getnext(sibling, sparent, mod, 0))) {
-        /* skip schema nodes from models not present during printing */
-        if (lyb_has_schema_model(sibling, lybs->models, lybs->mod_count) && lyb_is_schema_hash_match(sibling, hash, i + 1)) {
+    for (k = lookup->start[hash[0] & LYB_HASH_MASK]; k < lookup->start[(hash[0] & LYB_HASH_MASK) + 1]; ++k) {
+        if (lyb_is_schema_hash_match(lookup->snodes[k], hash, i + 1)) {
             /* match found */
+            sibling = lookup->snodes[k];
             break;
         }
     }
@@ -1002,20 +1206,16 @@ lyb_skip_subtree(const char *data, struct lyb_state *lybs)
     return ret;
 }
 
+/* read the node of a started subtree without its descendants, unknown data are not read and *node is NULL */
 static int
-lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **first_sibling, const char *yang_data_name,
-        int options, struct unres_data *unres, struct lyb_state *lybs)
+lyb_parse_node(const char *data, struct lyd_node *parent, const char *yang_data_name, int options,
+               struct unres_data *unres, struct lyd_node **node, struct lyb_state *lybs)
 {
     int r, ret = 0;
-    struct lyd_node *node = NULL, *iter;
     const struct lys_module *mod;
     struct lys_node *snode;
 
-    assert((parent && !first_sibling) || (!parent && first_sibling));
-
-    /* register a new subtree */
-    ret += (r = lyb_read_start_subtree(data, lybs));
-    LYB_HAVE_READ_GOTO(r, data, error);
+    *node = NULL;
 
     if (!parent) {
         /* top-level, read module name */
@@ -1036,21 +1236,19 @@ lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **f
     LYB_HAVE_READ_GOTO(r, data, error);
 
     if (!mod || !snode) {
-        /* unknown data subtree, skip it whole */
-        ret += (r = lyb_skip_subtree(data, lybs));
-        LYB_HAVE_READ_GOTO(r, data, error);
-        goto stop_subtree;
+        /* unknown data subtree */
+        return ret;
     }
 
     /*
      * read the node
      */
-    node = lyb_new_node(snode, options);
-    if (!node) {
+    *node = lyb_new_node(snode, options);
+    if (!*node) {
         goto error;
     }
 
-    ret += (r = lyb_parse_attributes(node, data, options, unres, lybs));
+    ret += (r = lyb_parse_attributes(*node, data, options, unres, lybs));
     LYB_HAVE_READ_GOTO(r, data, error);
 
     /* read node content */
@@ -1064,19 +1262,69 @@ lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **f
         break;
     case LYS_LEAF:
     case LYS_LEAFLIST:
-        ret += (r = lyb_parse_value(&((struct lys_node_leaf *)node->schema)->type, (struct lyd_node_leaf_list *)node,
+        ret += (r = lyb_parse_value(&((struct lys_node_leaf *)snode)->type, (struct lyd_node_leaf_list *)*node,
                                     NULL, data, unres, lybs));
         LYB_HAVE_READ_GOTO(r, data, error);
         break;
     case LYS_ANYXML:
     case LYS_ANYDATA:
-        ret += (r = lyb_parse_anydata(node, data, lybs));
+        ret += (r = lyb_parse_anydata(*node, data, lybs));
         LYB_HAVE_READ_GOTO(r, data, error);
         break;
     default:
         goto error;
     }
 
+    return ret;
+
+error:
+    lyd_free(*node);
+    *node = NULL;
+    return -1;
+}
+
+/* make a container default if should be, once all its children are parsed */
+static void
+lyb_node_dflt(struct lyd_node *node)
+{
+    struct lyd_node *iter;
+
+    if ((node->schema->nodetype == LYS_CONTAINER) && !((struct lys_node_container *)node->schema)->presence) {
+        LY_TREE_FOR(node->child, iter) {
+            if (!iter->dflt) {
+                break;
+            }
+        }
+
+        if (!iter) {
+            node->dflt = 1;
+        }
+    }
+}
+
+static int
+lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **first_sibling, const char *yang_data_name,
+        int options, struct unres_data *unres, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    struct lyd_node *node = NULL;
+
+    assert((parent && !first_sibling) || (!parent && first_sibling));
+
+    /* register a new subtree */
+    ret += (r = lyb_read_start_subtree(data, lybs));
+    LYB_HAVE_READ_GOTO(r, data, error);
+
+    ret += (r = lyb_parse_node(data, parent, yang_data_name, options, unres, &node, lybs));
+    LYB_HAVE_READ_GOTO(r, data, error);
+
+    if (!node) {
+        /* unknown data subtree, skip it whole */
+        ret += (r = lyb_skip_subtree(data, lybs));
+        LYB_HAVE_READ_GOTO(r, data, error);
+        goto stop_subtree;
+    }
+
     /* insert into data tree, manually */
     if (parent) {
         if (!parent->child) {
@@ -1105,26 +1353,7 @@ lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **f
         LYB_HAVE_READ_GOTO(r, data, error);
     }
 
-    /* make containers default if should be */
-    if ((node->schema->nodetype == LYS_CONTAINER) && !((struct lys_node_container *)node->schema)->presence) {
-        LY_TREE_FOR(node->child, iter) {
-            if (!iter->dflt) {
-                break;
-            }
-        }
-
-        if (!iter) {
-            node->dflt = 1;
-        }
-    }
-
-#ifdef LY_ENABLED_CACHE
-    /* calculate the hash and insert it into parent (list with keys is handled when its keys are inserted) */
-    if ((node->schema->nodetype != LYS_LIST) || !((struct lys_node_list *)node->schema)->keys_size) {
-        lyd_hash(node);
-        lyd_insert_hash(node);
-    }
-#endif
+    lyb_node_dflt(node);
 
 stop_subtree:
     /* end the subtree */
@@ -1199,85 +1428,668 @@ lyb_parse_header(const char *data, struct lyb_state *lybs)
     int ret = 0;
     uint8_t byte = 0;
 
-    /* TODO version, any flags? */
     ret += lyb_read(data, (uint8_t *)&byte, sizeof byte, lybs);
+    if (byte & ~LYB_HEADER_MASK) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Unsupported LYB header flags \"0x%02x\".", byte & ~LYB_HEADER_MASK);
+        return -1;
+    }
 
+    lybs->flags = byte;
     return ret;
 }
 
-struct lyd_node *
-lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *data_tree,
-              const char *yang_data_name, int *parsed)
+static int
+lyb_parse_strings(const char *data, struct lyb_state *lybs)
 {
-    int r = 0, ret = 0;
-    struct lyd_node *node = NULL, *next, *act_notif = NULL;
-    struct unres_data *unres = NULL;
-    struct lyb_state lybs;
+    int r, ret = 0;
+    uint64_t count, len;
+    char *str;
 
-    if (!ctx || !data) {
-        LOGARG;
-        return NULL;
+    /* read string count */
+    ret += (r = lyb_read_varint(&count, data, lybs));
+    LYB_HAVE_READ_RETURN(r, data, -1);
+    if (count > UINT32_MAX) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB string table size %" PRIu64 ".", count);
+        return -1;
     }
 
-    lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
-    lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
-    lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
-    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(ctx), finish);
-    lybs.used = 0;
-    lybs.size = LYB_STATE_STEP;
-    lybs.models = NULL;
-    lybs.mod_count = 0;
-    lybs.ctx = ctx;
-
-    unres = calloc(1, sizeof *unres);
-    LY_CHECK_ERR_GOTO(!unres, LOGMEM(ctx), finish);
-
-    /* read magic number */
-    ret += (r = lyb_parse_magic_number(data, &lybs));
-    LYB_HAVE_READ_GOTO(r, data, finish);
+    if (count && lybs->ctx) {
+        lybs->strs = malloc(count * sizeof *lybs->strs);
+        LY_CHECK_ERR_RETURN(!lybs->strs, LOGMEM(lybs->ctx), -1);
+    }
 
-    /* read header */
-    ret += (r = lyb_parse_header(data, &lybs));
-    LYB_HAVE_READ_GOTO(r, data, finish);
+    /* read strings */
+    for (lybs->str_count = 0; lybs->str_count < count; ++lybs->str_count) {
+        ret += (r = lyb_read_varint(&len, data, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
 
-    /* read used models */
-    ret += (r = lyb_parse_data_models(data, options, &lybs));
-    LYB_HAVE_READ_GOTO(r, data, finish);
+        if (lybs->ctx) {
+            str = malloc(len + 1);
+            LY_CHECK_ERR_RETURN(!str, LOGMEM(lybs->ctx), -1);
+            ret += (r = lyb_read(data, (uint8_t *)str, len, lybs));
+            if (r < 0) {
+                free(str);
+                return -1;
+            }
+            data += r;
+            str[len] = '\0';
 
-    /* read subtree(s) */
-    while (data[0]) {
-        ret += (r = lyb_parse_subtree(data, NULL, &node, yang_data_name, options, unres, &lybs));
-        if (r < 0) {
-            lyd_free_withsiblings(node);
-            node = NULL;
-            goto finish;
+            lybs->strs[lybs->str_count].str = lydict_insert_zc(lybs->ctx, str);
+            lybs->strs[lybs->str_count].hash = lyd_value_hash(lybs->strs[lybs->str_count].str);
+        } else {
+            /* only skipping the data */
+            ret += (r = lyb_read(data, NULL, len, lybs));
+            LYB_HAVE_READ_RETURN(r, data, -1);
         }
-        data += r;
     }
 
-    /* read the last zero, parsing finished */
-    ++ret;
-    r = ret;
+    return ret;
+}
 
-    if (options & LYD_OPT_DATA_ADD_YANGLIB) {
-        if (lyd_merge(node, ly_ctx_info(ctx), LYD_OPT_DESTRUCT | LYD_OPT_EXPLICIT)) {
-            LOGERR(ctx, LY_EINT, "Adding ietf-yang-library data failed.");
-            lyd_free_withsiblings(node);
-            node = NULL;
-            goto finish;
-        }
+static void
+lyb_strings_free(struct lyb_state *lybs)
+{
+    uint32_t i;
+
+    for (i = 0; lybs->strs && (i < lybs->str_count); ++i) {
+        lydict_remove(lybs->ctx, lybs->strs[i].str);
     }
+    free(lybs->strs);
+    lybs->strs = NULL;
+    lybs->str_count = 0;
+}
 
-    /* resolve any unresolved instance-identifiers */
-    if (unres->count) {
-        if (options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY | LYD_OPT_NOTIF)) {
-            LY_TREE_DFS_BEGIN(node, next, act_notif) {
-                if (act_notif->schema->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
-                    break;
-                }
-                LY_TREE_DFS_END(node, next, act_notif);
-            }
-        }
+static uint64_t
+lyb_index_number(const char *data, size_t bytes)
+{
+    uint64_t num = 0;
+
+    memcpy(&num, data, bytes);
+
+    /* correct byte order */
+    return le64toh(num);
+}
+
+static size_t
+lyb_index_length(const char *data)
+{
+    /* entry count, entries, and the index offset */
+    return 4 + lyb_index_number(data, 4) * LYB_INDEX_ENTRY_BYTES + 8;
+}
+
+static void
+lyb_index_entry(const char *data, struct lyb_index_entry *entry)
+{
+    entry->offset = lyb_index_number(data, 8);
+    entry->parent = lyb_index_number(data + 8, 4);
+    entry->hash = lyb_index_number(data + 12, 4);
+    entry->parent_written = data[16];
+    entry->parent_inner = data[17];
+}
+
+/* restore the parent state as it was before an indexed child was read */
+static int
+lyb_index_parent_state(const char *data, const struct lyb_index_entry *parent, const struct lyb_index_entry *entry,
+                       struct lyb_state *lybs)
+{
+    uint64_t chunk;
+
+    /* the current chunk of the parent, its meta information precedes the data and inner chunks before the child */
+    chunk = LYB_META_BYTES * (1 + (uint64_t)entry->parent_inner) + entry->parent_written;
+    if ((entry->offset < parent->offset + chunk) || (entry->offset - chunk < parent->offset)) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB index entry.");
+        return -1;
+    }
+
+    lybs->used = 0;
+    if (lyb_read_start_subtree(data + entry->offset - chunk, lybs) < 0) {
+        return -1;
+    }
+    if ((lybs->written[0] < entry->parent_written) || (lybs->inner_chunks[0] < entry->parent_inner)) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB index entry.");
+        return -1;
+    }
+    lybs->written[0] -= entry->parent_written;
+    lybs->inner_chunks[0] -= entry->parent_inner;
+
+    return 0;
+}
+
+/* maximum number of threads parsing the data */
+#define LYB_THREAD_MAX 16
+
+/* minimum size of data parsed by a thread at once */
+#define LYB_THREAD_TASK_MIN 16384
+
+/* forced number of parser threads, 0 for the number of online CPUs */
+static uint32_t lyb_thread_count;
+
+/* consecutive sibling subtrees parsed by a single thread */
+struct lyb_thread_task {
+    const char *data;           /* first subtree, NULL if the node was already parsed */
+    const char *end;            /* end of the last subtree, NULL for the end of the parent */
+    struct lyd_node *parent;    /* parent of the subtrees, NULL for top-level subtrees */
+    size_t written;             /* parent chunk state before the first subtree */
+    size_t position;
+    uint8_t inner_chunks;
+    struct lyd_node *first;     /* parsed siblings */
+};
+
+/* state shared by all the parser threads */
+struct lyb_thread_ctx {
+    struct lyb_thread_task *tasks;
+    uint32_t task_count;
+    uint32_t next_task;
+    int failed;
+    pthread_mutex_t lock;
+
+    const struct lyb_state *lybs;   /* models and strings, the schema caches filled lazily are updated atomically */
+    const char *yang_data_name;
+    int options;
+    enum int_log_opts log_opt;
+};
+
+struct lyb_thread {
+    pthread_t tid;
+    struct lyb_thread_ctx *tctx;
+    struct unres_data unres;
+    struct ly_err_item *eitem;  /* errors of the thread */
+};
+
+static struct lyb_thread_task *
+lyb_thread_task_new(struct lyb_thread_task **tasks, uint32_t *task_count, struct ly_ctx *ctx)
+{
+    struct lyb_thread_task *task;
+
+    if (!(*task_count & (*task_count - 1))) {
+        /* power of 2 (or 0), make the array twice as large */
+        *tasks = ly_realloc(*tasks, (*task_count ? *task_count * 2 : 8) * sizeof **tasks);
+        LY_CHECK_ERR_RETURN(!*tasks, LOGMEM(ctx), NULL);
+    }
+
+    task = &(*tasks)[(*task_count)++];
+    memset(task, 0, sizeof *task);
+    return task;
+}
+
+static int
+lyb_parse_thread_task(struct lyb_thread_task *task, struct lyb_thread_ctx *tctx, struct unres_data *unres,
+                      struct lyb_state *lybs)
+{
+    int r = 0;
+    const char *data = task->data;
+    struct lyd_node *scratch, *iter;
+
+    if (!task->parent) {
+        while (data < task->end) {
+            r = lyb_parse_subtree(data, NULL, &task->first, tctx->yang_data_name, tctx->options, unres, lybs);
+            LYB_HAVE_READ_RETURN(r, data, -1);
+        }
+    } else {
+        /* parse the children into an empty instance of the parent, in the chunk of the parent */
+        scratch = lyb_new_node(task->parent->schema, tctx->options);
+        if (!scratch) {
+            return -1;
+        }
+
+        lybs->used = 1;
+        lybs->written[0] = task->written;
+        lybs->position[0] = task->position;
+        lybs->inner_chunks[0] = task->inner_chunks;
+        while (lybs->written[0] && (!task->end || (data < task->end))) {
+            r = lyb_parse_subtree(data, scratch, NULL, NULL, tctx->options, unres, lybs);
+            LYB_HAVE_READ_GOTO(r, data, unlink);
+        }
+
+unlink:
+        lybs->used = 0;
+        task->first = scratch->child;
+        scratch->child = NULL;
+        lyd_free(scratch);
+        LY_TREE_FOR(task->first, iter) {
+            iter->parent = NULL;
+        }
+        if (r < 0) {
+            return -1;
+        }
+    }
+
+#ifdef LY_ENABLED_CACHE
+    /* hash the subtrees, the parent is hashed once all the children are linked to it */
+    lyd_hash_siblings(task->first);
+#endif
+
+    return 0;
+}
+
+static void *
+lyb_parse_thread(void *arg)
+{
+    struct lyb_thread *thr = (struct lyb_thread *)arg;
+    struct lyb_thread_ctx *tctx = thr->tctx;
+    struct lyb_thread_task *task;
+    struct lyb_state lybs;
+    int r = 0;
+
+    log_opt = tctx->log_opt;
+
+    /* private parser state */
+    memcpy(&lybs, tctx->lybs, sizeof lybs);
+    lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
+    lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
+    lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
+    lybs.used = 0;
+    lybs.size = LYB_STATE_STEP;
+    lybs.sib_lookup = NULL;
+    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(lybs.ctx); r = -1, finish);
+
+    while (1) {
+        pthread_mutex_lock(&tctx->lock);
+        if (tctx->failed || (tctx->next_task == tctx->task_count)) {
+            pthread_mutex_unlock(&tctx->lock);
+            break;
+        }
+        task = &tctx->tasks[tctx->next_task++];
+        pthread_mutex_unlock(&tctx->lock);
+
+        if (task->data && (r = lyb_parse_thread_task(task, tctx, &thr->unres, &lybs))) {
+            break;
+        }
+    }
+
+finish:
+    if (r) {
+        pthread_mutex_lock(&tctx->lock);
+        tctx->failed = 1;
+        pthread_mutex_unlock(&tctx->lock);
+    }
+    free(lybs.written);
+    free(lybs.position);
+    free(lybs.inner_chunks);
+    lyb_sib_lookup_free(&lybs);
+
+    thr->eitem = ly_err_detach(lybs.ctx);
+    return NULL;
+}
+
+/* skip a whole top-level subtree */
+static int
+lyb_parse_thread_skip(const char *data, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+
+    ret += (r = lyb_read_start_subtree(data, lybs));
+    LYB_HAVE_READ_RETURN(r, data, -1);
+    ret += (r = lyb_skip_subtree(data, lybs));
+    LYB_HAVE_READ_RETURN(r, data, -1);
+    lyb_read_stop_subtree(lybs);
+
+    return ret;
+}
+
+/* parse the node of a large top-level subtree and divide its children into tasks based on the index */
+static int
+lyb_parse_thread_split(const char *start, size_t size, const char *index, uint32_t top_idx, uint32_t idx_count,
+                       const char *yang_data_name, int options, struct unres_data *unres, size_t task_size,
+                       struct lyb_thread_task **tasks, uint32_t *task_count, struct lyb_state *lybs)
+{
+    int r;
+    const char *data;
+    struct lyd_node *node;
+    struct lyb_thread_task *task;
+    struct lyb_index_entry top, entry;
+    uint32_t i;
+
+    lyb_index_entry(index + top_idx * LYB_INDEX_ENTRY_BYTES, &top);
+    data = start + top.offset;
+
+    data += (r = lyb_read_start_subtree(data, lybs));
+    if (r < 0) {
+        return -1;
+    }
+    r = lyb_parse_node(data, NULL, yang_data_name, options, unres, &node, lybs);
+    if ((r < 0) || !node) {
+        /* error or unknown data subtree, skipped by the caller */
+        lybs->used = 0;
+        return (r < 0) ? -1 : 0;
+    }
+    data += r;
+
+    task = lyb_thread_task_new(tasks, task_count, lybs->ctx);
+    LY_CHECK_ERR_RETURN(!task, lyd_free(node); lybs->used = 0, -1);
+    task->first = node;
+
+    if (!(node->schema->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_NOTIF | LYS_RPC | LYS_ACTION))) {
+        /* no children, the node is complete */
+        lybs->used = 0;
+        return 0;
+    }
+
+    /* the children before the first indexed one are parsed from the current state */
+    task = lyb_thread_task_new(tasks, task_count, lybs->ctx);
+    LY_CHECK_ERR_RETURN(!task, lybs->used = 0, -1);
+    task->data = data;
+    task->parent = node;
+    task->written = lybs->written[0];
+    task->position = lybs->position[0];
+    task->inner_chunks = lybs->inner_chunks[0];
+    lybs->used = 0;
+
+    /* the indexed children follow their parent */
+    for (i = top_idx + 1; i < idx_count; ++i) {
+        lyb_index_entry(index + i * LYB_INDEX_ENTRY_BYTES, &entry);
+        if (entry.parent != top_idx) {
+            break;
+        }
+        if ((start + entry.offset < task->data) || (entry.offset >= top.offset + size)) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB index entry.");
+            return -1;
+        }
+        if ((size_t)(start + entry.offset - task->data) < task_size) {
+            continue;
+        }
+
+        task->end = start + entry.offset;
+        task = lyb_thread_task_new(tasks, task_count, lybs->ctx);
+        LY_CHECK_RETURN(!task, -1);
+        task->data = start + entry.offset;
+        task->parent = node;
+        if (lyb_index_parent_state(start, &top, &entry, lybs)) {
+            return -1;
+        }
+        task->written = lybs->written[0];
+        task->position = lybs->position[0];
+        task->inner_chunks = lybs->inner_chunks[0];
+        lybs->used = 0;
+    }
+
+    return 0;
+}
+
+void
+lyb_set_thread_count(uint32_t count)
+{
+    lyb_thread_count = count;
+}
+
+/* parse all the top-level subtrees in several threads */
+static int
+lyb_parse_threads(const char *start, const char *data, const char *yang_data_name, int options,
+                  struct unres_data *unres, struct lyd_node **first, struct lyb_state *lybs)
+{
+    int r, ret = -1;
+    const char *subtrees = data, *index = NULL;
+    long cpus;
+    size_t task_size;
+    uint32_t i, j, idx = 0, idx_count = 0, task_count = 0, thr_count;
+    struct lyb_thread_task *tasks = NULL, *task = NULL;
+    struct lyb_thread_ctx tctx;
+    struct lyb_thread *thrs = NULL;
+    struct lyb_index_entry entry = {0};
+    struct lyd_node *node, *parent, **sibling, *last, *iter;
+
+    memset(&tctx, 0, sizeof tctx);
+
+    /* find the end of the data */
+    for (i = 0; data[i]; i += r) {
+        if ((r = lyb_parse_thread_skip(data + i, lybs)) < 0) {
+            goto cleanup;
+        }
+    }
+
+    cpus = lyb_thread_count ? (long)lyb_thread_count : sysconf(_SC_NPROCESSORS_ONLN);
+    thr_count = (cpus < 1) ? 1 : ((cpus > LYB_THREAD_MAX) ? LYB_THREAD_MAX : cpus);
+    task_size = i / (thr_count * 8);
+    if (task_size < LYB_THREAD_TASK_MIN) {
+        task_size = LYB_THREAD_TASK_MIN;
+    }
+
+    if (lybs->flags & LYB_HEADER_INDEX) {
+        /* the index follows the last zero */
+        index = data + i + 1;
+        idx_count = lyb_index_number(index, 4);
+        index += 4;
+    }
+
+    /* divide the subtrees into tasks, large ones with an index are split into their children */
+    while (data[0]) {
+        for (; idx < idx_count; ++idx) {
+            lyb_index_entry(index + idx * LYB_INDEX_ENTRY_BYTES, &entry);
+            if ((entry.parent == LYB_INDEX_TOP) && (start + entry.offset >= data)) {
+                break;
+            }
+        }
+
+        if ((r = lyb_parse_thread_skip(data, lybs)) < 0) {
+            goto cleanup;
+        }
+
+        if ((idx < idx_count) && (start + entry.offset == data) && ((size_t)r > 2 * task_size)) {
+            if (lyb_parse_thread_split(start, r, index, idx, idx_count, yang_data_name, options, unres, task_size,
+                                       &tasks, &task_count, lybs)) {
+                goto cleanup;
+            }
+            task = NULL;
+        } else {
+            if (!task || ((size_t)(data - task->data) >= task_size)) {
+                task = lyb_thread_task_new(&tasks, &task_count, lybs->ctx);
+                LY_CHECK_GOTO(!task, cleanup);
+                task->data = data;
+            }
+            task->end = data + r;
+        }
+        data += r;
+    }
+
+    /* parse the tasks, the current thread is one of the threads */
+    for (i = 0, j = 0; i < task_count; ++i) {
+        if (tasks[i].data) {
+            ++j;
+        }
+    }
+    if (thr_count > j) {
+        thr_count = j ? j : 1;
+    }
+    thrs = calloc(thr_count, sizeof *thrs);
+    LY_CHECK_ERR_GOTO(!thrs, LOGMEM(lybs->ctx), cleanup);
+
+    tctx.tasks = tasks;
+    tctx.task_count = task_count;
+    tctx.lybs = lybs;
+    tctx.yang_data_name = yang_data_name;
+    tctx.options = options;
+    tctx.log_opt = log_opt;
+    pthread_mutex_init(&tctx.lock, NULL);
+
+    for (i = 0; i < thr_count; ++i) {
+        thrs[i].tctx = &tctx;
+    }
+    for (i = 1; i < thr_count; ++i) {
+        if (pthread_create(&thrs[i].tid, NULL, lyb_parse_thread, &thrs[i])) {
+            /* use only the threads created so far */
+            thr_count = i;
+            break;
+        }
+    }
+    lyb_parse_thread(&thrs[0]);
+    for (i = 1; i < thr_count; ++i) {
+        pthread_join(thrs[i].tid, NULL);
+    }
+    pthread_mutex_destroy(&tctx.lock);
+
+    /* merge the errors and unresolved items of all the threads */
+    for (i = 0; i < thr_count; ++i) {
+        ly_err_attach(lybs->ctx, thrs[i].eitem);
+        for (j = 0; !tctx.failed && (j < thrs[i].unres.count); ++j) {
+            if (unres_data_add(unres, thrs[i].unres.node[j], thrs[i].unres.type[j])) {
+                tctx.failed = 1;
+            }
+        }
+        free(thrs[i].unres.node);
+        free(thrs[i].unres.type);
+    }
+    if (tctx.failed) {
+        goto cleanup;
+    }
+
+    /* link the parsed subtrees in their original order */
+    for (i = 0; i < task_count; ++i) {
+        node = tasks[i].first;
+        if (!node) {
+            continue;
+        }
+
+        parent = tasks[i].parent;
+        sibling = parent ? &parent->child : first;
+        if (!*sibling) {
+            *sibling = node;
+        } else {
+            /* append the siblings */
+            last = node->prev;
+            (*sibling)->prev->next = node;
+            node->prev = (*sibling)->prev;
+            (*sibling)->prev = last;
+        }
+        if (parent) {
+            LY_TREE_FOR(node, iter) {
+                iter->parent = parent;
+            }
+        }
+    }
+
+    /* finish the nodes parsed before their children */
+    for (i = 0; i < task_count; ++i) {
+        if (!tasks[i].data) {
+            lyb_node_dflt(tasks[i].first);
+#ifdef LY_ENABLED_CACHE
+            if (tasks[i].first->schema->nodetype & (LYS_LIST | LYS_CONTAINER | LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+                lyd_hash_parent(tasks[i].first);
+            } else {
+                lyd_hash(tasks[i].first);
+            }
+#endif
+        }
+    }
+
+    ret = data - subtrees;
+
+cleanup:
+    if (ret < 0) {
+        for (i = 0; i < task_count; ++i) {
+            lyd_free_withsiblings(tasks[i].first);
+        }
+    }
+    free(thrs);
+    free(tasks);
+    return ret;
+}
+
+struct lyd_node *
+lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *data_tree,
+              const char *yang_data_name, int *parsed)
+{
+    int r = 0, ret = 0, threads;
+    const char *start = data;
+    struct lyd_node *node = NULL, *next, *act_notif = NULL;
+    struct unres_data *unres = NULL;
+    struct lyb_state lybs;
+
+    if (!ctx || !data) {
+        LOGARG;
+        return NULL;
+    }
+
+    lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
+    lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
+    lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
+    lybs.sib_lookup = NULL;
+    lybs.flags = 0;
+    lybs.strs = NULL;
+    lybs.str_count = 0;
+    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(ctx), finish);
+    lybs.used = 0;
+    lybs.size = LYB_STATE_STEP;
+    lybs.models = NULL;
+    lybs.mod_count = 0;
+    lybs.ctx = ctx;
+
+    unres = calloc(1, sizeof *unres);
+    LY_CHECK_ERR_GOTO(!unres, LOGMEM(ctx), finish);
+
+    /* read magic number */
+    ret += (r = lyb_parse_magic_number(data, &lybs));
+    LYB_HAVE_READ_GOTO(r, data, finish);
+
+    /* read header */
+    ret += (r = lyb_parse_header(data, &lybs));
+    LYB_HAVE_READ_GOTO(r, data, finish);
+    if (lybs.flags & LYB_HEADER_DIFF) {
+        LOGERR(ctx, LY_EINVAL, "LYB data are a change set, it can only be applied with lyd_lyb_apply_diff().");
+        r = -1;
+        goto finish;
+    }
+
+    /* read used models */
+    ret += (r = lyb_parse_data_models(data, options, &lybs));
+    LYB_HAVE_READ_GOTO(r, data, finish);
+
+    if (lybs.flags & LYB_HEADER_COMPACT) {
+        /* read the string table */
+        ret += (r = lyb_parse_strings(data, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    }
+
+    /* read subtree(s), the module callback may change the context so it cannot be called by several threads */
+    threads = (options & LYD_OPT_LYB_THREADS) && !ctx->data_clb;
+    if (threads) {
+        ret += (r = lyb_parse_threads(start, data, yang_data_name, options, unres, &node, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    } else {
+        while (data[0]) {
+            ret += (r = lyb_parse_subtree(data, NULL, &node, yang_data_name, options, unres, &lybs));
+            if (r < 0) {
+                lyd_free_withsiblings(node);
+                node = NULL;
+                goto finish;
+            }
+            data += r;
+        }
+    }
+
+    /* read the last zero, parsing finished */
+    ++ret;
+    if (lybs.flags & LYB_HEADER_INDEX) {
+        /* skip the index */
+        ret += lyb_index_length(data + 1);
+    }
+    r = ret;
+
+#ifdef LY_ENABLED_CACHE
+    if (!threads) {
+        /* hash the whole parsed tree at once, the threads have hashed their subtrees */
+        lyd_hash_siblings(node);
+    }
+#endif
+
+    if (options & LYD_OPT_DATA_ADD_YANGLIB) {
+        if (lyd_merge(node, ly_ctx_info(ctx), LYD_OPT_DESTRUCT | LYD_OPT_EXPLICIT)) {
+            LOGERR(ctx, LY_EINT, "Adding ietf-yang-library data failed.");
+            lyd_free_withsiblings(node);
+            node = NULL;
+            goto finish;
+        }
+    }
+
+    /* resolve any unresolved instance-identifiers */
+    if (unres->count) {
+        if (options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY | LYD_OPT_NOTIF)) {
+            LY_TREE_DFS_BEGIN(node, next, act_notif) {
+                if (act_notif->schema->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+                    break;
+                }
+                LY_TREE_DFS_END(node, next, act_notif);
+            }
+        }
         if (lyd_defaults_add_unres(&node, options, ctx, NULL, 0, data_tree, act_notif, unres, 0)) {
             lyd_free_withsiblings(node);
             node = NULL;
@@ -1290,6 +2102,8 @@ finish:
     free(lybs.position);
     free(lybs.inner_chunks);
     free(lybs.models);
+    lyb_sib_lookup_free(&lybs);
+    lyb_strings_free(&lybs);
     if (unres) {
         free(unres->node);
         free(unres->type);
@@ -1319,7 +2133,11 @@ lyd_lyb_data_length(const char *data)
     lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
     lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
     lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
-    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(NULL), finish);
+    lybs.sib_lookup = NULL;
+    lybs.flags = 0;
+    lybs.strs = NULL;
+    lybs.str_count = 0;
+    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(NULL); r = -1, finish);
     lybs.used = 0;
     lybs.size = LYB_STATE_STEP;
     lybs.models = NULL;
@@ -1354,7 +2172,13 @@ lyd_lyb_data_length(const char *data)
         LYB_HAVE_READ_GOTO(r, data, finish);
     }
 
-    while (data[0]) {
+    if (lybs.flags & LYB_HEADER_COMPACT) {
+        /* skip the string table */
+        ret += (r = lyb_parse_strings(data, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    }
+
+    while (data[0]) {
         /* register a new subtree */
         ret += (r = lyb_read_start_subtree(data, &lybs));
         LYB_HAVE_READ_GOTO(r, data, finish);
@@ -1369,11 +2193,546 @@ lyd_lyb_data_length(const char *data)
 
     /* read the last zero, parsing finished */
     ++ret;
+    if (lybs.flags & LYB_HEADER_INDEX) {
+        /* the index */
+        ret += lyb_index_length(data + 1);
+    }
 
 finish:
+    if (r < 0) {
+        ret = -1;
+    }
     free(lybs.written);
     free(lybs.position);
     free(lybs.inner_chunks);
     free(lybs.models);
+    lyb_sib_lookup_free(&lybs);
+    lyb_strings_free(&lybs);
+    return ret;
+}
+
+static int
+lyb_parse_index_child(const char *data, const struct lyb_index_entry *parent, const struct lyb_index_entry *entry,
+                      struct lyd_node *parent_node, int options, struct unres_data *unres, struct lyb_state *lybs)
+{
+    int r;
+
+    if (lyb_index_parent_state(data, parent, entry, lybs)) {
+        return -1;
+    }
+
+    r = lyb_parse_subtree(data + entry->offset, parent_node, NULL, NULL, options, unres, lybs);
+    lybs->used = 0;
+
+    return r;
+}
+
+API struct lyd_node *
+lyd_lyb_parse_subtree(struct ly_ctx *ctx, const char *data, size_t data_len, int options, const char *path)
+{
+    FUN_IN;
+
+    int r;
+    uint32_t i, j, count, hash, child_hash = 0;
+    uint64_t index_offset;
+    const char *start = data, *index;
+    struct lyb_index_entry entry, child_entry;
+    struct lyd_node *scratch = NULL, *target = NULL, *node = NULL, *last;
+    struct unres_data *unres = NULL;
+    struct lyb_state lybs;
+
+    if (!ctx || !data || !path) {
+        LOGARG;
+        return NULL;
+    }
+
+    lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
+    lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
+    lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
+    lybs.models = NULL;
+    lybs.sib_lookup = NULL;
+    lybs.flags = 0;
+    lybs.strs = NULL;
+    lybs.str_count = 0;
+    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(ctx), finish);
+    lybs.used = 0;
+    lybs.size = LYB_STATE_STEP;
+    lybs.mod_count = 0;
+    lybs.ctx = ctx;
+
+    unres = calloc(1, sizeof *unres);
+    LY_CHECK_ERR_GOTO(!unres, LOGMEM(ctx), finish);
+
+    /* read magic number */
+    r = lyb_parse_magic_number(data, &lybs);
+    LYB_HAVE_READ_GOTO(r, data, finish);
+
+    /* read header */
+    r = lyb_parse_header(data, &lybs);
+    LYB_HAVE_READ_GOTO(r, data, finish);
+    if (!(lybs.flags & LYB_HEADER_INDEX)) {
+        LOGERR(ctx, LY_EINVAL, "LYB data do not include an index.");
+        goto finish;
+    }
+
+    /* read used models */
+    r = lyb_parse_data_models(data, options, &lybs);
+    LYB_HAVE_READ_GOTO(r, data, finish);
+
+    if (lybs.flags & LYB_HEADER_COMPACT) {
+        /* read the string table */
+        r = lyb_parse_strings(data, &lybs);
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    }
+
+    /* find the index from the end of the data */
+    if (data_len < (size_t)(data - start) + 13) {
+        LOGERR(ctx, LY_EINVAL, "Invalid LYB index.");
+        goto finish;
+    }
+    index_offset = lyb_index_number(start + data_len - 8, 8);
+    if ((index_offset < (uint64_t)(data - start)) || (index_offset > data_len - 12)) {
+        LOGERR(ctx, LY_EINVAL, "Invalid LYB index.");
+        goto finish;
+    }
+    index = start + index_offset;
+    count = lyb_index_number(index, 4);
+    if ((data_len - 12 - index_offset) / LYB_INDEX_ENTRY_BYTES < count) {
+        LOGERR(ctx, LY_EINVAL, "Invalid LYB index.");
+        goto finish;
+    }
+    index += 4;
+
+    /* create the node with all its keys and parents to match the index entries with */
+    scratch = lyd_new_path(NULL, ctx, path, NULL, 0, 0);
+    if (!scratch) {
+        goto finish;
+    }
+    hash = lyb_index_hash(scratch);
+    if (scratch->schema->nodetype & (LYS_CONTAINER | LYS_LIST)) {
+        LY_TREE_FOR(scratch->child, target) {
+            if ((target->schema->nodetype != LYS_LEAF) || !lys_is_key((struct lys_node_leaf *)target->schema, NULL)) {
+                break;
+            }
+        }
+        if (target && ((target->schema->nodetype != LYS_LIST) || !((struct lys_node_list *)target->schema)->keys_size)) {
+            /* not indexed, the whole top-level subtree is parsed */
+            target = NULL;
+        }
+    }
+    if (target) {
+        child_hash = lyb_index_hash(target);
+        lyd_unlink(target);
+    }
+
+    for (i = 0; i < count; ++i) {
+        lyb_index_entry(index + i * LYB_INDEX_ENTRY_BYTES, &entry);
+        if ((entry.parent != LYB_INDEX_TOP) || (entry.hash != hash)) {
+            continue;
+        }
+        if (entry.offset >= index_offset) {
+            LOGERR(ctx, LY_EINVAL, "Invalid LYB index entry.");
+            goto finish;
+        }
+
+        if (!target) {
+            /* parse the whole top-level subtree */
+            lybs.used = 0;
+            r = lyb_parse_subtree(start + entry.offset, NULL, &node, NULL, options, unres, &lybs);
+            if (r < 0) {
+                goto finish;
+            }
+            if (node && ((node->schema != scratch->schema)
+                    || ((node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) && (lyd_list_equal(node, scratch, 0) != 1)))) {
+                /* hash collision */
+                lyd_free(node);
+                node = NULL;
+            }
+            if (node) {
+                break;
+            }
+            continue;
+        }
+
+        /* parse only the list instance under the created top-level node */
+        for (j = i + 1; j < count; ++j) {
+            lyb_index_entry(index + j * LYB_INDEX_ENTRY_BYTES, &child_entry);
+            if (child_entry.parent == LYB_INDEX_TOP) {
+                /* entries of the children follow their parent */
+                break;
+            }
+            if ((child_entry.parent != i) || (child_entry.hash != child_hash)) {
+                continue;
+            }
+            if (child_entry.offset >= index_offset) {
+                LOGERR(ctx, LY_EINVAL, "Invalid LYB index entry.");
+                goto finish;
+            }
+
+            last = scratch->child ? scratch->child->prev : NULL;
+            r = lyb_parse_index_child(start, &entry, &child_entry, scratch, options, unres, &lybs);
+            if (r < 0) {
+                goto finish;
+            }
+            if (scratch->child && (scratch->child->prev != last)) {
+                if ((scratch->child->prev->schema == target->schema)
+                        && (lyd_list_equal(scratch->child->prev, target, 0) == 1)) {
+                    /* found */
+                    node = scratch;
+                    scratch = NULL;
+                    break;
+                }
+
+                /* hash collision */
+                lyd_free(scratch->child->prev);
+            }
+        }
+        if (node) {
+            break;
+        }
+    }
+
+    if (!node) {
+        /* not found */
+        goto finish;
+    }
+
+#ifdef LY_ENABLED_CACHE
+    /* hash the whole parsed tree at once */
+    lyd_hash_siblings(node);
+#endif
+
+    /* resolve references, the targets need not be present */
+    if (unres->count && lyd_defaults_add_unres(&node, options | LYD_OPT_TRUSTED, ctx, NULL, 0, NULL, NULL, unres, 0)) {
+        lyd_free_withsiblings(node);
+        node = NULL;
+    }
+
+finish:
+    lyd_free(target);
+    lyd_free(scratch);
+    free(lybs.written);
+    free(lybs.position);
+    free(lybs.inner_chunks);
+    free(lybs.models);
+    lyb_sib_lookup_free(&lybs);
+    lyb_strings_free(&lybs);
+    if (unres) {
+        free(unres->node);
+        free(unres->type);
+        free(unres);
+    }
+
+    return node;
+}
+
+static struct lyd_node *
+lyb_diff_find(struct lyd_node *root, const char *path, struct lyb_state *lybs)
+{
+    struct lyd_node *node = NULL;
+    int parsed = 0;
+
+    if (root) {
+        /* uses the hashes of the data nodes, unlike XPath */
+        node = resolve_partial_json_data_nodeid(path, NULL, root, 0, &parsed);
+        if (parsed == -1) {
+            return NULL;
+        } else if (parsed != (signed)strlen(path)) {
+            node = NULL;
+        }
+    }
+
+    if (!node) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Node \"%s\" of the LYB change set not found.", path);
+    }
+    return node;
+}
+
+static int
+lyb_parse_diff_node(const char *data, struct lyd_node *parent, struct lyd_node **node, int options,
+                    struct unres_data *unres, struct lyb_state *lybs)
+{
+    int r;
+    struct lyd_node *scratch = NULL;
+
+    *node = NULL;
+    if (parent) {
+        /* parse the child into an empty instance of the parent, the schema hash is relative to it */
+        scratch = lyb_new_node(parent->schema, options);
+        if (!scratch) {
+            return -1;
+        }
+        r = lyb_parse_subtree(data, scratch, NULL, NULL, options, unres, lybs);
+        if ((r > -1) && scratch->child) {
+            *node = scratch->child;
+            (*node)->parent = NULL;
+            scratch->child = NULL;
+        }
+        lyd_free(scratch);
+    } else {
+        r = lyb_parse_subtree(data, NULL, node, NULL, options, unres, lybs);
+    }
+    if (r < 0) {
+        return -1;
+    } else if (!*node) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Unknown node in the LYB change set.");
+        return -1;
+    }
+
+#ifdef LY_ENABLED_CACHE
+    lyd_hash_siblings(*node);
+#endif
+
+    return r;
+}
+
+static int
+lyb_parse_diff_move(struct lyd_node **root, struct lyd_node *node, const char *anchor, struct lyb_state *lybs)
+{
+    struct lyd_node *iter;
+
+    if (anchor[0]) {
+        iter = lyb_diff_find(*root, anchor, lybs);
+        if (!iter) {
+            return -1;
+        }
+        return lyd_insert_after(iter, node) ? -1 : 0;
+    }
+
+    /* move before the first instance */
+    for (iter = node->parent ? node->parent->child : *root; iter->schema != node->schema; iter = iter->next);
+    if (iter == node) {
+        return 0;
+    }
+    return lyd_insert_before(iter, node) ? -1 : 0;
+}
+
+/**
+ * @brief Forget unresolved items of all the nodes in a subtree that is going to be freed. Nodes created
+ * by previous entries of the change set may be freed by the next ones.
+ *
+ * @param[in] unres Unresolved data items.
+ * @param[in] subtree Subtree to be freed.
+ */
+static void
+lyb_diff_unres_forget(struct unres_data *unres, const struct lyd_node *subtree)
+{
+    const struct lyd_node *iter;
+    uint32_t i, j;
+
+    for (i = 0, j = 0; i < unres->count; ++i) {
+        for (iter = unres->node[i]; iter && (iter != subtree); iter = iter->parent);
+        if (iter) {
+            /* node in the subtree */
+            continue;
+        }
+
+        unres->node[j] = unres->node[i];
+        unres->type[j] = unres->type[i];
+        ++j;
+    }
+    unres->count = j;
+}
+
+static int
+lyb_parse_diff_entry(const char *data, struct lyd_node **root, int options, struct unres_data *unres,
+                     struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint8_t type = 0;
+    uint32_t unres_count;
+    char *path = NULL, *anchor = NULL;
+    struct lyd_node *node = NULL, *parent = NULL, *new_node = NULL;
+
+    /* register a new subtree */
+    ret += (r = lyb_read_start_subtree(data, lybs));
+    LYB_HAVE_READ_GOTO(r, data, error);
+
+    /* difference type and the node path */
+    ret += (r = lyb_read(data, &type, sizeof type, lybs));
+    LYB_HAVE_READ_GOTO(r, data, error);
+    ret += (r = lyb_read_string(data, &path, 1, lybs));
+    LYB_HAVE_READ_GOTO(r, data, error);
+
+    switch (type) {
+    case LYD_DIFF_DELETED:
+        node = lyb_diff_find(*root, path, lybs);
+        if (!node) {
+            goto error;
+        }
+        if (node == *root) {
+            *root = node->next;
+        }
+        lyb_diff_unres_forget(unres, node);
+        lyd_free(node);
+        break;
+    case LYD_DIFF_CHANGED:
+        node = lyb_diff_find(*root, path, lybs);
+        if (!node) {
+            goto error;
+        }
+
+        unres_count = unres->count;
+        ret += (r = lyb_parse_diff_node(data, node->parent, &new_node, options, unres, lybs));
+        LYB_HAVE_READ_GOTO(r, data, error);
+        if ((node->schema != new_node->schema) || !(node->schema->nodetype & (LYS_LEAF | LYS_ANYDATA))) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid change of node \"%s\" in the LYB change set.", path);
+            goto error;
+        }
+
+        if (node->schema->nodetype == LYS_LEAF) {
+            /* the new value is parsed again, forget the references of the parsed node */
+            unres->count = unres_count;
+            if (lyd_change_leaf((struct lyd_node_leaf_list *)node, ((struct lyd_node_leaf_list *)new_node)->value_str) < 0) {
+                goto error;
+            }
+            lyd_free(new_node);
+        } else {
+            /* replace the whole anydata node */
+            if (lyd_insert_after(node, new_node)) {
+                goto error;
+            }
+            if (node == *root) {
+                *root = new_node;
+            }
+            lyb_diff_unres_forget(unres, node);
+            lyd_free(node);
+        }
+        new_node = NULL;
+        break;
+    case LYD_DIFF_CREATED:
+        if (path[0]) {
+            parent = lyb_diff_find(*root, path, lybs);
+            if (!parent) {
+                goto error;
+            }
+        }
+
+        ret += (r = lyb_parse_diff_node(data, parent, &new_node, options, unres, lybs));
+        LYB_HAVE_READ_GOTO(r, data, error);
+
+        if (parent) {
+            r = lyd_insert(parent, new_node);
+        } else if (*root) {
+            r = lyd_insert_sibling(root, new_node);
+        } else {
+            *root = new_node;
+            r = 0;
+        }
+        if (r) {
+            goto error;
+        }
+        new_node = NULL;
+        break;
+    case LYD_DIFF_MOVEDAFTER1:
+    case LYD_DIFF_MOVEDAFTER2:
+        ret += (r = lyb_read_string(data, &anchor, 1, lybs));
+        LYB_HAVE_READ_GOTO(r, data, error);
+
+        node = lyb_diff_find(*root, path, lybs);
+        if (!node || lyb_parse_diff_move(root, node, anchor, lybs)) {
+            goto error;
+        }
+        break;
+    default:
+        LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB change set difference type %u.", type);
+        goto error;
+    }
+
+    /* the first top-level sibling may have been moved */
+    if (*root) {
+        for (; (*root)->prev->next; *root = (*root)->prev);
+    }
+
+    /* end the subtree */
+    lyb_read_stop_subtree(lybs);
+
+    free(path);
+    free(anchor);
     return ret;
+
+error:
+    lyd_free(new_node);
+    free(path);
+    free(anchor);
+    return -1;
+}
+
+API int
+lyd_lyb_apply_diff(struct lyd_node **root, struct ly_ctx *ctx, const char *data, int options)
+{
+    FUN_IN;
+
+    int r, rc = EXIT_FAILURE;
+    struct unres_data *unres = NULL;
+    struct lyb_state lybs;
+
+    if (!root || (!*root && !ctx) || !data) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+    if (!ctx) {
+        ctx = lyd_node_module(*root)->ctx;
+    }
+
+    lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
+    lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
+    lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
+    lybs.models = NULL;
+    lybs.sib_lookup = NULL;
+    lybs.flags = 0;
+    lybs.strs = NULL;
+    lybs.str_count = 0;
+    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(ctx), finish);
+    lybs.used = 0;
+    lybs.size = LYB_STATE_STEP;
+    lybs.mod_count = 0;
+    lybs.ctx = ctx;
+
+    unres = calloc(1, sizeof *unres);
+    LY_CHECK_ERR_GOTO(!unres, LOGMEM(ctx), finish);
+
+    /* read magic number */
+    r = lyb_parse_magic_number(data, &lybs);
+    LYB_HAVE_READ_GOTO(r, data, finish);
+
+    /* read header */
+    r = lyb_parse_header(data, &lybs);
+    LYB_HAVE_READ_GOTO(r, data, finish);
+    if (!(lybs.flags & LYB_HEADER_DIFF)) {
+        LOGERR(ctx, LY_EINVAL, "LYB data are not a change set.");
+        goto finish;
+    }
+
+    /* read used models */
+    r = lyb_parse_data_models(data, options, &lybs);
+    LYB_HAVE_READ_GOTO(r, data, finish);
+
+    /* apply all the differences */
+    while (data[0]) {
+        r = lyb_parse_diff_entry(data, root, options, unres, &lybs);
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    }
+
+    /* resolve references of the new nodes */
+    if (unres->count && lyd_defaults_add_unres(root, options | LYD_OPT_TRUSTED, ctx, NULL, 0, NULL, NULL, unres, 0)) {
+        goto finish;
+    }
+
+    rc = EXIT_SUCCESS;
+
+finish:
+    free(lybs.written);
+    free(lybs.position);
+    free(lybs.inner_chunks);
+    free(lybs.models);
+    lyb_sib_lookup_free(&lybs);
+    lyb_strings_free(&lybs);
+    if (unres) {
+        free(unres->node);
+        free(unres->type);
+        free(unres);
+    }
+
+    return rc;
 }
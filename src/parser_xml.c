@@ -73,6 +73,24 @@ xml_data_search_schemanode(struct lyxml_elem *xml, struct lys_node *start, int o
     return NULL;
 }
 
+/* does not log */
+static struct lys_node *
+xml_data_find_schemanode(struct lyxml_elem *xml, struct lys_node *parent, const struct lys_module *mod, int options)
+{
+    const struct lys_node *snode;
+
+    /* use the schema node index, if possible */
+    switch (lys_node_idx_find(parent, mod, NULL, xml->ns->value, xml->name, strlen(xml->name), 0,
+                              LYS_GETNEXT_NOSTATECHECK, &snode)) {
+    case 0:
+        return (struct lys_node *)snode;
+    case 1:
+        return NULL;
+    default:
+        return xml_data_search_schemanode(xml, parent ? parent->child : mod->data, options);
+    }
+}
+
 /* logs directly */
 static int
 xml_get_value(struct lyd_node *node, struct lyxml_elem *xml, int editbits)
@@ -163,7 +181,7 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
                     }
                 }
             } else {
-                schema = xml_data_search_schemanode(xml, mod->data, options);
+                schema = xml_data_find_schemanode(xml, NULL, mod, options);
                 if (!schema) {
                     /* it still can be the specific case of this module containing an augment of another module
                     * top-level choice or top-level choice's case, bleh */
@@ -195,7 +213,7 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
         }
     } else {
         /* parsing some internal node, we start with parent's schema pointer */
-        schema = xml_data_search_schemanode(xml, parent->schema->child, options);
+        schema = xml_data_find_schemanode(xml, parent->schema, NULL, options);
 
         if (ctx->data_clb) {
             if (schema && !lys_node_module(schema)->implemented) {
@@ -204,7 +222,7 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
             } else if (!schema) {
                 if (ctx->data_clb(ctx, NULL, xml->ns->value, 0, ctx->data_clb_data)) {
                     /* context was updated, so try to find the schema node again */
-                    schema = xml_data_search_schemanode(xml, parent->schema->child, options);
+                    schema = xml_data_find_schemanode(xml, parent->schema, NULL, options);
                 }
             }
         }
@@ -495,14 +513,6 @@ attr_error:
         *act_notif = *result;
     }
 
-#ifdef LY_ENABLED_CACHE
-    /* calculate the hash and insert it into parent (list with keys is handled when its keys are inserted) */
-    if (((*result)->schema->nodetype != LYS_LIST) || !((struct lys_node_list *)(*result)->schema)->keys_size) {
-        lyd_hash(*result);
-        lyd_insert_hash(*result);
-    }
-#endif
-
     /* first part of validation checks */
     if (lyv_data_context(*result, options, unres)) {
         goto error;
@@ -716,6 +726,11 @@ lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
         result = reply_top;
     }
 
+#ifdef LY_ENABLED_CACHE
+    /* hash the whole parsed tree at once */
+    lyd_hash_siblings(result);
+#endif
+
     if ((options & LYD_OPT_RPCREPLY) && (rpc_act->schema->nodetype != LYS_RPC)) {
         /* action reply */
         act_notif = reply_parent;
@@ -25,6 +25,7 @@
 #include <sys/types.h>
 
 #include "common.h"
+#include "hash_table.h"
 #include "extensions.h"
 #include "user_types.h"
 #include "plugin_config.h"
@@ -38,6 +39,30 @@ static uint16_t ext_plugins_count = 0; /* size of the ext_plugins array */
 static struct lytype_plugin_list *type_plugins = NULL;
 static uint16_t type_plugins_count = 0;
 
+/* hash tables of the plugins (struct plugin_rec) for their fast lookup */
+static struct hash_table *ext_plugins_ht = NULL;
+static struct hash_table *type_plugins_ht = NULL;
+
+#ifdef LY_ENABLED_CACHE
+/* cached type plugins of typedefs (struct plugin_rec), emptied whenever the type plugins change */
+static struct hash_table *type_tpdf_ht = NULL;
+static pthread_rwlock_t type_tpdf_lock = PTHREAD_RWLOCK_INITIALIZER;
+#endif
+
+/* plugin index of typedefs without a type plugin */
+#define PLUGIN_IDX_NONE UINT16_MAX
+
+/**
+ * @brief Record of a plugin hash table.
+ */
+struct plugin_rec {
+    const char *module;
+    const char *revision;
+    const char *name;
+    uint16_t idx;                   /**< index of the plugin in its array, #PLUGIN_IDX_NONE for no plugin */
+    const struct lys_tpdf *tpdf;    /**< typedef of the record, only in the typedef cache */
+};
+
 static struct ly_set dlhandlers = {0, 0, {NULL}};
 static pthread_mutex_t plugins_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -49,6 +74,124 @@ static uint16_t loaded_plugins_count = 0;
  */
 static uint32_t plugin_refs;
 
+/* ht callback, type plugins match only the same revision (or no revision) */
+static int
+lytype_plugin_rec_equal(void *val1_p, void *val2_p, int mod, void *UNUSED(cb_data))
+{
+    struct plugin_rec *rec1 = (struct plugin_rec *)val1_p, *rec2 = (struct plugin_rec *)val2_p;
+
+    if (mod) {
+        /* the exact record */
+        return rec1->idx == rec2->idx;
+    }
+
+    return ly_strequal(rec1->module, rec2->module, 0) && ly_strequal(rec1->name, rec2->name, 0)
+            && ((!rec1->revision && !rec2->revision) || (rec1->revision && ly_strequal(rec1->revision, rec2->revision, 0)));
+}
+
+/* ht callback, extension plugins without a revision match any revision */
+static int
+lyext_plugin_rec_equal(void *val1_p, void *val2_p, int mod, void *UNUSED(cb_data))
+{
+    struct plugin_rec *rec1 = (struct plugin_rec *)val1_p, *rec2 = (struct plugin_rec *)val2_p;
+
+    if (mod) {
+        /* the exact record */
+        return rec1->idx == rec2->idx;
+    }
+
+    return !strcmp(rec1->module, rec2->module) && !strcmp(rec1->name, rec2->name)
+            && (!rec2->revision || (rec1->revision && !strcmp(rec1->revision, rec2->revision)));
+}
+
+#ifdef LY_ENABLED_CACHE
+
+/* ht callback, typedef cache records match by the typedef */
+static int
+lytype_tpdf_rec_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct plugin_rec *rec1 = (struct plugin_rec *)val1_p, *rec2 = (struct plugin_rec *)val2_p;
+
+    return rec1->tpdf == rec2->tpdf;
+}
+
+static uint32_t
+lytype_tpdf_hash(const struct lys_tpdf *tpdf)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&tpdf, sizeof tpdf), NULL, 0);
+}
+
+/**
+ * @brief Forget all the cached type plugins of typedefs.
+ */
+static void
+lytype_tpdf_cache_clean(void)
+{
+    pthread_rwlock_wrlock(&type_tpdf_lock);
+    lyht_free(type_tpdf_ht);
+    type_tpdf_ht = NULL;
+    pthread_rwlock_unlock(&type_tpdf_lock);
+}
+
+#endif
+
+static uint32_t
+plugin_rec_hash(const char *module, const char *name)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, module, strlen(module));
+    hash = dict_hash_multi(hash, name, strlen(name));
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Add a plugin into a plugin hash table.
+ *
+ * @param[in,out] ht Hash table to add to, created if NULL.
+ * @param[in] val_equal Hash table callback.
+ * @param[in] module Plugin module.
+ * @param[in] revision Plugin module revision.
+ * @param[in] name Plugin extension/type name.
+ * @param[in] idx Index of the plugin in its array.
+ * @return 0 on success, -1 on error.
+ */
+static int
+plugins_ht_add(struct hash_table **ht, values_equal_cb val_equal, const char *module, const char *revision,
+               const char *name, uint16_t idx)
+{
+    struct plugin_rec rec;
+
+    if (!*ht) {
+        *ht = lyht_new(8, sizeof rec, val_equal, NULL, 1);
+        LY_CHECK_ERR_RETURN(!*ht, LOGMEM(NULL), -1);
+    }
+
+    rec.module = module;
+    rec.revision = revision;
+    rec.name = name;
+    rec.idx = idx;
+    if (lyht_insert(*ht, &rec, plugin_rec_hash(module, name), NULL) == -1) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+plugins_ht_clean(void)
+{
+    lyht_free(ext_plugins_ht);
+    ext_plugins_ht = NULL;
+    lyht_free(type_plugins_ht);
+    type_plugins_ht = NULL;
+
+#ifdef LY_ENABLED_CACHE
+    /* invalidate all the cached type plugins */
+    lytype_tpdf_cache_clean();
+#endif
+}
+
 API const char * const *
 ly_get_loaded_plugins(void)
 {
@@ -81,6 +224,8 @@ ly_clean_plugins(void)
         type_plugins_count = 0;
     }
 
+    plugins_ht_clean();
+
     for (u = 0; u < loaded_plugins_count; ++u) {
         free(loaded_plugins[u]);
     }
@@ -116,6 +261,8 @@ ly_clean_plugins(void)
     type_plugins = NULL;
     type_plugins_count = 0;
 
+    plugins_ht_clean();
+
     for (u = 0; u < loaded_plugins_count; ++u) {
         free(loaded_plugins[u]);
     }
@@ -198,9 +345,18 @@ ly_register_types(struct lytype_plugin_list *plugin, const char *log_name)
     type_plugins = p;
     for (; u; u--) {
         memcpy(&type_plugins[type_plugins_count], &plugin[u - 1], sizeof *plugin);
+        if (plugins_ht_add(&type_plugins_ht, lytype_plugin_rec_equal, plugin[u - 1].module, plugin[u - 1].revision,
+                           plugin[u - 1].name, type_plugins_count)) {
+            return -1;
+        }
         type_plugins_count++;
     }
 
+#ifdef LY_ENABLED_CACHE
+    /* the plugins may match cached typedefs without one, invalidate all the cached type plugins */
+    lytype_tpdf_cache_clean();
+#endif
+
     return 0;
 }
 
@@ -287,6 +443,10 @@ ly_register_exts(struct lyext_plugin_list *plugin, const char *log_name)
     ext_plugins = p;
     for (; u; u--) {
         memcpy(&ext_plugins[ext_plugins_count], &plugin[u - 1], sizeof *plugin);
+        if (plugins_ht_add(&ext_plugins_ht, lyext_plugin_rec_equal, plugin[u - 1].module, plugin[u - 1].revision,
+                           plugin[u - 1].name, ext_plugins_count)) {
+            return -1;
+        }
         ext_plugins_count++;
     }
 
@@ -392,13 +552,23 @@ ly_load_plugins(void)
     const char *pluginsdir;
 
 #ifdef STATIC
+    uint16_t u;
+
     /* lock the extension plugins list */
     pthread_mutex_lock(&plugins_lock);
 
     ext_plugins = static_load_lyext_plugins(&ext_plugins_count);
     type_plugins = static_load_lytype_plugins(&type_plugins_count);
+    plugins_ht_clean();
+    for (u = 0; u < ext_plugins_count; u++) {
+        plugins_ht_add(&ext_plugins_ht, lyext_plugin_rec_equal, ext_plugins[u].module, ext_plugins[u].revision,
+                       ext_plugins[u].name, u);
+    }
+    for (u = 0; u < type_plugins_count; u++) {
+        plugins_ht_add(&type_plugins_ht, lytype_plugin_rec_equal, type_plugins[u].module, type_plugins[u].revision,
+                       type_plugins[u].name, u);
+    }
 
-    int u;
     for (u = 0; u < static_loaded_plugins_count; u++) {
         ly_add_loaded_plugin(strdup(static_loaded_plugins[u]));
     }
@@ -451,22 +621,24 @@ ly_load_plugins(void)
 struct lyext_plugin *
 ext_get_plugin(const char *name, const char *module, const char *revision)
 {
-    uint16_t u;
+    struct plugin_rec rec, *match;
 
     assert(name);
     assert(module);
 
-    for (u = 0; u < ext_plugins_count; u++) {
-        if (!strcmp(name, ext_plugins[u].name) &&
-                !strcmp(module, ext_plugins[u].module) &&
-                (!ext_plugins[u].revision || !strcmp(revision, ext_plugins[u].revision))) {
-            /* we have the match */
-            return ext_plugins[u].plugin;
-        }
+    if (!ext_plugins_ht) {
+        return NULL;
+    }
+
+    rec.module = module;
+    rec.revision = revision;
+    rec.name = name;
+    if (lyht_find(ext_plugins_ht, &rec, plugin_rec_hash(module, name), (void **)&match)) {
+        /* plugin not found */
+        return NULL;
     }
 
-    /* plugin not found */
-    return NULL;
+    return ext_plugins[match->idx].plugin;
 }
 
 API int
@@ -588,32 +760,123 @@ lys_snode2stmt(LYS_NODE nodetype)
 static struct lytype_plugin_list *
 lytype_find(const char *module, const char *revision, const char *type_name)
 {
-    uint16_t u;
+    struct plugin_rec rec, *match;
+
+    if (!type_plugins_ht) {
+        return NULL;
+    }
+
+    rec.module = module;
+    rec.revision = revision;
+    rec.name = type_name;
+    if (lyht_find(type_plugins_ht, &rec, plugin_rec_hash(module, type_name), (void **)&match)) {
+        return NULL;
+    }
+
+    return &type_plugins[match->idx];
+}
 
-    for (u = 0; u < type_plugins_count; ++u) {
-        if (ly_strequal(module, type_plugins[u].module, 0) && ((!revision && !type_plugins[u].revision)
-                || (revision && ly_strequal(revision, type_plugins[u].revision, 0)))
-                && ly_strequal(type_name, type_plugins[u].name, 0)) {
-            return &(type_plugins[u]);
+/**
+ * @brief Get the plugin of a typedef. Can be called from several threads at once.
+ *
+ * @param[in] tpdf Typedef with a module.
+ * @return Type plugin, NULL if there is none.
+ */
+static struct lytype_plugin_list *
+lytype_tpdf_plugin(const struct lys_tpdf *tpdf)
+{
+    const struct lys_module *mod = tpdf->module;
+#ifdef LY_ENABLED_CACHE
+    struct lytype_plugin_list *plugin;
+    struct plugin_rec rec, *match;
+    uint32_t hash;
+    int r = 0, found = 0;
+
+    rec.module = mod->name;
+    rec.revision = mod->rev_size ? mod->rev[0].date : NULL;
+    rec.name = tpdf->name;
+    rec.tpdf = tpdf;
+    hash = lytype_tpdf_hash(tpdf);
+
+    pthread_rwlock_rdlock(&type_tpdf_lock);
+    while (type_tpdf_ht && type_tpdf_ht->invalid) {
+        /* searching would move the records in place of the removed ones, the table must be rehashed first */
+        pthread_rwlock_unlock(&type_tpdf_lock);
+        pthread_rwlock_wrlock(&type_tpdf_lock);
+        r = type_tpdf_ht ? lyht_rehash(type_tpdf_ht) : 0;
+        pthread_rwlock_unlock(&type_tpdf_lock);
+        if (r) {
+            /* do not use the cache */
+            return lytype_find(rec.module, rec.revision, rec.name);
+        }
+        pthread_rwlock_rdlock(&type_tpdf_lock);
+    }
+    if (type_tpdf_ht && !lyht_find(type_tpdf_ht, &rec, hash, (void **)&match)) {
+        /* the typedef memory may have been reused by another typedef */
+        if ((match->module == rec.module) && (match->revision == rec.revision) && (match->name == rec.name)) {
+            rec.idx = match->idx;
+            found = 1;
         }
     }
+    pthread_rwlock_unlock(&type_tpdf_lock);
 
-    return NULL;
+    if (found) {
+        return (rec.idx == PLUGIN_IDX_NONE) ? NULL : &type_plugins[rec.idx];
+    }
+
+    /* resolve the plugin only once */
+    plugin = lytype_find(rec.module, rec.revision, rec.name);
+    rec.idx = plugin ? plugin - type_plugins : PLUGIN_IDX_NONE;
+
+    pthread_rwlock_wrlock(&type_tpdf_lock);
+    if (!type_tpdf_ht) {
+        type_tpdf_ht = lyht_new(64, sizeof rec, lytype_tpdf_rec_equal, NULL, 1);
+    }
+    if (type_tpdf_ht && (lyht_insert(type_tpdf_ht, &rec, hash, (void **)&match) == 1)) {
+        /* stale or added by another thread in the meantime */
+        *match = rec;
+    }
+    pthread_rwlock_unlock(&type_tpdf_lock);
+
+    return plugin;
+#else
+    return lytype_find(mod->name, mod->rev_size ? mod->rev[0].date : NULL, tpdf->name);
+#endif
+}
+
+void
+lytype_tpdf_forget(const struct lys_tpdf *tpdf)
+{
+#ifdef LY_ENABLED_CACHE
+    struct plugin_rec rec;
+
+    pthread_rwlock_wrlock(&type_tpdf_lock);
+    if (type_tpdf_ht) {
+        rec.tpdf = tpdf;
+        /* the typedef may not be cached, it is fine */
+        lyht_remove(type_tpdf_ht, &rec, lytype_tpdf_hash(tpdf));
+    }
+    pthread_rwlock_unlock(&type_tpdf_lock);
+#else
+    (void)tpdf;
+#endif
 }
 
 int
-lytype_store(const struct lys_module *mod, const char *type_name, const char **value_str, lyd_val *value)
+lytype_store(struct lys_tpdf *tpdf, const char **value_str, lyd_val *value)
 {
     struct lytype_plugin_list *p;
+    const struct lys_module *mod;
     char *err_msg = NULL;
 
-    assert(mod && type_name && value_str && value);
+    assert(tpdf && tpdf->module && value_str && value);
 
-    p = lytype_find(mod->name, mod->rev_size ? mod->rev[0].date : NULL, type_name);
-    if (p) {
-        if (p->store_clb(mod->ctx, type_name, value_str, value, &err_msg)) {
+    mod = tpdf->module;
+    p = lytype_tpdf_plugin(tpdf);
+    if (p && p->store_clb) {
+        if (p->store_clb(mod->ctx, tpdf->name, value_str, value, &err_msg)) {
             if (!err_msg) {
-                if (asprintf(&err_msg, "Failed to store value \"%s\" of user type \"%s\".", *value_str, type_name) == -1) {
+                if (asprintf(&err_msg, "Failed to store value \"%s\" of user type \"%s\".", *value_str, tpdf->name) == -1) {
                     LOGMEM(mod->ctx);
                     return -1;
                 }
@@ -630,6 +893,61 @@ lytype_store(const struct lys_module *mod, const char *type_name, const char **v
     return 1;
 }
 
+int
+lytype_validate(struct lys_tpdf *tpdf, const char *value_str)
+{
+    struct lytype_plugin_list *p;
+
+    assert(tpdf && tpdf->module && value_str);
+
+    p = lytype_tpdf_plugin(tpdf);
+    if (p && p->validate_clb) {
+        return p->validate_clb(tpdf->name, value_str);
+    }
+
+    return -1;
+}
+
+int
+lytype_dup(struct lys_tpdf *orig_tpdf, lyd_val orig, struct lys_tpdf *tpdf, const char **value_str, lyd_val *value)
+{
+    struct lytype_plugin_list *p;
+    const struct lys_module *mod;
+    char *err_msg = NULL;
+
+    assert(orig_tpdf && orig_tpdf->module && tpdf && tpdf->module && value_str && value);
+
+    mod = tpdf->module;
+    p = lytype_tpdf_plugin(tpdf);
+    if (!p || !p->dup_clb || (lytype_tpdf_plugin(orig_tpdf) != p)) {
+        /* store the value again */
+        return lytype_store(tpdf, value_str, value);
+    }
+
+    if (p->dup_clb(mod->ctx, tpdf->name, *value_str, orig, value, &err_msg)) {
+        if (!err_msg) {
+            if (asprintf(&err_msg, "Failed to duplicate value \"%s\" of user type \"%s\".", *value_str, tpdf->name) == -1) {
+                LOGMEM(mod->ctx);
+                return -1;
+            }
+        }
+        LOGERR(mod->ctx, LY_EPLUGIN, err_msg);
+        free(err_msg);
+        return -1;
+    }
+
+    return 0;
+}
+
+API int
+lytype_dup_string(struct ly_ctx *UNUSED(ctx), const char *UNUSED(type_name), const char *value_str, lyd_val UNUSED(orig),
+                  lyd_val *dup, char **UNUSED(err_msg))
+{
+    /* the canonical value is already stored in value_str, just share it */
+    dup->string = value_str;
+    return 0;
+}
+
 void
 lytype_free(const struct lys_type *type, lyd_val value, const char *value_str)
 {
@@ -670,7 +988,7 @@ lytype_free(const struct lys_type *type, lyd_val value, const char *value_str)
         return;
     }
 
-    p = lytype_find(mod->name, mod->rev_size ? mod->rev[0].date : NULL, type->der->name);
+    p = lytype_tpdf_plugin(type->der);
     if (!p) {
         LOGINT(mod->ctx);
         return;
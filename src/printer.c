@@ -22,6 +22,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <assert.h>
 
 #include "common.h"
 #include "tree_schema.h"
@@ -77,11 +78,37 @@ nscmp(const struct lyd_node *node1, const struct lyd_node *node2)
     }
 }
 
+/* make space for count more bytes and the terminating zero, the buffer grows exponentially */
+static int
+ly_mem_reserve(struct lyout *out, size_t count)
+{
+    size_t size;
+
+    if (out->method.mem.len + count + 1 <= out->method.mem.size) {
+        return 0;
+    }
+
+    size = out->method.mem.size ? out->method.mem.size : LY_WRITE_FLUSH_SIZE;
+    while (size < out->method.mem.len + count + 1) {
+        size *= 2;
+    }
+    out->method.mem.buf = ly_realloc(out->method.mem.buf, size);
+    if (!out->method.mem.buf) {
+        out->method.mem.len = 0;
+        out->method.mem.size = 0;
+        LOGMEM(NULL);
+        return -1;
+    }
+    out->method.mem.size = size;
+
+    return 0;
+}
+
 int
 ly_print(struct lyout *out, const char *format, ...)
 {
     int count = 0;
-    char *msg = NULL, *aux;
+    char *msg = NULL;
     va_list ap;
 
     va_start(ap, format);
@@ -94,24 +121,25 @@ ly_print(struct lyout *out, const char *format, ...)
         count = vfprintf(out->method.f, format, ap);
         break;
     case LYOUT_MEMORY:
-        count = vasprintf(&msg, format, ap);
-        if (out->method.mem.len + count + 1 > out->method.mem.size) {
-            aux = ly_realloc(out->method.mem.buf, out->method.mem.len + count + 1);
-            if (!aux) {
-                out->method.mem.buf = NULL;
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM(NULL);
+        if (ly_mem_reserve(out, 0)) {
+            va_end(ap);
+            return -1;
+        }
+        /* print directly into the buffer, enlarge it and print again if the output does not fit */
+        count = vsnprintf(&out->method.mem.buf[out->method.mem.len], out->method.mem.size - out->method.mem.len,
+                          format, ap);
+        if ((count > 0) && ((size_t)count >= out->method.mem.size - out->method.mem.len)) {
+            if (ly_mem_reserve(out, count)) {
                 va_end(ap);
                 return -1;
             }
-            out->method.mem.buf = aux;
-            out->method.mem.size = out->method.mem.len + count + 1;
+            va_end(ap);
+            va_start(ap, format);
+            vsnprintf(&out->method.mem.buf[out->method.mem.len], count + 1, format, ap);
+        }
+        if (count > 0) {
+            out->method.mem.len += count;
         }
-        memcpy(&out->method.mem.buf[out->method.mem.len], msg, count);
-        out->method.mem.len += count;
-        out->method.mem.buf[out->method.mem.len] = '\0';
-        free(msg);
         break;
     case LYOUT_CALLBACK:
         count = vasprintf(&msg, format, ap);
@@ -148,6 +176,29 @@ ly_print_flush(struct lyout *out)
     }
 }
 
+static int
+ly_write_out(struct lyout *out, const char *buf, size_t count)
+{
+    switch (out->type) {
+    case LYOUT_MEMORY:
+        if (ly_mem_reserve(out, count)) {
+            return -1;
+        }
+        memcpy(&out->method.mem.buf[out->method.mem.len], buf, count);
+        out->method.mem.len += count;
+        out->method.mem.buf[out->method.mem.len] = '\0';
+        return count;
+    case LYOUT_FD:
+        return write(out->method.fd, buf, count);
+    case LYOUT_STREAM:
+        return fwrite(buf, sizeof *buf, count, out->method.f);
+    case LYOUT_CALLBACK:
+        return out->method.clb.f(out->method.clb.arg, buf, count);
+    }
+
+    return 0;
+}
+
 int
 ly_write(struct lyout *out, const char *buf, size_t count)
 {
@@ -169,31 +220,7 @@ ly_write(struct lyout *out, const char *buf, size_t count)
         return count;
     }
 
-    switch (out->type) {
-    case LYOUT_MEMORY:
-        if (out->method.mem.len + count + 1 > out->method.mem.size) {
-            out->method.mem.buf = ly_realloc(out->method.mem.buf, out->method.mem.len + count + 1);
-            if (!out->method.mem.buf) {
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM(NULL);
-                return -1;
-            }
-            out->method.mem.size = out->method.mem.len + count + 1;
-        }
-        memcpy(&out->method.mem.buf[out->method.mem.len], buf, count);
-        out->method.mem.len += count;
-        out->method.mem.buf[out->method.mem.len] = '\0';
-        return count;
-    case LYOUT_FD:
-        return write(out->method.fd, buf, count);
-    case LYOUT_STREAM:
-        return fwrite(buf, sizeof *buf, count, out->method.f);
-    case LYOUT_CALLBACK:
-        return out->method.clb.f(out->method.clb.arg, buf, count);
-    }
-
-    return 0;
+    return ly_write_out(out, buf, count);
 }
 
 int
@@ -201,15 +228,8 @@ ly_write_skip(struct lyout *out, size_t count, size_t *position)
 {
     switch (out->type) {
     case LYOUT_MEMORY:
-        if (out->method.mem.len + count > out->method.mem.size) {
-            out->method.mem.buf = ly_realloc(out->method.mem.buf, out->method.mem.len + count);
-            if (!out->method.mem.buf) {
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM(NULL);
-                return -1;
-            }
-            out->method.mem.size = out->method.mem.len + count;
+        if (ly_mem_reserve(out, count)) {
+            return -1;
         }
 
         /* save the current position */
@@ -233,14 +253,24 @@ ly_write_skip(struct lyout *out, size_t count, size_t *position)
             out->buf_size = out->buf_len + count;
         }
 
+        /* remember the hole */
+        if (out->hole_count == out->hole_size) {
+            out->holes = ly_realloc(out->holes, (out->hole_size + 8) * sizeof *out->holes);
+            if (!out->holes) {
+                out->hole_count = 0;
+                out->hole_size = 0;
+                LOGMEM(NULL);
+                return -1;
+            }
+            out->hole_size += 8;
+        }
+
         /* save the current position */
-        *position = out->buf_len;
+        *position = out->buf_written + out->buf_len;
+        out->holes[out->hole_count++] = *position;
 
         /* skip the memory */
         out->buf_len += count;
-
-        /* increase hole counter */
-        ++out->hole_count;
     }
 
     return count;
@@ -249,6 +279,9 @@ ly_write_skip(struct lyout *out, size_t count, size_t *position)
 int
 ly_write_skipped(struct lyout *out, size_t position, const char *buf, size_t count)
 {
+    size_t i, first;
+    int r;
+
     switch (out->type) {
     case LYOUT_MEMORY:
         /* write */
@@ -257,21 +290,35 @@ ly_write_skipped(struct lyout *out, size_t position, const char *buf, size_t cou
     case LYOUT_FD:
     case LYOUT_STREAM:
     case LYOUT_CALLBACK:
-        if (out->buf_len < position + count) {
+        for (i = 0; (i < out->hole_count) && (out->holes[i] != position); ++i);
+        if ((i == out->hole_count) || (out->buf_written + out->buf_len < position + count)) {
             LOGINT(NULL);
             return -1;
         }
 
         /* write into the hole */
-        memcpy(&out->buffered[position], buf, count);
-
-        /* decrease hole counter */
-        --out->hole_count;
+        memcpy(&out->buffered[position - out->buf_written], buf, count);
+
+        /* forget the hole, find the first one still unfilled */
+        out->holes[i] = out->holes[--out->hole_count];
+        first = out->buf_written + out->buf_len;
+        for (i = 0; i < out->hole_count; ++i) {
+            if (out->holes[i] < first) {
+                first = out->holes[i];
+            }
+        }
+        first -= out->buf_written;
 
-        if (!out->hole_count) {
-            /* all holes filled, we can write the buffer */
-            count = ly_write(out, out->buffered, out->buf_len);
-            out->buf_len = 0;
+        if (!out->hole_count || (first >= LY_WRITE_FLUSH_SIZE)) {
+            /* write everything before the first unfilled hole, LYB chunks are limited in size
+             * so the buffered data stay bounded however large the printed tree is */
+            r = ly_write_out(out, out->buffered, first);
+            if ((r < 0) || ((size_t)r < first)) {
+                return -1;
+            }
+            memmove(out->buffered, out->buffered + first, out->buf_len - first);
+            out->buf_len -= first;
+            out->buf_written += first;
         }
         break;
     }
@@ -279,6 +326,108 @@ ly_write_skipped(struct lyout *out, size_t position, const char *buf, size_t cou
     return count;
 }
 
+int
+ly_print_indent(struct lyout *out, int count)
+{
+    static const char spaces[] = "                                                                ";
+    int r, n = 0;
+
+    while (count > 0) {
+        r = ly_write(out, spaces, count < (int)(sizeof spaces - 1) ? count : (int)(sizeof spaces - 1));
+        if (r < 0) {
+            return r;
+        }
+        count -= r;
+        n += r;
+    }
+
+    return n;
+}
+
+static int
+lyout_frag_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyout_frag *val1 = *(struct lyout_frag **)val1_p;
+    struct lyout_frag *val2 = *(struct lyout_frag **)val2_p;
+
+    return (val1->schema == val2->schema) && (val1->format == val2->format);
+}
+
+const struct lyout_frag *
+ly_print_frag(struct lyout *out, const struct lys_node *schema, LYD_FORMAT format)
+{
+    struct lyout_frag key, *frag, **match;
+    const struct lys_module *mod;
+    char *buf;
+    uint32_t hash;
+    size_t name_len;
+
+    assert((format == LYD_XML) || (format == LYD_JSON));
+
+    hash = dict_hash_multi(0, (const char *)&schema, sizeof schema);
+    hash = dict_hash_multi(hash, NULL, 0);
+
+    key.schema = schema;
+    key.format = format;
+    frag = &key;
+    if (!out->frags) {
+        out->frags = lyht_new(32, sizeof frag, lyout_frag_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RETURN(!out->frags, LOGMEM(schema->module->ctx), NULL);
+    } else if (!lyht_find(out->frags, &frag, hash, (void **)&match)) {
+        return *match;
+    }
+
+    /* the fragments are stored right after the structure, its address does not change when the table is resized */
+    mod = lys_node_module(schema);
+    name_len = strlen(schema->name);
+    frag = malloc(sizeof *frag + 3 * name_len + strlen(mod->name) + strlen(mod->ns) + 20);
+    LY_CHECK_ERR_RETURN(!frag, LOGMEM(schema->module->ctx), NULL);
+    frag->schema = schema;
+    frag->format = format;
+    buf = (char *)(frag + 1);
+
+    if (format == LYD_JSON) {
+        frag->qname_len = sprintf(buf, "\"%s:%s\":", mod->name, schema->name);
+        frag->name_len = sprintf(buf + frag->qname_len + 1, "\"%s\":", schema->name);
+        frag->close_len = sprintf(buf + frag->qname_len + frag->name_len + 2, "%s", "");
+    } else {
+        frag->qname_len = sprintf(buf, "<%s xmlns=\"%s\"", schema->name, mod->ns);
+        frag->name_len = sprintf(buf + frag->qname_len + 1, "<%s", schema->name);
+        frag->close_len = sprintf(buf + frag->qname_len + frag->name_len + 2, "</%s>", schema->name);
+    }
+    frag->qname = buf;
+    frag->name = frag->qname + frag->qname_len + 1;
+    frag->close = frag->name + frag->name_len + 1;
+
+    if (lyht_insert(out->frags, &frag, hash, NULL)) {
+        free(frag);
+        LOGINT(schema->module->ctx);
+        return NULL;
+    }
+
+    return frag;
+}
+
+void
+ly_print_frags_free(struct lyout *out)
+{
+    struct ht_rec *rec;
+    uint32_t i;
+
+    if (!out->frags) {
+        return;
+    }
+
+    for (i = 0; i < out->frags->size; ++i) {
+        rec = lyht_get_rec(out->frags->recs, out->frags->rec_size, i);
+        if (rec->hits > 0) {
+            free(*(struct lyout_frag **)rec->val);
+        }
+    }
+    lyht_free(out->frags);
+    out->frags = NULL;
+}
+
 static int
 write_iff(struct lyout *out, const struct lys_module *module, struct lys_iffeature *expr, int prefix_kind,
           int *index_e, int *index_f)
@@ -704,17 +853,24 @@ lys_print_target(struct lyout *out, const struct lys_module *module, const char
 static int
 lyd_print_(struct lyout *out, const struct lyd_node *root, LYD_FORMAT format, int options)
 {
+    int ret;
+
     switch (format) {
     case LYD_XML:
-        return xml_print_data(out, root, options);
+        ret = xml_print_data(out, root, options);
+        break;
     case LYD_JSON:
-        return json_print_data(out, root, options);
+        ret = json_print_data(out, root, options);
+        break;
     case LYD_LYB:
         return lyb_print_data(out, root, options);
     default:
         LOGERR(root->schema->module->ctx, LY_EINVAL, "Unknown output format.");
         return EXIT_FAILURE;
     }
+
+    ly_print_frags_free(out);
+    return ret;
 }
 
 API int
@@ -736,6 +892,7 @@ lyd_print_file(FILE *f, const struct lyd_node *root, LYD_FORMAT format, int opti
     r = lyd_print_(&out, root, format, options);
 
     free(out.buffered);
+    free(out.holes);
     return r;
 }
 
@@ -781,6 +938,7 @@ lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, int options
     r = lyd_print_(&out, root, format, options);
 
     free(out.buffered);
+    free(out.holes);
     return r;
 }
 
@@ -803,6 +961,7 @@ lyd_print_mem(char **strp, const struct lyd_node *root, LYD_FORMAT format, int o
 
     *strp = out.method.mem.buf;
     free(out.buffered);
+    free(out.holes);
     return r;
 }
 
@@ -827,6 +986,30 @@ lyd_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), voi
     r = lyd_print_(&out, root, format, options);
 
     free(out.buffered);
+    free(out.holes);
+    return r;
+}
+
+API int
+lyd_lyb_print_diff(char **strp, const struct lyd_difflist *diff)
+{
+    struct lyout out;
+    int r;
+
+    if (!strp || !diff) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    memset(&out, 0, sizeof out);
+
+    out.type = LYOUT_MEMORY;
+
+    r = lyb_print_diff(&out, diff);
+
+    *strp = out.method.mem.buf;
+    free(out.buffered);
+    free(out.holes);
     return r;
 }
 
@@ -46,11 +46,39 @@ struct lyout {
     char *buffered;
     size_t buf_len;
     size_t buf_size;
+    /* number of buffered bytes already written, positions of holes include them */
+    size_t buf_written;
 
-    /* hole counter */
+    /* positions of the holes not filled yet */
+    size_t *holes;
     size_t hole_count;
+    size_t hole_size;
+
+    /* schema node fragments of the data printers (struct lyout_frag), created on first use */
+    struct hash_table *frags;
 };
 
+/**
+ * @brief Output fragments of a schema node precomputed for the XML and JSON data printers.
+ *
+ * JSON: qname is the member name with the module name ("mod:name":), name without it ("name":), close is empty.
+ * XML: qname is the start tag with the default namespace (<name xmlns="ns"), name without it (<name),
+ * close is the end tag (</name>). The strings are allocated together with the structure.
+ */
+struct lyout_frag {
+    const struct lys_node *schema;
+    LYD_FORMAT format;
+    const char *qname;
+    const char *name;
+    const char *close;
+    size_t qname_len;
+    size_t name_len;
+    size_t close_len;
+};
+
+/* buffered data before the first unfilled hole are written once there are at least this many */
+#define LY_WRITE_FLUSH_SIZE 4096
+
 struct ext_substmt_info_s {
     const char *name;
     const char *arg;
@@ -76,6 +104,27 @@ int ly_write(struct lyout *out, const char *buf, size_t count);
 int ly_write_skip(struct lyout *out, size_t count, size_t *position);
 int ly_write_skipped(struct lyout *out, size_t position, const char *buf, size_t count);
 
+/**
+ * @brief Write count spaces.
+ */
+int ly_print_indent(struct lyout *out, int count);
+
+/**
+ * @brief Get the output fragments of a schema node, they are created on the first use and stay valid until
+ * ly_print_frags_free() is called.
+ *
+ * @param[in] out Output the fragments are cached in.
+ * @param[in] schema Schema node.
+ * @param[in] format Data format, #LYD_XML or #LYD_JSON.
+ * @return Fragments, NULL on memory allocation error.
+ */
+const struct lyout_frag *ly_print_frag(struct lyout *out, const struct lys_node *schema, LYD_FORMAT format);
+
+/**
+ * @brief Free all the cached fragments of an output.
+ */
+void ly_print_frags_free(struct lyout *out);
+
 /* prefix_kind: 0 - print import prefixes for foreign features, 1 - print module names, 2 - print prefixes (tree printer), 3 - print module names including revisions (JSONS printer) */
 int ly_print_iffeature(struct lyout *out, const struct lys_module *module, struct lys_iffeature *expr, int prefix_kind);
 
@@ -89,6 +138,7 @@ int json_print_data(struct lyout *out, const struct lyd_node *root, int options)
 int xml_print_data(struct lyout *out, const struct lyd_node *root, int options);
 int xml_print_node(struct lyout *out, int level, const struct lyd_node *node, int toplevel, int options);
 int lyb_print_data(struct lyout *out, const struct lyd_node *root, int options);
+int lyb_print_diff(struct lyout *out, const struct lyd_difflist *diff);
 
 int lys_print_target(struct lyout *out, const struct lys_module *module, const char *target_schema_path,
                      void (*clb_print_typedef)(struct lyout*, const struct lys_tpdf*, int*),
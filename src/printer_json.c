@@ -33,37 +33,70 @@ static int json_print_nodes(struct lyout *out, int level, const struct lyd_node
 int
 json_print_string(struct lyout *out, const char *text)
 {
-    unsigned int i, n;
+    size_t i, len, run;
+    unsigned int n;
 
     if (!text) {
         return 0;
     }
 
     ly_write(out, "\"", 1);
-    for (i = n = 0; text[i]; i++) {
-        const unsigned char ascii = text[i];
-        if (ascii < 0x20) {
-            /* control character */
-            n += ly_print(out, "\\u%.4X", ascii);
-        } else {
-            switch (ascii) {
-            case '"':
-                n += ly_print(out, "\\\"");
-                break;
-            case '\\':
-                n += ly_print(out, "\\\\");
+    len = strlen(text);
+    for (i = n = 0; i < len; i++) {
+        /* write the characters not needing an escape at once */
+        run = ly_strlen_noesc(text + i, len - i, 1);
+        if (run) {
+            ly_write(out, text + i, run);
+            n += run;
+            i += run;
+            if (i == len) {
                 break;
-            default:
-                ly_write(out, &text[i], 1);
-                n++;
             }
         }
+
+        switch (text[i]) {
+        case '"':
+            n += ly_write(out, "\\\"", 2);
+            break;
+        case '\\':
+            n += ly_write(out, "\\\\", 2);
+            break;
+        default:
+            /* control character */
+            n += ly_print(out, "\\u%.4X", (unsigned char)text[i]);
+            break;
+        }
     }
     ly_write(out, "\"", 1);
 
     return n + 2;
 }
 
+/* print the indentation and the member name of a node, with the module name if the parent is from another module */
+static int
+json_print_member(struct lyout *out, int level, const struct lyd_node *node, int toplevel, const char **schema)
+{
+    const struct lyout_frag *frag;
+
+    frag = ly_print_frag(out, node->schema, LYD_JSON);
+    if (!frag) {
+        return EXIT_FAILURE;
+    }
+
+    ly_print_indent(out, LEVEL);
+    if (toplevel || !node->parent || nscmp(node, node->parent)) {
+        /* print "namespace" */
+        if (schema) {
+            *schema = lys_node_module(node->schema)->name;
+        }
+        ly_write(out, frag->qname, frag->qname_len);
+    } else {
+        ly_write(out, frag->name, frag->name_len);
+    }
+
+    return EXIT_SUCCESS;
+}
+
 static int
 json_print_attrs(struct lyout *out, int level, const struct lyd_node *node, const struct lys_module *wdmod)
 {
@@ -159,12 +192,11 @@ json_print_leaf(struct lyout *out, int level, const struct lyd_node *node, int o
     }
 
     if (!onlyvalue) {
-        if (toplevel || !node->parent || nscmp(node, node->parent)) {
-            /* print "namespace" */
-            schema = lys_node_module(node->schema)->name;
-            ly_print(out, "%*s\"%s:%s\":%s", LEVEL, INDENT, schema, node->schema->name, (level ? " " : ""));
-        } else {
-            ly_print(out, "%*s\"%s\":%s", LEVEL, INDENT, node->schema->name, (level ? " " : ""));
+        if (json_print_member(out, level, node, toplevel, &schema)) {
+            return EXIT_FAILURE;
+        }
+        if (level) {
+            ly_write(out, " ", 1);
         }
     }
 
@@ -190,7 +222,11 @@ contentprint:
     case LY_TYPE_UINT16:
     case LY_TYPE_UINT32:
     case LY_TYPE_BOOL:
-        ly_print(out, "%s", leaf->value_str[0] ? leaf->value_str : "null");
+        if (leaf->value_str[0]) {
+            ly_write(out, leaf->value_str, strlen(leaf->value_str));
+        } else {
+            ly_write(out, "null", 4);
+        }
         break;
 
     case LY_TYPE_IDENT:
@@ -255,16 +291,15 @@ contentprint:
 static int
 json_print_container(struct lyout *out, int level, const struct lyd_node *node, int toplevel, int options)
 {
-    const char *schema;
-
     LY_PRINT_SET;
 
-    if (toplevel || !node->parent || nscmp(node, node->parent)) {
-        /* print "namespace" */
-        schema = lys_node_module(node->schema)->name;
-        ly_print(out, "%*s\"%s:%s\":%s{%s", LEVEL, INDENT, schema, node->schema->name, (level ? " " : ""), (level ? "\n" : ""));
+    if (json_print_member(out, level, node, toplevel, NULL)) {
+        return EXIT_FAILURE;
+    }
+    if (level) {
+        ly_write(out, " {\n", 3);
     } else {
-        ly_print(out, "%*s\"%s\":%s{%s", LEVEL, INDENT, node->schema->name, (level ? " " : ""), (level ? "\n" : ""));
+        ly_write(out, "{", 1);
     }
     if (level) {
         level++;
@@ -285,7 +320,8 @@ json_print_container(struct lyout *out, int level, const struct lyd_node *node,
     if (level) {
         level--;
     }
-    ly_print(out, "%*s}", LEVEL, INDENT);
+    ly_print_indent(out, LEVEL);
+    ly_write(out, "}", 1);
 
     LY_PRINT_RET(node->schema->module->ctx);
 }
@@ -304,12 +340,8 @@ json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node,
         flag_empty = 1;
     }
 
-    if (toplevel || !node->parent || nscmp(node, node->parent)) {
-        /* print "namespace" */
-        schema = lys_node_module(node->schema)->name;
-        ly_print(out, "%*s\"%s:%s\":", LEVEL, INDENT, schema, node->schema->name);
-    } else {
-        ly_print(out, "%*s\"%s\":", LEVEL, INDENT, node->schema->name);
+    if (json_print_member(out, level, node, toplevel, &schema)) {
+        return EXIT_FAILURE;
     }
 
     if (flag_empty) {
@@ -328,7 +360,8 @@ json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node,
             if (level) {
                 ++level;
             }
-            ly_print(out, "%*s{%s", LEVEL, INDENT, (level ? "\n" : ""));
+            ly_print_indent(out, LEVEL);
+            ly_write(out, "{\n", level ? 2 : 1);
             if (level) {
                 ++level;
             }
@@ -349,13 +382,14 @@ json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node,
             if (level) {
                 --level;
             }
-            ly_print(out, "%*s}", LEVEL, INDENT);
+            ly_print_indent(out, LEVEL);
+            ly_write(out, "}", 1);
             if (level) {
                 --level;
             }
         } else {
             /* leaf-list print */
-            ly_print(out, "%*s", LEVEL, INDENT);
+            ly_print_indent(out, LEVEL);
             if (json_print_leaf(out, level, list, 1, toplevel, options)) {
                 return EXIT_FAILURE;
             }
@@ -369,7 +403,7 @@ json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node,
         }
         for (list = list->next; list && list->schema != node->schema; list = list->next);
         if (list) {
-            ly_print(out, ",%s", (level ? "\n" : ""));
+            ly_write(out, ",\n", level ? 2 : 1);
         }
     }
 
@@ -428,12 +462,8 @@ json_print_anydataxml(struct lyout *out, int level, const struct lyd_node *node,
 
     LY_PRINT_SET;
 
-    if (toplevel || !node->parent || nscmp(node, node->parent)) {
-        /* print "namespace" */
-        schema = lys_node_module(node->schema)->name;
-        ly_print(out, "%*s\"%s:%s\":", LEVEL, INDENT, schema, node->schema->name);
-    } else {
-        ly_print(out, "%*s\"%s\":", LEVEL, INDENT, node->schema->name);
+    if (json_print_member(out, level, node, toplevel, &schema)) {
+        return EXIT_FAILURE;
     }
     if (level) {
         level++;
@@ -533,7 +563,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
             case LYS_CONTAINER:
                 if (comma_flag) {
                     /* print the previous comma */
-                    ly_print(out, ",%s", (level ? "\n" : ""));
+                    ly_write(out, ",\n", level ? 2 : 1);
                 }
                 if (json_print_container(out, level, node, toplevel, options)) {
                     return EXIT_FAILURE;
@@ -542,7 +572,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
             case LYS_LEAF:
                 if (comma_flag) {
                     /* print the previous comma */
-                    ly_print(out, ",%s", (level ? "\n" : ""));
+                    ly_write(out, ",\n", level ? 2 : 1);
                 }
                 if (json_print_leaf(out, level, node, 0, toplevel, options)) {
                     return EXIT_FAILURE;
@@ -563,7 +593,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
                 if (!iter->next || node == root) {
                     if (comma_flag) {
                         /* print the previous comma */
-                        ly_print(out, ",%s", (level ? "\n" : ""));
+                        ly_write(out, ",\n", level ? 2 : 1);
                     }
 
                     /* print the list/leaflist */
@@ -576,7 +606,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
             case LYS_ANYDATA:
                 if (comma_flag) {
                     /* print the previous comma */
-                    ly_print(out, ",%s", (level ? "\n" : ""));
+                    ly_write(out, ",\n", level ? 2 : 1);
                 }
                 if (json_print_anydataxml(out, level, node, toplevel, options)) {
                     return EXIT_FAILURE;
@@ -595,7 +625,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
         }
     }
     if (root && level) {
-        ly_print(out, "\n");
+        ly_write(out, "\n", 1);
     }
 
     LY_PRINT_RET(root ? root->schema->module->ctx : NULL);
@@ -45,6 +45,50 @@ lyb_ptr_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_da
     return 0;
 }
 
+/**
+ * @brief Sibling hash table of one schema parent, created once per print.
+ */
+struct lyb_sib_ht {
+    struct lys_node *first_sibling;
+    struct hash_table *ht;
+};
+
+static int
+lyb_sib_ht_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyb_sib_ht *val1 = (struct lyb_sib_ht *)val1_p;
+    struct lyb_sib_ht *val2 = (struct lyb_sib_ht *)val2_p;
+
+    return (val1->first_sibling == val2->first_sibling);
+}
+
+/**
+ * @brief String table record, strings are compared by their dictionary pointers.
+ */
+struct lyb_str_rec {
+    const char *str;
+    uint32_t count;     /* number of occurrences */
+    uint32_t idx;       /* index in the string table starting from 1, 0 if not in the table */
+};
+
+static int
+lyb_str_rec_equal_cb(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyb_str_rec *val1 = (struct lyb_str_rec *)val1_p;
+    struct lyb_str_rec *val2 = (struct lyb_str_rec *)val2_p;
+
+    return (val1->str == val2->str);
+}
+
+static uint32_t
+lyb_str_rec_hash(const char *str)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&str, sizeof str);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
 /* check that sibling collision hash i is safe to insert into ht
  * return: 0 - no whole hash sequence collision, 1 - whole hash sequence collision, -1 - fatal error
  */
@@ -437,6 +481,25 @@ lyb_write_number(uint64_t num, size_t bytes, struct lyout *out, struct lyb_state
     return lyb_write(out, (uint8_t *)&num, bytes, lybs);
 }
 
+static int
+lyb_write_varint(uint64_t num, struct lyout *out, struct lyb_state *lybs)
+{
+    uint8_t buf[LYB_VARINT_MAX_BYTES];
+    size_t len = 0;
+
+    /* 7 bits in each byte, the highest bit set if more bytes follow */
+    do {
+        buf[len] = num & 0x7f;
+        num >>= 7;
+        if (num) {
+            buf[len] |= 0x80;
+        }
+        ++len;
+    } while (num);
+
+    return lyb_write(out, buf, len, lybs);
+}
+
 static int
 lyb_write_enum(uint32_t enum_idx, uint32_t count, struct lyout *out, struct lyb_state *lybs)
 {
@@ -551,25 +614,17 @@ add_model(const struct lys_module ***models, size_t *mod_count, const struct lys
 }
 
 static int
-lyb_print_data_models(struct lyout *out, const struct lyd_node *root, struct lyb_state *lybs)
+lyb_print_models(struct lyout *out, const struct lys_module **models, size_t mod_count, struct lyb_state *lybs)
 {
     int ret = 0;
-    const struct lys_module **models = NULL, *mod;
+    const struct lys_module *mod;
     const struct lys_submodule *submod;
-    const struct lyd_node *node;
-    size_t mod_count = 0;
     uint32_t idx = 0, i, j;
 
-    /* first, collect all data node modules */
-    LY_TREE_FOR(root, node) {
-        mod = lyd_node_module(node);
-        add_model(&models, &mod_count, mod);
-    }
-
-    if (root) {
-        /* then add all models augmenting or deviating the used models */
-        idx = ly_ctx_internal_modules_count(root->schema->module->ctx);
-        while ((mod = ly_ctx_get_module_iter(root->schema->module->ctx, &idx))) {
+    if (lybs->ctx) {
+        /* add all models augmenting or deviating the used models */
+        idx = ly_ctx_internal_modules_count(lybs->ctx);
+        while ((mod = ly_ctx_get_module_iter(lybs->ctx, &idx))) {
             if (!mod->implemented) {
 next_mod:
                 continue;
@@ -620,6 +675,21 @@ next_mod:
     return ret;
 }
 
+static int
+lyb_print_data_models(struct lyout *out, const struct lyd_node *root, struct lyb_state *lybs)
+{
+    const struct lys_module **models = NULL;
+    const struct lyd_node *node;
+    size_t mod_count = 0;
+
+    /* collect all data node modules */
+    LY_TREE_FOR(root, node) {
+        add_model(&models, &mod_count, lyd_node_module(node));
+    }
+
+    return lyb_print_models(out, models, mod_count, lybs);
+}
+
 static int
 lyb_print_magic_number(struct lyout *out)
 {
@@ -634,12 +704,18 @@ lyb_print_magic_number(struct lyout *out)
 }
 
 static int
-lyb_print_header(struct lyout *out)
+lyb_print_header(struct lyout *out, int options)
 {
     int ret = 0;
     uint8_t byte = 0;
 
     /* TODO version, some other flags? */
+    if (options & LYP_LYB_INDEX) {
+        byte |= LYB_HEADER_INDEX;
+    }
+    if (options & LYP_LYB_COMPACT) {
+        byte |= LYB_HEADER_COMPACT;
+    }
     ret += ly_write(out, (char *)&byte, sizeof byte);
 
     return ret;
@@ -689,6 +765,213 @@ lyb_print_anydata(struct lyd_node_anydata *anydata, struct lyout *out, struct ly
     return ret;
 }
 
+/* get the actual type of a value */
+static LY_DATA_TYPE
+lyb_value_type(const struct lys_type **type, LY_DATA_TYPE value_type, uint8_t value_flags, lyd_val *value)
+{
+    /* find actual type */
+    while ((*type)->base == LY_TYPE_LEAFREF) {
+        *type = &(*type)->info.lref.target->type;
+    }
+
+    if ((value_flags & LY_VALUE_USER) || ((*type)->base == LY_TYPE_UNION)) {
+        value_type = LY_TYPE_STRING;
+    } else while (value_type == LY_TYPE_LEAFREF) {
+        assert(!(value_flags & LY_VALUE_UNRES));
+
+        /* update value_type and value to that of the target */
+        value_type = ((struct lyd_node_leaf_list *)value->leafref)->value_type;
+        *value = ((struct lyd_node_leaf_list *)value->leafref)->value;
+    }
+
+    return value_type;
+}
+
+/* whether value_str of a value is printed */
+static int
+lyb_value_is_string(const struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_flags, lyd_val value)
+{
+    switch (lyb_value_type(&type, value_type, value_flags, &value)) {
+    case LY_TYPE_BINARY:
+    case LY_TYPE_INST:
+    case LY_TYPE_STRING:
+    case LY_TYPE_UNION:
+    case LY_TYPE_IDENT:
+    case LY_TYPE_UNKNOWN:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int
+lyb_strings_count(const char *str, const char ***table, uint32_t *table_count, struct lyb_state *lybs)
+{
+    struct lyb_str_rec rec, *match;
+    uint32_t hash;
+    void *mem;
+
+    rec.str = str;
+    rec.count = 1;
+    rec.idx = 0;
+    hash = lyb_str_rec_hash(str);
+
+    if (lyht_find(lybs->str_ht, &rec, hash, (void **)&match)) {
+        /* first occurrence */
+        if (lyht_insert(lybs->str_ht, &rec, hash, NULL)) {
+            LOGINT(lybs->ctx);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (++match->count == 2) {
+        /* repeated, will be in the table */
+        if (!(*table_count % LYB_INDEX_STEP)) {
+            mem = realloc(*table, (*table_count + LYB_INDEX_STEP) * sizeof **table);
+            LY_CHECK_ERR_RETURN(!mem, LOGMEM(lybs->ctx), -1);
+            *table = mem;
+        }
+        (*table)[(*table_count)++] = str;
+    }
+
+    return 0;
+}
+
+static int
+lyb_print_strings(struct lyout *out, const struct lyd_node *root, int options, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    const struct lyd_node *top, *next, *elem;
+    struct lyd_node_leaf_list *leaf;
+    struct lyd_attr *attr;
+    struct lys_type **type;
+    struct lyb_str_rec rec, *match;
+    const char **table = NULL;
+    uint32_t table_count = 0, i;
+    size_t len;
+
+    lybs->str_ht = lyht_new(LYHT_MIN_SIZE, sizeof rec, lyb_str_rec_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RETURN(!lybs->str_ht, LOGMEM(lybs->ctx), -1);
+
+    /* find the repeated strings */
+    LY_TREE_FOR(root, top) {
+        LY_TREE_DFS_BEGIN(top, next, elem) {
+            if (elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+                leaf = (struct lyd_node_leaf_list *)elem;
+                if (lyb_value_is_string(&((struct lys_node_leaf *)leaf->schema)->type, leaf->value_type, leaf->value_flags,
+                                        leaf->value)
+                        && lyb_strings_count(leaf->value_str, &table, &table_count, lybs)) {
+                    goto error;
+                }
+            }
+            LY_TREE_FOR(elem->attr, attr) {
+                type = (struct lys_type **)lys_ext_complex_get_substmt(LY_STMT_TYPE, attr->annotation, NULL);
+                if (type && *type && lyb_value_is_string(*type, attr->value_type, attr->value_flags, attr->value)
+                        && lyb_strings_count(attr->value_str, &table, &table_count, lybs)) {
+                    goto error;
+                }
+            }
+            LY_TREE_DFS_END(top, next, elem);
+        }
+
+        if (!(options & LYP_WITHSIBLINGS)) {
+            break;
+        }
+    }
+
+    /* write the table */
+    ret += (r = lyb_write_varint(table_count, out, lybs));
+    if (r < 0) {
+        goto error;
+    }
+    for (i = 0; i < table_count; ++i) {
+        rec.str = table[i];
+        lyht_find(lybs->str_ht, &rec, lyb_str_rec_hash(table[i]), (void **)&match);
+        match->idx = i + 1;
+
+        len = strlen(table[i]);
+        ret += (r = lyb_write_varint(len, out, lybs));
+        if (r < 0) {
+            goto error;
+        }
+        ret += (r = lyb_write(out, (const uint8_t *)table[i], len, lybs));
+        if (r < 0) {
+            goto error;
+        }
+    }
+
+    free(table);
+    return ret;
+
+error:
+    free(table);
+    return -1;
+}
+
+static int
+lyb_write_value_string(const char *str, struct lyout *out, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    struct lyb_str_rec rec, *match;
+    uint32_t idx = 0;
+
+    if (lybs->flags & LYB_HEADER_COMPACT) {
+        /* index in the string table, 0 if followed by the string itself */
+        rec.str = str;
+        if (!lyht_find(lybs->str_ht, &rec, lyb_str_rec_hash(str), (void **)&match)) {
+            idx = match->idx;
+        }
+        ret += (r = lyb_write_varint(idx, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+        if (idx) {
+            return ret;
+        }
+    }
+
+    ret += (r = lyb_write_string(str, 0, 0, out, lybs));
+    if (r < 0) {
+        return -1;
+    }
+
+    return ret;
+}
+
+static int
+lyb_write_compact_number(lyd_val value, LY_DATA_TYPE value_type, struct lyout *out, struct lyb_state *lybs)
+{
+    int64_t snum;
+    uint64_t num;
+
+    switch (value_type) {
+    case LY_TYPE_INT16:
+        snum = value.int16;
+        break;
+    case LY_TYPE_INT32:
+        snum = value.int32;
+        break;
+    case LY_TYPE_DEC64:
+    case LY_TYPE_INT64:
+        snum = value.int64;
+        break;
+    case LY_TYPE_UINT16:
+        return lyb_write_varint(value.uint16, out, lybs);
+    case LY_TYPE_UINT32:
+        return lyb_write_varint(value.uint32, out, lybs);
+    case LY_TYPE_UINT64:
+        return lyb_write_varint(value.uint64, out, lybs);
+    default:
+        LOGINT(lybs->ctx);
+        return -1;
+    }
+
+    /* zigzag encoding so that small negative numbers are short, too */
+    num = ((uint64_t)snum << 1) ^ (uint64_t)(snum >> 63);
+    return lyb_write_varint(num, out, lybs);
+}
+
 static int
 lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val value, LY_DATA_TYPE value_type,
                 uint8_t value_flags, uint8_t dflt, struct lyout *out, struct lyb_state *lybs)
@@ -719,19 +1002,7 @@ lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val valu
     assert((value_type & 0x1f) == value_type);
 
     /* find actual type */
-    while (type->base == LY_TYPE_LEAFREF) {
-        type = &type->info.lref.target->type;
-    }
-
-    if ((value_flags & LY_VALUE_USER) || (type->base == LY_TYPE_UNION)) {
-        value_type = LY_TYPE_STRING;
-    } else while (value_type == LY_TYPE_LEAFREF) {
-        assert(!(value_flags & LY_VALUE_UNRES));
-
-        /* update value_type and value to that of the target */
-        value_type = ((struct lyd_node_leaf_list *)value.leafref)->value_type;
-        value = ((struct lyd_node_leaf_list *)value.leafref)->value;
-    }
+    value_type = lyb_value_type(&type, value_type, value_flags, &value);
 
     /* store the value type */
     byte |= value_type & 0x1f;
@@ -745,6 +1016,11 @@ lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val valu
     } else {
         dtype = value_type;
     }
+    if ((lybs->flags & LYB_HEADER_COMPACT) && LYB_COMPACT_NUMBER(dtype)) {
+        /* store a variable-length number */
+        ret += lyb_write_compact_number(value, dtype, out, lybs);
+        return ret;
+    }
     switch (dtype) {
     case LY_TYPE_BINARY:
     case LY_TYPE_INST:
@@ -753,7 +1029,7 @@ lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val valu
     case LY_TYPE_IDENT:
     case LY_TYPE_UNKNOWN:
         /* store string */
-        ret += lyb_write_string(value_str, 0, 0, out, lybs);
+        ret += lyb_write_value_string(value_str, out, lybs);
         break;
     case LY_TYPE_BITS:
         /* find the correct structure */
@@ -894,10 +1170,10 @@ static int
 lyb_print_schema_hash(struct lyout *out, struct lys_node *schema, struct hash_table **sibling_ht, struct lyb_state *lybs)
 {
     int r, ret = 0;
-    void *mem;
-    uint32_t i;
+    uint32_t i, ht_hash;
     LYB_HASH hash;
-    struct lys_node *first_sibling, *parent;
+    struct lys_node *parent;
+    struct lyb_sib_ht rec, *match;
 
     /* create whole sibling HT if not already created and saved */
     if (!*sibling_ht) {
@@ -906,30 +1182,32 @@ lyb_print_schema_hash(struct lyout *out, struct lys_node *schema, struct hash_ta
              parent && (parent->nodetype & (LYS_USES | LYS_CASE | LYS_CHOICE));
              parent = lys_parent(parent));
 
-        first_sibling = (struct lys_node *)lys_getnext(NULL, parent, lys_node_module(schema), 0);
-        for (r = 0; r < lybs->sib_ht_count; ++r) {
-            if (lybs->sib_ht[r].first_sibling == first_sibling) {
-                /* we have already created a hash table for these siblings */
-                *sibling_ht = lybs->sib_ht[r].ht;
-                break;
-            }
+        rec.first_sibling = (struct lys_node *)lys_getnext(NULL, parent, lys_node_module(schema), 0);
+        ht_hash = dict_hash_multi(0, (const char *)&rec.first_sibling, sizeof rec.first_sibling);
+        ht_hash = dict_hash_multi(ht_hash, NULL, 0);
+
+        if (!lybs->sib_ht) {
+            lybs->sib_ht = lyht_new(8, sizeof rec, lyb_sib_ht_equal_cb, NULL, 1);
+            LY_CHECK_ERR_RETURN(!lybs->sib_ht, LOGMEM(lybs->ctx), -1);
+        } else if (!lyht_find(lybs->sib_ht, &rec, ht_hash, (void **)&match)) {
+            /* we have already created a hash table for these siblings */
+            *sibling_ht = match->ht;
         }
 
         if (!*sibling_ht) {
             /* we must create sibling hash table */
-            *sibling_ht = lyb_hash_siblings(first_sibling, NULL, 0);
-            if (!*sibling_ht) {
+            rec.ht = lyb_hash_siblings(rec.first_sibling, NULL, 0);
+            if (!rec.ht) {
                 return -1;
             }
 
             /* and save it */
-            ++lybs->sib_ht_count;
-            mem = realloc(lybs->sib_ht, lybs->sib_ht_count * sizeof *lybs->sib_ht);
-            LY_CHECK_ERR_RETURN(!mem, LOGMEM(lybs->ctx), -1);
-            lybs->sib_ht = mem;
-
-            lybs->sib_ht[lybs->sib_ht_count - 1].first_sibling = first_sibling;
-            lybs->sib_ht[lybs->sib_ht_count - 1].ht = *sibling_ht;
+            if (lyht_insert(lybs->sib_ht, &rec, ht_hash, NULL)) {
+                lyht_free(rec.ht);
+                LOGINT(lybs->ctx);
+                return -1;
+            }
+            *sibling_ht = rec.ht;
         }
     }
 
@@ -969,14 +1247,121 @@ lyb_print_schema_hash(struct lyout *out, struct lys_node *schema, struct hash_ta
     return ret;
 }
 
+uint32_t
+lyb_index_hash(const struct lyd_node *node)
+{
+    const struct lys_node_list *slist;
+    const struct lyd_node *iter;
+    const char *str;
+    uint32_t hash;
+    uint16_t i;
+
+    str = lyd_node_module(node)->name;
+    hash = dict_hash_multi(0, str, strlen(str));
+    hash = dict_hash_multi(hash, node->schema->name, strlen(node->schema->name));
+
+    if (node->schema->nodetype == LYS_LIST) {
+        /* keys are the first children, in order */
+        slist = (const struct lys_node_list *)node->schema;
+        for (iter = node->child, i = 0; iter && (i < slist->keys_size); iter = iter->next) {
+            if (iter->schema == (struct lys_node *)slist->keys[i]) {
+                str = ((struct lyd_node_leaf_list *)iter)->value_str;
+                hash = dict_hash_multi(hash, str, strlen(str));
+                ++i;
+            }
+        }
+    } else if (node->schema->nodetype == LYS_LEAFLIST) {
+        str = ((struct lyd_node_leaf_list *)node)->value_str;
+        hash = dict_hash_multi(hash, str, strlen(str));
+    }
+
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+static int
+lyb_index_add(const struct lyd_node *node, uint64_t offset, uint32_t parent, struct lyb_state *lybs)
+{
+    struct lyb_index_entry *entry;
+
+    if (lybs->index_count == lybs->index_size) {
+        lybs->index_size += LYB_INDEX_STEP;
+        lybs->index = ly_realloc(lybs->index, lybs->index_size * sizeof *lybs->index);
+        LY_CHECK_ERR_RETURN(!lybs->index, LOGMEM(lybs->ctx), -1);
+    }
+
+    entry = &lybs->index[lybs->index_count++];
+    entry->offset = offset;
+    entry->parent = parent;
+    entry->hash = lyb_index_hash(node);
+    if (lybs->used) {
+        /* remember the state of the parent chunk so that the subtree can be read on its own */
+        entry->parent_written = lybs->written[lybs->used - 1];
+        entry->parent_inner = lybs->inner_chunks[lybs->used - 1];
+    } else {
+        entry->parent_written = 0;
+        entry->parent_inner = 0;
+    }
+
+    return 0;
+}
+
+static int
+lyb_print_index(struct lyout *out, uint64_t offset, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint32_t i;
+
+    ret += (r = lyb_write_number(lybs->index_count, 4, out, lybs));
+    if (r < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < lybs->index_count; ++i) {
+        ret += (r = lyb_write_number(lybs->index[i].offset, 8, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+        ret += (r = lyb_write_number(lybs->index[i].parent, 4, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+        ret += (r = lyb_write_number(lybs->index[i].hash, 4, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+        ret += (r = lyb_write_number(lybs->index[i].parent_written, 1, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+        ret += (r = lyb_write_number(lybs->index[i].parent_inner, 1, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+    }
+
+    /* the index is found from the end of the data */
+    ret += (r = lyb_write_number(offset, 8, out, lybs));
+    if (r < 0) {
+        return -1;
+    }
+
+    return ret;
+}
+
 static int
 lyb_print_subtree(struct lyout *out, const struct lyd_node *node, struct hash_table **sibling_ht, struct lyb_state *lybs,
                   int top_level)
 {
     int r, ret = 0;
+    uint32_t top_idx = 0;
     struct lyd_node_leaf_list *leaf;
     struct hash_table *child_ht = NULL;
 
+    if (top_level && lybs->index) {
+        /* entry of this subtree was added by the caller */
+        top_idx = lybs->index_count - 1;
+    }
+
     /* register a new subtree */
     ret += (r = lyb_write_start_subtree(out, lybs));
     if (r < 0) {
@@ -1037,6 +1422,13 @@ lyb_print_subtree(struct lyout *out, const struct lyd_node *node, struct hash_ta
     r = 0;
     if (node->schema->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_NOTIF | LYS_RPC | LYS_ACTION)) {
         LY_TREE_FOR(node->child, node) {
+            if (top_level && lybs->index && (node->schema->nodetype == LYS_LIST)
+                    && ((struct lys_node_list *)node->schema)->keys_size) {
+                if (lyb_index_add(node, lybs->index[top_idx].offset + ret, top_idx, lybs)) {
+                    return -1;
+                }
+            }
+
             ret += (r = lyb_print_subtree(out, node, &child_ht, lybs, 0));
             if (r < 0) {
                 break;
@@ -1056,6 +1448,28 @@ lyb_print_subtree(struct lyout *out, const struct lyd_node *node, struct hash_ta
     return ret;
 }
 
+static void
+lyb_print_state_clean(struct lyb_state *lybs)
+{
+    struct ht_rec *hrec;
+    uint32_t i;
+
+    free(lybs->written);
+    free(lybs->position);
+    free(lybs->inner_chunks);
+    free(lybs->index);
+    lyht_free(lybs->str_ht);
+    if (lybs->sib_ht) {
+        for (i = 0; i < lybs->sib_ht->size; ++i) {
+            hrec = lyht_get_rec(lybs->sib_ht->recs, lybs->sib_ht->rec_size, i);
+            if (hrec->hits > 0) {
+                lyht_free(((struct lyb_sib_ht *)hrec->val)->ht);
+            }
+        }
+        lyht_free(lybs->sib_ht);
+    }
+}
+
 int
 lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
 {
@@ -1086,7 +1500,7 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
     }
 
     /* LYB header */
-    ret += (r = lyb_print_header(out));
+    ret += (r = lyb_print_header(out, options));
     if (r < 0) {
         rc = EXIT_FAILURE;
         goto finish;
@@ -1099,6 +1513,16 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
         goto finish;
     }
 
+    if (options & LYP_LYB_COMPACT) {
+        /* table of repeated strings */
+        lybs.flags |= LYB_HEADER_COMPACT;
+        ret += (r = lyb_print_strings(out, root, options, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+    }
+
     LY_TREE_FOR(root, root) {
         /* do not reuse sibling hash tables from different modules */
         if (lyd_node_module(root) != prev_mod) {
@@ -1106,6 +1530,11 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
             prev_mod = lyd_node_module(root);
         }
 
+        if ((options & LYP_LYB_INDEX) && lyb_index_add(root, ret, LYB_INDEX_TOP, &lybs)) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+
         ret += (r = lyb_print_subtree(out, root, &top_sibling_ht, &lybs, 1));
         if (r < 0) {
             rc = EXIT_FAILURE;
@@ -1121,16 +1550,167 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
     ret += (r = lyb_write(out, &zero, sizeof zero, &lybs));
     if (r < 0) {
         rc = EXIT_FAILURE;
+        goto finish;
+    }
+
+    if (options & LYP_LYB_INDEX) {
+        /* index of the subtrees */
+        ret += (r = lyb_print_index(out, ret, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+        }
     }
 
 finish:
-    free(lybs.written);
-    free(lybs.position);
-    free(lybs.inner_chunks);
-    for (r = 0; r < lybs.sib_ht_count; ++r) {
-        lyht_free(lybs.sib_ht[r].ht);
+    lyb_print_state_clean(&lybs);
+    return rc;
+}
+
+int
+lyb_print_diff(struct lyout *out, const struct lyd_difflist *diff)
+{
+    int r, ret = 0, rc = EXIT_SUCCESS;
+    uint8_t byte;
+    uint32_t i;
+    char *path = NULL, *anchor = NULL;
+    const struct lys_module **models = NULL;
+    const struct lyd_node *node, *payload;
+    size_t mod_count = 0;
+    struct hash_table *sibling_ht;
+    struct lyb_state lybs;
+
+    memset(&lybs, 0, sizeof lybs);
+
+    /* collect the modules of the nodes that are printed whole */
+    for (i = 0; diff->type[i] != LYD_DIFF_END; ++i) {
+        node = diff->first[i] ? diff->first[i] : diff->second[i];
+        if (node && !lybs.ctx) {
+            lybs.ctx = lyd_node_module(node)->ctx;
+        }
+        if ((diff->type[i] == LYD_DIFF_CREATED) || (diff->type[i] == LYD_DIFF_CHANGED)) {
+            for (node = diff->second[i]; node->parent; node = node->parent);
+            add_model(&models, &mod_count, lyd_node_module(node));
+        }
     }
-    free(lybs.sib_ht);
 
+    /* LYB magic number */
+    ret += (r = lyb_print_magic_number(out));
+    if (r < 0) {
+        rc = EXIT_FAILURE;
+        goto finish;
+    }
+
+    /* LYB header */
+    byte = LYB_HEADER_DIFF;
+    ret += (r = ly_write(out, (char *)&byte, sizeof byte));
+    if (r < 0) {
+        rc = EXIT_FAILURE;
+        goto finish;
+    }
+
+    /* all used models */
+    ret += (r = lyb_print_models(out, models, mod_count, &lybs));
+    models = NULL;
+    if (r < 0) {
+        rc = EXIT_FAILURE;
+        goto finish;
+    }
+
+    /* every difference as a separate subtree */
+    for (i = 0; diff->type[i] != LYD_DIFF_END; ++i) {
+        payload = NULL;
+        switch (diff->type[i]) {
+        case LYD_DIFF_DELETED:
+            path = lyd_path(diff->first[i]);
+            break;
+        case LYD_DIFF_CHANGED:
+            path = lyd_path(diff->first[i]);
+            payload = diff->second[i];
+            break;
+        case LYD_DIFF_CREATED:
+            /* path of the parent, empty for top-level nodes */
+            path = diff->first[i] ? lyd_path(diff->first[i]) : strdup("");
+            payload = diff->second[i];
+            break;
+        case LYD_DIFF_MOVEDAFTER1:
+            path = lyd_path(diff->first[i]);
+            anchor = diff->second[i] ? lyd_path(diff->second[i]) : strdup("");
+            break;
+        case LYD_DIFF_MOVEDAFTER2:
+            path = lyd_path(diff->second[i]);
+            anchor = diff->first[i] ? lyd_path(diff->first[i]) : strdup("");
+            break;
+        default:
+            LOGINT(lybs.ctx);
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+        if (!path || (((diff->type[i] == LYD_DIFF_MOVEDAFTER1) || (diff->type[i] == LYD_DIFF_MOVEDAFTER2)) && !anchor)) {
+            LOGMEM(lybs.ctx);
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+
+        ret += (r = lyb_write_start_subtree(out, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+
+        /* difference type and the node path */
+        byte = diff->type[i];
+        ret += (r = lyb_write(out, &byte, sizeof byte, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+        ret += (r = lyb_write_string(path, 0, 1, out, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+
+        if (anchor) {
+            /* the preceding sibling after the move */
+            ret += (r = lyb_write_string(anchor, 0, 1, out, &lybs));
+            if (r < 0) {
+                rc = EXIT_FAILURE;
+                goto finish;
+            }
+        }
+
+        if (payload) {
+            /* the whole new node, with the module only if top-level */
+            sibling_ht = NULL;
+            ret += (r = lyb_print_subtree(out, payload, &sibling_ht, &lybs, payload->parent ? 0 : 1));
+            if (r < 0) {
+                rc = EXIT_FAILURE;
+                goto finish;
+            }
+        }
+
+        ret += (r = lyb_write_stop_subtree(out, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+
+        free(path);
+        free(anchor);
+        path = anchor = NULL;
+    }
+
+    /* ending zero byte */
+    byte = 0;
+    ret += (r = lyb_write(out, &byte, sizeof byte, &lybs));
+    if (r < 0) {
+        rc = EXIT_FAILURE;
+    }
+
+finish:
+    free(path);
+    free(anchor);
+    free(models);
+    lyb_print_state_clean(&lybs);
     return rc;
 }
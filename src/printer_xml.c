@@ -298,13 +298,37 @@ normal_print:
     LY_PRINT_RET(node->schema->module->ctx);
 }
 
+/* print the indentation and the start of the start tag of a node,
+ * with the default namespace if the parent is from another module */
+static const struct lyout_frag *
+xml_print_open(struct lyout *out, int level, const struct lyd_node *node, int toplevel)
+{
+    const struct lyout_frag *frag;
+
+    frag = ly_print_frag(out, node->schema, LYD_XML);
+    if (!frag) {
+        return NULL;
+    }
+
+    ly_print_indent(out, LEVEL);
+    if (toplevel || !node->parent || nscmp(node, node->parent)) {
+        /* print "namespace" */
+        ly_write(out, frag->qname, frag->qname_len);
+    } else {
+        ly_write(out, frag->name, frag->name_len);
+    }
+
+    return frag;
+}
+
 static int
 xml_print_leaf(struct lyout *out, int level, const struct lyd_node *node, int toplevel, int options)
 {
     const struct lyd_node_leaf_list *leaf = (struct lyd_node_leaf_list *)node, *iter;
     const struct lys_type *type;
+    const struct lyout_frag *frag;
     struct lys_tpdf *tpdf;
-    const char *ns, *mod_name;
+    const char *mod_name;
     const char **prefs, **nss;
     const char *xml_expr;
     uint32_t ns_count, i;
@@ -316,12 +340,9 @@ xml_print_leaf(struct lyout *out, int level, const struct lyd_node *node, int to
 
     LY_PRINT_SET;
 
-    if (toplevel || !node->parent || nscmp(node, node->parent)) {
-        /* print "namespace" */
-        ns = lyd_node_module(node)->ns;
-        ly_print(out, "%*s<%s xmlns=\"%s\"", LEVEL, INDENT, node->schema->name, ns);
-    } else {
-        ly_print(out, "%*s<%s", LEVEL, INDENT, node->schema->name);
+    frag = xml_print_open(out, level, node, toplevel);
+    if (!frag) {
+        return EXIT_FAILURE;
     }
 
     if (toplevel) {
@@ -367,11 +388,11 @@ printvalue:
     case LY_TYPE_UINT32:
     case LY_TYPE_UINT64:
         if (!leaf->value_str || !leaf->value_str[0]) {
-            ly_print(out, "/>");
+            ly_write(out, "/>", 2);
         } else {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, leaf->value_str, LYXML_DATA_ELEM);
-            ly_print(out, "</%s>", node->schema->name);
+            ly_write(out, frag->close, frag->close_len);
         }
         break;
 
@@ -385,9 +406,9 @@ printvalue:
         len = p - leaf->value_str;
         mod_name = leaf->schema->module->name;
         if (!strncmp(leaf->value_str, mod_name, len) && !mod_name[len]) {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, ++p, LYXML_DATA_ELEM);
-            ly_print(out, "</%s>", node->schema->name);
+            ly_write(out, frag->close, frag->close_len);
         } else {
             /* avoid code duplication - use instance-identifier printer which gets necessary namespaces to print */
             datatype = LY_TYPE_INST;
@@ -409,9 +430,9 @@ printvalue:
         free(nss);
 
         if (xml_expr[0]) {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, xml_expr, LYXML_DATA_ELEM);
-            ly_print(out, "</%s>", node->schema->name);
+            ly_write(out, frag->close, frag->close_len);
         } else {
             ly_print(out, "/>");
         }
@@ -449,7 +470,7 @@ printvalue:
     }
 
     if (level) {
-        ly_print(out, "\n");
+        ly_write(out, "\n", 1);
     }
 
     LY_PRINT_RET(node->schema->module->ctx);
@@ -459,17 +480,14 @@ static int
 xml_print_container(struct lyout *out, int level, const struct lyd_node *node, int toplevel, int options)
 {
     struct lyd_node *child;
-    const char *ns;
+    const struct lyout_frag *frag;
     struct mlist *mlist = NULL;
 
     LY_PRINT_SET;
 
-    if (toplevel || !node->parent || nscmp(node, node->parent)) {
-        /* print "namespace" */
-        ns = lyd_node_module(node)->ns;
-        ly_print(out, "%*s<%s xmlns=\"%s\"", LEVEL, INDENT, node->schema->name, ns);
-    } else {
-        ly_print(out, "%*s<%s", LEVEL, INDENT, node->schema->name);
+    frag = xml_print_open(out, level, node, toplevel);
+    if (!frag) {
+        return EXIT_FAILURE;
     }
 
     if (toplevel) {
@@ -482,10 +500,10 @@ xml_print_container(struct lyout *out, int level, const struct lyd_node *node, i
     }
 
     if (!node->child) {
-        ly_print(out, "/>%s", level ? "\n" : "");
+        ly_write(out, "/>\n", level ? 3 : 2);
         goto finish;
     }
-    ly_print(out, ">%s", level ? "\n" : "");
+    ly_write(out, ">\n", level ? 2 : 1);
 
     LY_TREE_FOR(node->child, child) {
         if (xml_print_node(out, level ? level + 1 : 0, child, 0, options)) {
@@ -493,7 +511,11 @@ xml_print_container(struct lyout *out, int level, const struct lyd_node *node, i
         }
     }
 
-    ly_print(out, "%*s</%s>%s", LEVEL, INDENT, node->schema->name, level ? "\n" : "");
+    ly_print_indent(out, LEVEL);
+    ly_write(out, frag->close, frag->close_len);
+    if (level) {
+        ly_write(out, "\n", 1);
+    }
 
 finish:
     LY_PRINT_RET(node->schema->module->ctx);
@@ -503,19 +525,16 @@ static int
 xml_print_list(struct lyout *out, int level, const struct lyd_node *node, int is_list, int toplevel, int options)
 {
     struct lyd_node *child;
-    const char *ns;
+    const struct lyout_frag *frag;
     struct mlist *mlist = NULL;
 
     LY_PRINT_SET;
 
     if (is_list) {
         /* list print */
-        if (toplevel || !node->parent || nscmp(node, node->parent)) {
-            /* print "namespace" */
-            ns = lyd_node_module(node)->ns;
-            ly_print(out, "%*s<%s xmlns=\"%s\"", LEVEL, INDENT, node->schema->name, ns);
-        } else {
-            ly_print(out, "%*s<%s", LEVEL, INDENT, node->schema->name);
+        frag = xml_print_open(out, level, node, toplevel);
+        if (!frag) {
+            return EXIT_FAILURE;
         }
 
         if (toplevel) {
@@ -527,10 +546,10 @@ xml_print_list(struct lyout *out, int level, const struct lyd_node *node, int is
         }
 
         if (!node->child) {
-            ly_print(out, "/>%s", level ? "\n" : "");
+            ly_write(out, "/>\n", level ? 3 : 2);
             goto finish;
         }
-        ly_print(out, ">%s", level ? "\n" : "");
+        ly_write(out, ">\n", level ? 2 : 1);
 
         LY_TREE_FOR(node->child, child) {
             if (xml_print_node(out, level ? level + 1 : 0, child, 0, options)) {
@@ -538,7 +557,11 @@ xml_print_list(struct lyout *out, int level, const struct lyd_node *node, int is
             }
         }
 
-        ly_print(out, "%*s</%s>%s", LEVEL, INDENT, node->schema->name, level ? "\n" : "");
+        ly_print_indent(out, LEVEL);
+        ly_write(out, frag->close, frag->close_len);
+        if (level) {
+            ly_write(out, "\n", 1);
+        }
     } else {
         /* leaf-list print */
         xml_print_leaf(out, level, node, toplevel, options);
@@ -554,17 +577,14 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
     char *buf;
     struct lyd_node_anydata *any = (struct lyd_node_anydata *)node;
     struct lyd_node *iter;
-    const char *ns;
+    const struct lyout_frag *frag;
     struct mlist *mlist = NULL;
 
     LY_PRINT_SET;
 
-    if (toplevel || !node->parent || nscmp(node, node->parent)) {
-        /* print "namespace" */
-        ns = lyd_node_module(node)->ns;
-        ly_print(out, "%*s<%s xmlns=\"%s\"", LEVEL, INDENT, node->schema->name, ns);
-    } else {
-        ly_print(out, "%*s<%s", LEVEL, INDENT, node->schema->name);
+    frag = xml_print_open(out, level, node, toplevel);
+    if (!frag) {
+        return EXIT_FAILURE;
     }
 
     if (toplevel) {
@@ -640,7 +660,10 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
         }
 
         /* closing tag */
-        ly_print(out, "</%s>%s", node->schema->name, level ? "\n" : "");
+        ly_write(out, frag->close, frag->close_len);
+        if (level) {
+            ly_write(out, "\n", 1);
+        }
     }
 
     LY_PRINT_RET(node->schema->module->ctx);
@@ -2528,7 +2528,7 @@ resolve_partial_json_data_nodeid(const char *nodeid, const char *llist_value, st
     int has_predicate, last_parsed = 0, llval_len;
     struct lyd_node *sibling, *last_match = NULL;
     struct lyd_node_leaf_list *llist;
-    const struct lys_module *prev_mod;
+    const struct lys_module *prev_mod, *prefix_mod;
     struct ly_ctx *ctx;
     const struct lys_node *ssibling, *sparent;
     struct lys_node_list *slist;
@@ -2582,10 +2582,12 @@ resolve_partial_json_data_nodeid(const char *nodeid, const char *llist_value, st
     goto parse_predicates;
 
     while (1) {
-        /* find the correct schema node first */
+        /* find the correct schema node first, try the schema node index (RPC/action in/out nodes are never indexed) */
         ssibling = NULL;
         sparent = (start && start->parent) ? start->parent->schema : NULL;
-        while ((ssibling = lys_getnext(ssibling, sparent, prev_mod, 0))) {
+        prefix_mod = mod_name ? lyp_get_module(prev_mod, NULL, 0, mod_name, mod_name_len, 0) : prev_mod;
+        ret = prefix_mod ? lys_node_idx_find(sparent, prev_mod, prefix_mod, NULL, name, nam_len, 0, 0, &ssibling) : 1;
+        while ((ret == -1) && (ssibling = lys_getnext(ssibling, sparent, prev_mod, 0))) {
             /* skip invalid input/output nodes */
             if (sparent && (sparent->nodetype & (LYS_RPC | LYS_ACTION))) {
                 if (options & LYD_PATH_OPT_OUTPUT) {
@@ -6217,6 +6219,8 @@ resolve_must(struct lyd_node *node, int inout_parent, int ignore_fail)
     struct lys_restr *must;
     struct lyxp_set set;
     struct ly_ctx *ctx = node->schema->module->ctx;
+    struct timespec ts;
+    int rc, vm;
 
     assert(node);
     memset(&set, 0, sizeof set);
@@ -6272,7 +6276,12 @@ resolve_must(struct lyd_node *node, int inout_parent, int ignore_fail)
     }
 
     for (i = 0; i < must_size; ++i) {
-        if (lyxp_eval(must[i].expr, node, LYXP_NODE_ELEM, lyd_node_module(node), &set, LYXP_MUST)) {
+        vm = lyv_vmetric_start(ctx, &ts);
+        rc = lyxp_eval(must[i].expr, node, LYXP_NODE_ELEM, lyd_node_module(node), &set, LYXP_MUST);
+        if (vm) {
+            lyv_vmetric_add(ctx, LYD_VMETRIC_MUST, &must[i], inout_parent ? schema : node->schema, must[i].expr, &ts);
+        }
+        if (rc) {
             return -1;
         }
 
@@ -6673,7 +6682,8 @@ resolve_when(struct lyd_node *node, int ignore_fail, struct lys_when **failed_wh
     struct lyxp_set set;
     enum lyxp_node_type ctx_node_type;
     struct ly_ctx *ctx = node->schema->module->ctx;
-    int rc = 0;
+    struct timespec ts;
+    int rc = 0, vm;
 
     assert(node);
     memset(&set, 0, sizeof set);
@@ -6681,8 +6691,13 @@ resolve_when(struct lyd_node *node, int ignore_fail, struct lys_when **failed_wh
     if (!(node->schema->nodetype & (LYS_NOTIF | LYS_RPC | LYS_ACTION)) && snode_get_when(node->schema)) {
         /* make the node dummy for the evaluation */
         node->validity |= LYD_VAL_INUSE;
+        vm = lyv_vmetric_start(ctx, &ts);
         rc = lyxp_eval(snode_get_when(node->schema)->cond, node, LYXP_NODE_ELEM, lyd_node_module(node),
                        &set, LYXP_WHEN);
+        if (vm) {
+            lyv_vmetric_add(ctx, LYD_VMETRIC_WHEN, snode_get_when(node->schema), node->schema,
+                            snode_get_when(node->schema)->cond, &ts);
+        }
         node->validity &= ~LYD_VAL_INUSE;
         if (rc) {
             if (rc == 1) {
@@ -6733,8 +6748,13 @@ resolve_when(struct lyd_node *node, int ignore_fail, struct lys_when **failed_wh
                 goto cleanup;
             }
 
+            vm = lyv_vmetric_start(ctx, &ts);
             rc = lyxp_eval(snode_get_when(sparent)->cond, ctx_node, ctx_node_type, lys_node_module(sparent),
                            &set, LYXP_WHEN);
+            if (vm) {
+                lyv_vmetric_add(ctx, LYD_VMETRIC_WHEN, snode_get_when(sparent), sparent, snode_get_when(sparent)->cond,
+                                &ts);
+            }
 
             if (unlinked_nodes && ctx_node) {
                 if (resolve_when_relink_nodes(ctx_node, unlinked_nodes, ctx_node_type)) {
@@ -6786,8 +6806,13 @@ check_augment:
                 goto cleanup;
             }
 
+            vm = lyv_vmetric_start(ctx, &ts);
             rc = lyxp_eval(snode_get_when(sparent->parent)->cond, ctx_node, ctx_node_type,
                            lys_node_module(sparent->parent), &set, LYXP_WHEN);
+            if (vm) {
+                lyv_vmetric_add(ctx, LYD_VMETRIC_WHEN, snode_get_when(sparent->parent), sparent->parent,
+                                snode_get_when(sparent->parent)->cond, &ts);
+            }
 
             /* reconnect nodes, if ctx_node is NULL then all the nodes were unlinked, but linked together,
              * so the tree did not actually change and there is nothing for us to do
@@ -8164,10 +8189,11 @@ resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store,
 int
 resolve_unres_data_item(struct lyd_node *node, enum UNRES_ITEM type, int ignore_fail, struct lys_when **failed_when)
 {
-    int rc, req_inst, ext_dep;
+    int rc, req_inst, ext_dep, vm;
     struct lyd_node_leaf_list *leaf;
     struct lyd_node *ret;
     struct lys_node_leaf *sleaf;
+    struct timespec ts;
 
     leaf = (struct lyd_node_leaf_list *)node;
     sleaf = (struct lys_node_leaf *)leaf->schema;
@@ -8185,7 +8211,12 @@ resolve_unres_data_item(struct lyd_node *node, enum UNRES_ITEM type, int ignore_
             rc = 0;
             ret = NULL;
         } else {
+            vm = lyv_vmetric_start(node->schema->module->ctx, &ts);
             rc = resolve_leafref(leaf, sleaf->type.info.lref.path, req_inst, &ret);
+            if (vm) {
+                lyv_vmetric_add(node->schema->module->ctx, LYD_VMETRIC_LEAFREF, &sleaf->type.info.lref, node->schema,
+                                sleaf->type.info.lref.path, &ts);
+            }
         }
         if (!rc) {
             if (ret && !(leaf->schema->flags & LYS_LEAFREF_DEP)) {
@@ -8268,7 +8299,14 @@ resolve_unres_data_item(struct lyd_node *node, enum UNRES_ITEM type, int ignore_
         break;
 
     case UNRES_UNIQ_LEAVES:
-        if (lyv_data_unique(node)) {
+        /* measure only the actual checks */
+        vm = (node->validity & LYD_VAL_UNIQUE) ? lyv_vmetric_start(node->schema->module->ctx, &ts) : 0;
+        rc = lyv_data_unique(node);
+        if (vm) {
+            lyv_vmetric_add(node->schema->module->ctx, LYD_VMETRIC_UNIQUE, ((struct lys_node_list *)node->schema)->unique,
+                            node->schema, NULL, &ts);
+        }
+        if (rc) {
             return -1;
         }
         break;
@@ -42,6 +42,9 @@ static struct lys_node *lyd_get_schema_inctx(const struct lyd_node *node, struct
 
 static struct lyd_node *lyd_dup_withsiblings_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx);
 
+static struct lyd_node *lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup, int options,
+                                               int copy_flags, struct ly_ctx *ctx);
+
 static struct lyd_node *lyd_new_dummy(struct lyd_node *root, struct lyd_node *parent, const struct lys_node *schema,
                                       const char *value, int dflt);
 
@@ -113,13 +116,102 @@ lyd_list_has_keys(struct lyd_node *list)
     return 1;
 }
 
+struct lys_type *
+lyd_leaf_type_typed(const struct lyd_node_leaf_list *leaf)
+{
+    struct lys_type *type;
+
+    if (leaf->value_flags & (LY_VALUE_UNRES | LY_VALUE_USER)) {
+        return NULL;
+    }
+
+    type = &((struct lys_node_leaf *)leaf->schema)->type;
+    if ((type->base != leaf->value_type) || (type->base == LY_TYPE_LEAFREF)) {
+        /* union, unresolved leafref, or resolved leafref (pointing to the target leaf),
+         * the schema type does not describe the value */
+        return NULL;
+    }
+
+    return type;
+}
+
+/**
+ * @brief Compare values of 2 leaves based on their typed value.
+ *
+ * @param[in] leaf1 First leaf.
+ * @param[in] leaf2 Second leaf.
+ * @param[in] diff_ctx Whether the leaves are from different contexts.
+ * @return 1 if the values are equal, 0 if not, -1 if they cannot be compared this way.
+ */
+static int
+lyd_leaf_val_typed_equal(const struct lyd_node_leaf_list *leaf1, const struct lyd_node_leaf_list *leaf2, int diff_ctx)
+{
+    struct lys_type *type1, *type2;
+
+    type1 = lyd_leaf_type_typed(leaf1);
+    type2 = lyd_leaf_type_typed(leaf2);
+    if (!type1 || !type2 || (type1->base != type2->base)) {
+        return -1;
+    }
+
+    switch (type1->base) {
+    case LY_TYPE_BOOL:
+        return leaf1->value.bln == leaf2->value.bln;
+    case LY_TYPE_EMPTY:
+        return 1;
+    case LY_TYPE_INT8:
+        return leaf1->value.int8 == leaf2->value.int8;
+    case LY_TYPE_INT16:
+        return leaf1->value.int16 == leaf2->value.int16;
+    case LY_TYPE_INT32:
+        return leaf1->value.int32 == leaf2->value.int32;
+    case LY_TYPE_INT64:
+        return leaf1->value.int64 == leaf2->value.int64;
+    case LY_TYPE_UINT8:
+        return leaf1->value.uint8 == leaf2->value.uint8;
+    case LY_TYPE_UINT16:
+        return leaf1->value.uint16 == leaf2->value.uint16;
+    case LY_TYPE_UINT32:
+        return leaf1->value.uint32 == leaf2->value.uint32;
+    case LY_TYPE_UINT64:
+        return leaf1->value.uint64 == leaf2->value.uint64;
+    case LY_TYPE_DEC64:
+        if (type1->info.dec64.dig != type2->info.dec64.dig) {
+            return -1;
+        }
+        return leaf1->value.dec64 == leaf2->value.dec64;
+    case LY_TYPE_ENUM:
+        if (diff_ctx) {
+            /* schema definitions from different contexts */
+            return -1;
+        }
+        return leaf1->value.enm == leaf2->value.enm;
+    case LY_TYPE_IDENT:
+        if (diff_ctx) {
+            return -1;
+        }
+        return leaf1->value.ident == leaf2->value.ident;
+    default:
+        break;
+    }
+
+    return -1;
+}
+
 static int
 lyd_leaf_val_equal(struct lyd_node *node1, struct lyd_node *node2, int diff_ctx)
 {
+    int ret;
+
     assert(node1->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST));
     assert(node1->schema->nodetype == node2->schema->nodetype);
 
     if (diff_ctx) {
+        /* strings are not in the same dictionary, try to avoid comparing them */
+        ret = lyd_leaf_val_typed_equal((struct lyd_node_leaf_list *)node1, (struct lyd_node_leaf_list *)node2, diff_ctx);
+        if (ret > -1) {
+            return ret;
+        }
         return ly_strequal(((struct lyd_node_leaf_list *)node1)->value_str, ((struct lyd_node_leaf_list *)node2)->value_str, 0);
     } else {
         return ly_strequal(((struct lyd_node_leaf_list *)node1)->value_str, ((struct lyd_node_leaf_list *)node2)->value_str, 1);
@@ -279,6 +371,19 @@ next_sibling:
     return 0;
 }
 
+uint32_t
+lyd_value_hash(const char *value_str)
+{
+    uint32_t hash;
+
+    if (!value_str) {
+        value_str = "";
+    }
+
+    hash = dict_hash_multi(0, value_str, strlen(value_str));
+    return dict_hash_multi(hash, NULL, 0);
+}
+
 #ifdef LY_ENABLED_CACHE
 
 static int
@@ -348,20 +453,21 @@ int
 lyd_hash(struct lyd_node *node)
 {
     struct lyd_node *iter;
+    uint32_t val_hash;
     int i;
 
     if ((node->schema->nodetype != LYS_LIST) || lyd_list_has_keys(node)) {
         node->hash = dict_hash_multi(0, lyd_node_module(node)->name, strlen(lyd_node_module(node)->name));
         node->hash = dict_hash_multi(node->hash, node->schema->name, strlen(node->schema->name));
         if (node->schema->nodetype == LYS_LEAFLIST) {
-            node->hash = dict_hash_multi(node->hash, ((struct lyd_node_leaf_list *)node)->value_str,
-                                        strlen(((struct lyd_node_leaf_list *)node)->value_str));
+            val_hash = lyd_value_hash(((struct lyd_node_leaf_list *)node)->value_str);
+            node->hash = dict_hash_multi(node->hash, (char *)&val_hash, sizeof val_hash);
         } else if (node->schema->nodetype == LYS_LIST) {
             if (((struct lys_node_list *)node->schema)->keys_size) {
                 for (i = 0, iter = node->child; i < ((struct lys_node_list *)node->schema)->keys_size; ++i, iter = iter->next) {
                     assert(iter);
-                    node->hash = dict_hash_multi(node->hash, ((struct lyd_node_leaf_list *)iter)->value_str,
-                                                 strlen(((struct lyd_node_leaf_list *)iter)->value_str));
+                    val_hash = lyd_value_hash(((struct lyd_node_leaf_list *)iter)->value_str);
+                    node->hash = dict_hash_multi(node->hash, (char *)&val_hash, sizeof val_hash);
                 }
             } else {
                 /* no-keys list */
@@ -407,11 +513,75 @@ lyd_keyless_list_hash_change(struct lyd_node *parent)
     }
 }
 
+/* create the children hash table of a parent without one if it has enough hashed children */
 static void
-_lyd_insert_hash(struct lyd_node *node, int keyless_list_check)
+lyd_hash_children(struct lyd_node *parent)
 {
     struct lyd_node *iter;
-    int i;
+    uint32_t i, size;
+
+    assert(!parent->ht);
+
+    for (i = 0, iter = parent->child; iter; ++i, iter = iter->next) {
+        if ((iter->schema->nodetype == LYS_LIST) && !lyd_list_has_keys(iter)) {
+            /* it will either never have keys and will never be hashed or has not all keys created yet */
+            --i;
+        }
+    }
+    if (i < LY_CACHE_HT_MIN_CHILDREN) {
+        return;
+    }
+
+    /* create hash table large enough for all the children, insert them */
+    for (size = LYHT_MIN_SIZE; (i * 100) / size >= LYHT_ENLARGE_PERCENTAGE; size <<= 1);
+    parent->ht = lyht_new(size, sizeof(struct lyd_node *), lyd_hash_table_val_equal, NULL, 1);
+    LY_TREE_FOR(parent->child, iter) {
+        if ((iter->schema->nodetype == LYS_LIST) && !lyd_list_has_keys(iter)) {
+            /* skip lists without keys */
+            continue;
+        }
+
+        if (lyht_insert(parent->ht, &iter, iter->hash, NULL)) {
+            assert(0);
+        }
+    }
+}
+
+void
+lyd_hash_siblings(struct lyd_node *first)
+{
+    struct lyd_node *iter;
+
+    LY_TREE_FOR(first, iter) {
+        if ((iter->schema->nodetype & (LYS_LIST | LYS_CONTAINER | LYS_RPC | LYS_ACTION | LYS_NOTIF)) && iter->child) {
+            lyd_hash_siblings(iter->child);
+            if (iter->ht) {
+                lyht_free(iter->ht);
+                iter->ht = NULL;
+            }
+            lyd_hash_children(iter);
+        }
+
+        /* lists with keys and key-less lists need their children hashed first */
+        lyd_hash(iter);
+    }
+}
+
+void
+lyd_hash_parent(struct lyd_node *parent)
+{
+    if (parent->ht) {
+        lyht_free(parent->ht);
+        parent->ht = NULL;
+    }
+    lyd_hash_children(parent);
+
+    lyd_hash(parent);
+}
+
+static void
+_lyd_insert_hash(struct lyd_node *node, int keyless_list_check)
+{
 
     if (node->parent) {
         if ((node->schema->nodetype != LYS_LIST) || lyd_list_has_keys(node)) {
@@ -425,27 +595,7 @@ _lyd_insert_hash(struct lyd_node *node, int keyless_list_check)
 
             /* create parent hash table if required, otherwise just add the new child */
             if (!node->parent->ht) {
-                for (i = 0, iter = node->parent->child; iter; ++i, iter = iter->next) {
-                    if ((iter->schema->nodetype == LYS_LIST) && !lyd_list_has_keys(iter)) {
-                        /* it will either never have keys and will never be hashed or has not all keys created yet */
-                        --i;
-                    }
-                }
-                assert(i <= LY_CACHE_HT_MIN_CHILDREN);
-                if (i == LY_CACHE_HT_MIN_CHILDREN) {
-                    /* create hash table, insert all the children */
-                    node->parent->ht = lyht_new(1, sizeof(struct lyd_node *), lyd_hash_table_val_equal, NULL, 1);
-                    LY_TREE_FOR(node->parent->child, iter) {
-                        if ((iter->schema->nodetype == LYS_LIST) && !lyd_list_has_keys(iter)) {
-                            /* skip lists without keys */
-                            continue;
-                        }
-
-                        if (lyht_insert(node->parent->ht, &iter, iter->hash, NULL)) {
-                            assert(0);
-                        }
-                    }
-                }
+                lyd_hash_children(node->parent);
             } else {
                 if (lyht_insert(node->parent->ht, &node, node->hash, NULL)) {
                     assert(0);
@@ -1294,6 +1444,208 @@ lyd_new_leaf(struct lyd_node *parent, const struct lys_module *module, const cha
     return _lyd_new_leaf(parent, snode, val_str, 0, 0);
 }
 
+API struct lyd_node *
+lyd_new_list_batch(struct lyd_node *parent, const struct lys_node *schema, const char **leaves, int leaf_count,
+                   const char **values, uint32_t count)
+{
+    FUN_IN;
+
+    struct ly_ctx *ctx;
+    const struct lys_node **sleaves = NULL, *siter, *sparent;
+    const struct lys_module *mod;
+    struct lys_node_list *slist;
+    struct lyd_node *first = NULL, *last = NULL, *list, *leaf, *lastch, *iter;
+    const char *name, *val;
+    size_t mod_len;
+    uint32_t u;
+    int i, list_when;
+
+    if (!schema || (schema->nodetype != LYS_LIST) || !count || (leaf_count < 0) || (leaf_count && (!leaves || !values))) {
+        LOGARG;
+        return NULL;
+    }
+    ctx = schema->module->ctx;
+    slist = (struct lys_node_list *)schema;
+
+    for (sparent = lys_parent(schema);
+         sparent && (sparent->nodetype & (LYS_USES | LYS_CHOICE | LYS_CASE | LYS_INPUT | LYS_OUTPUT));
+         sparent = lys_parent(sparent));
+    if (sparent != (parent ? parent->schema : NULL)) {
+        LOGERR(ctx, LY_EINVAL, "Cannot create \"%s\" instances, different parents (\"%s\" and \"%s\").", schema->name,
+               parent ? parent->schema->name : "<top-lvl>", sparent ? sparent->name : "<top-lvl>");
+        return NULL;
+    }
+    if (leaf_count < slist->keys_size) {
+        LOGERR(ctx, LY_EINVAL, "Missing keys of the \"%s\" instances.", schema->name);
+        return NULL;
+    }
+
+    /* resolve all the leaves only once */
+    if (leaf_count) {
+        sleaves = malloc(leaf_count * sizeof *sleaves);
+        LY_CHECK_ERR_RETURN(!sleaves, LOGMEM(ctx), NULL);
+    }
+    for (i = 0; i < leaf_count; ++i) {
+        name = strchr(leaves[i], ':');
+        if (name) {
+            mod_len = name - leaves[i];
+            ++name;
+        } else {
+            mod_len = 0;
+            name = leaves[i];
+        }
+
+        siter = NULL;
+        while ((siter = lys_getnext(siter, schema, NULL, 0))) {
+            if (!(siter->nodetype & (LYS_LEAF | LYS_LEAFLIST)) || strcmp(siter->name, name)) {
+                continue;
+            }
+            mod = lys_node_module(siter);
+            if (!mod_len || (!strncmp(mod->name, leaves[i], mod_len) && !mod->name[mod_len])) {
+                break;
+            }
+        }
+        if (!siter) {
+            LOGERR(ctx, LY_EINVAL, "Failed to find \"%s\" as a child of \"%s\".", leaves[i], schema->name);
+            goto error;
+        }
+        if ((i < slist->keys_size) ? (siter != (struct lys_node *)slist->keys[i])
+                : ((siter->nodetype == LYS_LEAF) && lys_is_key((struct lys_node_leaf *)siter, NULL))) {
+            LOGERR(ctx, LY_EINVAL, "Unexpected position of the key \"%s\" of \"%s\".", leaves[i], schema->name);
+            goto error;
+        }
+        sleaves[i] = siter;
+    }
+
+    /* create the instances, they are just chained together until all are created */
+    list_when = resolve_applies_when(schema, 0, NULL);
+    for (u = 0; u < count; ++u) {
+        list = calloc(1, sizeof *list);
+        LY_CHECK_ERR_GOTO(!list, LOGMEM(ctx), error);
+
+        list->schema = (struct lys_node *)schema;
+        list->validity = ly_new_node_validity(schema);
+        if (list_when) {
+            list->when_status = LYD_WHEN;
+        }
+        if (last) {
+            last->next = list;
+            list->prev = last;
+            first->prev = list;
+        } else {
+            list->prev = list;
+            first = list;
+        }
+        last = list;
+
+        lastch = NULL;
+        for (i = 0; i < leaf_count; ++i) {
+            val = values[(size_t)u * leaf_count + i];
+            if (!val) {
+                if (i < slist->keys_size) {
+                    LOGERR(ctx, LY_EINVAL, "Missing key \"%s\" of the \"%s\" instance %u.", sleaves[i]->name,
+                           schema->name, u);
+                    goto error;
+                }
+                continue;
+            }
+
+            leaf = lyd_create_leaf(sleaves[i], val, 0, 0);
+            if (!leaf) {
+                goto error;
+            }
+            leaf->parent = list;
+            if (lastch) {
+                lastch->next = leaf;
+                leaf->prev = lastch;
+                list->child->prev = leaf;
+            } else {
+                list->child = leaf;
+            }
+            lastch = leaf;
+        }
+
+#ifdef LY_ENABLED_CACHE
+        lyd_hash(list);
+        lyd_hash_children(list);
+#endif
+    }
+
+    /* connect them to the parent */
+    if (parent) {
+        if (parent->child) {
+            parent->child->prev->next = first;
+            first->prev = parent->child->prev;
+            parent->child->prev = last;
+        } else {
+            parent->child = first;
+        }
+        LY_TREE_FOR(first, iter) {
+            iter->parent = parent;
+        }
+    }
+
+    /* check all the instances for duplicates in a single pass */
+    if (slist->keys_size && lyv_data_dup(first, parent ? parent->child : first)) {
+        if (parent) {
+            /* disconnect them again, the previous instances still need to be checked */
+            if (parent->child == first) {
+                parent->child = NULL;
+            } else {
+                first->prev->next = NULL;
+                parent->child->prev = first->prev;
+                first->prev = last;
+                LY_TREE_FOR(parent->child, iter) {
+                    if (iter->schema == schema) {
+                        iter->validity |= LYD_VAL_DUP;
+                    }
+                }
+            }
+            LY_TREE_FOR(first, iter) {
+                iter->parent = NULL;
+            }
+        }
+        goto error;
+    }
+
+    if (parent) {
+#ifdef LY_ENABLED_CACHE
+        if (parent->ht) {
+            LY_TREE_FOR(first, iter) {
+                if (lyht_insert(parent->ht, &iter, iter->hash, NULL)) {
+                    assert(0);
+                }
+            }
+        } else {
+            lyd_hash_children(parent);
+        }
+        lyd_keyless_list_hash_change(parent);
+#endif
+
+        /* invalidate the parents the same way lyd_insert() does */
+        if (slist->max) {
+            parent->validity |= LYD_VAL_MAND;
+        } else {
+            for (iter = parent; iter; iter = iter->parent) {
+                if ((iter->schema->flags & LYS_VALID_EXT) && (iter->schema->flags & LYS_VALID_EXT_SUBTREE)) {
+                    iter->validity |= LYD_VAL_MAND;
+                }
+            }
+        }
+        for (iter = parent; iter && iter->dflt; iter = iter->parent) {
+            iter->dflt = 0;
+        }
+    }
+
+    free(sleaves);
+    return first;
+
+error:
+    lyd_free_withsiblings(first);
+    free(sleaves);
+    return NULL;
+}
+
 /**
  * @brief Update (add) default flag of the parents of the added node.
  *
@@ -1846,7 +2198,7 @@ lyd_new_path(struct lyd_node *data_tree, const struct ly_ctx *ctx, const char *p
     struct lyd_node *ret = NULL, *node, *parent = NULL;
     const struct lys_node *schild, *sparent, *tmp;
     const struct lys_node_list *slist;
-    const struct lys_module *module, *prev_mod;
+    const struct lys_module *module, *prev_mod, *node_mod;
     int r, i, parsed = 0, mod_name_len, nam_len, val_name_len, val_len;
     int is_relative = -1, has_predicate, first_iter = 1;
     int backup_is_relative, backup_mod_name_len, yang_data_name_len;
@@ -1989,9 +2341,15 @@ lyd_new_path(struct lyd_node *data_tree, const struct ly_ctx *ctx, const char *p
 
     /* create nodes in a loop */
     while (1) {
-        /* find the schema node */
+        /* find the schema node, try the schema node index first (RPC/action in/out nodes are never indexed) */
         schild = NULL;
-        while ((schild = lys_getnext(schild, sparent, module, 0))) {
+        r = -1;
+        node_mod = mod_name ? ly_ctx_nget_module(ctx, mod_name, mod_name_len, NULL, 1) : prev_mod;
+        if (node_mod) {
+            r = lys_node_idx_find(sparent, module, node_mod, NULL, name, nam_len, LYS_CONTAINER | LYS_LEAF | LYS_LEAFLIST
+                                  | LYS_LIST | LYS_ANYDATA | LYS_NOTIF | LYS_RPC | LYS_ACTION, 0, &schild);
+        }
+        while ((r == -1) && (schild = lys_getnext(schild, sparent, module, 0))) {
             if (schild->nodetype & (LYS_CONTAINER | LYS_LEAF | LYS_LEAFLIST | LYS_LIST
                                     | LYS_ANYDATA | LYS_NOTIF | LYS_RPC | LYS_ACTION)) {
                 /* module comparison */
@@ -2433,6 +2791,7 @@ lyd_merge_node_update(struct lyd_node *target, struct lyd_node *source, int opti
     struct ly_ctx *ctx;
     struct lyd_node_leaf_list *trg_leaf, *src_leaf;
     struct lyd_node_anydata *trg_any, *src_any;
+    struct lyd_node *parent;
     int len;
 
     assert(target->schema->nodetype & (LYS_LEAF | LYS_ANYDATA));
@@ -2443,6 +2802,14 @@ lyd_merge_node_update(struct lyd_node *target, struct lyd_node *source, int opti
         return;
     }
 
+    if ((target->schema->nodetype == LYS_LEAF) && (target->schema->flags & LYS_UNIQUE)) {
+        /* set unique validation flag for parent list */
+        for (parent = target->parent; parent && (parent->schema->nodetype != LYS_LIST); parent = parent->parent);
+        if (parent) {
+            parent->validity |= LYD_VAL_UNIQUE;
+        }
+    }
+
     if (ctx == source->schema->module->ctx) {
         /* source and targets are in the same context */
         if (target->schema->nodetype == LYS_LEAF) {
@@ -4112,23 +4479,22 @@ error:
     return NULL;
 }
 
+/**
+ * @brief Set #LYD_VAL_UNIQUE on the parent list if a unique leaf is being inserted or removed.
+ *
+ * @param[in] node Inserted or removed subtree, still connected to its parent.
+ */
 static void
-lyd_insert_setinvalid(struct lyd_node *node)
+lyd_unique_setinvalid(struct lyd_node *node)
 {
     struct lyd_node *next, *elem, *parent_list;
 
-    assert(node);
-
-    /* overall validity of the node itself */
-    node->validity = ly_new_node_validity(node->schema);
-
-    /* explore changed unique leaves */
     /* first, get know if there is a list in parents chain */
     for (parent_list = node->parent;
          parent_list && parent_list->schema->nodetype != LYS_LIST;
          parent_list = parent_list->parent);
     if (parent_list && !(parent_list->validity & LYD_VAL_UNIQUE)) {
-        /* there is a list, so check if we inserted a leaf supposed to be unique */
+        /* there is a list, so check if the subtree includes a leaf supposed to be unique */
         LY_TREE_DFS_BEGIN(node, next, elem) {
             if (elem->schema->nodetype == LYS_LIST) {
                 /* stop searching to the depth, children would be unique to a list in subtree */
@@ -4171,6 +4537,20 @@ nextsibling:
             }
         }
     }
+}
+
+static void
+lyd_insert_setinvalid(struct lyd_node *node)
+{
+    struct lyd_node *next;
+
+    assert(node);
+
+    /* overall validity of the node itself */
+    node->validity = ly_new_node_validity(node->schema);
+
+    /* explore changed unique leaves */
+    lyd_unique_setinvalid(node);
 
     if (node->parent) {
         /* if the inserted node is list/leaflist with constraint on max instances or extension validation callback,
@@ -5371,10 +5751,16 @@ lyd_unlink_internal(struct lyd_node *node, int permanent)
             node->parent->child = node->next;
         }
 
+        if (permanent != 2) {
+            /* removed unique leaf */
+            lyd_unique_setinvalid(node);
+        }
+
 #ifdef LY_ENABLED_CACHE
         /* do not remove from parent hash table if freeing the whole subtree */
         if (permanent != 2) {
             lyd_unlink_hash(node, node->parent);
+            lyv_unique_index_remove(node);
         }
 #endif
 
@@ -5442,7 +5828,7 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
     struct lys_node_leaf *sleaf;
     struct lyd_node_leaf_list *new_leaf;
     struct lyd_node_anydata *new_any, *old_any;
-    const struct lys_type *type;
+    const struct lys_type *type, *orig_type;
     int r;
 
     /* fill specific part */
@@ -5483,10 +5869,27 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
             break;
         case LY_TYPE_ENUM:
         case LY_TYPE_IDENT:
+            if (ctx == node->schema->module->ctx) {
+                /* the enum and identity are the same in the same context */
+                new_leaf->value = ((struct lyd_node_leaf_list *)node)->value;
+                break;
+            }
+            /* fallthrough */
         case LY_TYPE_BITS:
-            /* in case of duplicating bits (no matter if in the same context or not) or enum and identityref into
-             * a different context, searching for the type and duplicating the data is almost as same as resolving
-             * the string value, so due to a simplicity, parse the value for the duplicated leaf */
+            if ((new_leaf->value_type == LY_TYPE_BITS) && (ctx == node->schema->module->ctx)
+                    && (sleaf->type.base == LY_TYPE_BITS) && ((struct lyd_node_leaf_list *)node)->value.bit) {
+                /* copy the array of the set bits */
+                for (type = &sleaf->type; !type->info.bits.count; type = &type->der->type);
+                new_leaf->value.bit = malloc(type->info.bits.count * sizeof *new_leaf->value.bit);
+                LY_CHECK_ERR_GOTO(!new_leaf->value.bit, LOGMEM(ctx), error);
+                memcpy(new_leaf->value.bit, ((struct lyd_node_leaf_list *)node)->value.bit,
+                       type->info.bits.count * sizeof *new_leaf->value.bit);
+                break;
+            }
+
+            /* in case of duplicating bits in a union or enum and identityref into a different context, searching
+             * for the type and duplicating the data is almost as same as resolving the string value, so due to
+             * a simplicity, parse the value for the duplicated leaf */
             if (!lyp_parse_value(&sleaf->type, &new_leaf->value_str, NULL, new_leaf, NULL, NULL, 1, node->dflt)) {
                 goto error;
             }
@@ -5504,7 +5907,15 @@ _lyd_dup_node(const struct lyd_node *node, const struct lys_node *schema, struct
                 goto error;
             }
 
-            r = lytype_store(type->der->module, type->der->name, &new_leaf->value_str, &new_leaf->value);
+            /* get the original type, it is the same one in the same context */
+            orig_type = (ctx == node->schema->module->ctx) ? type : lyd_leaf_type((struct lyd_node_leaf_list *)node);
+            if (!orig_type || !orig_type->der || !orig_type->der->module) {
+                LOGINT(ctx);
+                goto error;
+            }
+
+            r = lytype_dup(orig_type->der, ((struct lyd_node_leaf_list *)node)->value, type->der, &new_leaf->value_str,
+                           &new_leaf->value);
             if (r == -1) {
                 goto error;
             } else if (r) {
@@ -5721,6 +6132,20 @@ lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx)
             break;
         }
 
+        if (!ctx) {
+            /* the same context, the whole subtree can be duplicated at once without inserting node by node */
+            if ((elem->schema->nodetype & (LYS_LIST | LYS_CONTAINER | LYS_RPC | LYS_ACTION | LYS_NOTIF)) && elem->child) {
+                if (!lyd_dup_withsiblings_r(elem->child, new_node, options, 0, log_ctx)) {
+                    goto error;
+                }
+#ifdef LY_ENABLED_CACHE
+                lyd_hash_children(new_node);
+                new_node->hash = elem->hash;
+#endif
+            }
+            break;
+        }
+
         /* LY_TREE_DFS_END */
         /* select element for the next run - children first,
          * child exception for lyd_node_leaf and lyd_node_leaflist */
@@ -5799,7 +6224,8 @@ lyd_dup(const struct lyd_node *node, int options)
 }
 
 static struct lyd_node *
-lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup, int options, struct ly_ctx *ctx)
+lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup, int options, int copy_flags,
+                       struct ly_ctx *ctx)
 {
     struct lyd_node *first_dup = NULL, *prev_dup = NULL, *last_dup;
     const struct lyd_node *next;
@@ -5813,9 +6239,11 @@ lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup
             goto error;
         }
 
-        /* the whole data tree is exactly the same so we can safely copy the validation flags */
-        last_dup->validity = next->validity;
-        last_dup->when_status = next->when_status;
+        if (copy_flags) {
+            /* the whole data tree is exactly the same so we can safely copy the validation flags */
+            last_dup->validity = next->validity;
+            last_dup->when_status = next->when_status;
+        }
 
         last_dup->parent = parent_dup;
         /* connect to the parent or the siblings */
@@ -5829,25 +6257,23 @@ lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup
             prev_dup->next = last_dup;
             last_dup->prev = prev_dup;
         }
-
-#ifdef LY_ENABLED_CACHE
-        /* copy hash */
-        if ((last_dup->schema->nodetype != LYS_LIST) || lyd_list_has_keys(last_dup)) {
-            last_dup->hash = next->hash;
-        }
-
-        /* insert into parent */
-        lyd_insert_hash(last_dup);
-#endif
+        prev_dup = last_dup;
 
         if ((next->schema->nodetype & (LYS_LIST | LYS_CONTAINER | LYS_RPC | LYS_ACTION | LYS_NOTIF)) && next->child) {
             /* recursively duplicate all children */
-            if (!lyd_dup_withsiblings_r(next->child, last_dup, options, ctx)) {
+            if (!lyd_dup_withsiblings_r(next->child, last_dup, options, copy_flags, ctx)) {
                 goto error;
             }
+#ifdef LY_ENABLED_CACHE
+            /* all the children are hashed, create their hash table at once */
+            lyd_hash_children(last_dup);
+#endif
         }
 
-        prev_dup = last_dup;
+#ifdef LY_ENABLED_CACHE
+        /* copy hash, the whole subtree is the same (including list keys) */
+        last_dup->hash = next->hash;
+#endif
     }
 
     /* correctly set last sibling */
@@ -5857,10 +6283,12 @@ lyd_dup_withsiblings_r(const struct lyd_node *first, struct lyd_node *parent_dup
     return first_dup;
 
 error:
-    /* disconnect and free */
     if (first_dup) {
-        first_dup->parent = NULL;
-        lyd_free_withsiblings(first_dup);
+        first_dup->prev = prev_dup;
+        if (!parent_dup) {
+            /* free, otherwise they are freed with the parent */
+            lyd_free_withsiblings(first_dup);
+        }
     }
     return NULL;
 }
@@ -5904,7 +6332,7 @@ lyd_dup_withsiblings_to_ctx(const struct lyd_node *node, int options, struct ly_
         }
     } else {
         /* duplicating top-level siblings, we can duplicate much more efficiently */
-        ret = lyd_dup_withsiblings_r(node, NULL, options, ctx);
+        ret = lyd_dup_withsiblings_r(node, NULL, options, 1, ctx);
     }
 
     return ret;
@@ -6129,6 +6557,7 @@ _lyd_free_node(struct lyd_node *node)
 #ifdef LY_ENABLED_CACHE
         /* it should be empty because all the children are freed already (only if in debug mode) */
         lyht_free(node->ht);
+        lyv_unique_index_free(node);
 #endif
         break;
     case LYS_ANYDATA:
@@ -6860,8 +7289,6 @@ lyd_find_sibling_val(const struct lyd_node *siblings, const struct lys_node *sch
     /* create data node */
     switch (schema->nodetype) {
     case LYS_CONTAINER:
-    case LYS_ANYXML:
-    case LYS_ANYDATA:
     case LYS_NOTIF:
     case LYS_RPC:
     case LYS_ACTION:
@@ -6869,6 +7296,12 @@ lyd_find_sibling_val(const struct lyd_node *siblings, const struct lys_node *sch
         target = _lyd_new(NULL, schema, 0);
         LY_CHECK_RETURN(!target, -1);
         break;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        /* used attributes: schema, hash */
+        target = lyd_create_anydata(NULL, schema, NULL, LYD_ANYDATA_CONSTSTRING);
+        LY_CHECK_RETURN(!target, -1);
+        break;
     case LYS_LEAF:
         /* used attributes: schema, hash */
         target = lyd_create_leaf(schema, NULL, 0, 1);
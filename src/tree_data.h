@@ -537,6 +537,11 @@ char *lyd_path(const struct lyd_node *node);
 #define LYD_OPT_VAL_DIFF 0x40000 /**< Flag only for validation, store all the data node changes performed by the validation
                                       in a diff structure. */
 #define LYD_OPT_LYB_MOD_UPDATE 0x80000 /**< Allow to parse data using an updated revision of a module, relevant only for LYB format. */
+#define LYD_OPT_LYB_THREADS 0x100000 /**< Parse the data in several threads, one per online CPU. Top-level subtrees are
+                                          parsed in parallel, the list instances in large top-level subtrees as well if
+                                          the data include an index (#LYP_LYB_INDEX). The subtrees are then linked in their
+                                          original order and validated once. Relevant only for LYB format, ignored if
+                                          a module data callback is set in the context. */
 #define LYD_OPT_DATA_TEMPLATE 0x1000000 /**< Data represents YANG data template. */
 
 /**@} parseroptions */
@@ -734,6 +739,30 @@ struct lyd_node *lyd_new(struct lyd_node *parent, const struct lys_module *modul
 struct lyd_node *lyd_new_leaf(struct lyd_node *parent, const struct lys_module *module, const char *name,
                               const char *val_str);
 
+/**
+ * @brief Create many instances of a list in a data tree at once.
+ *
+ * __PARTIAL CHANGE__ - validate after the final change on the data tree (see @ref howtodatamanipulators).
+ *
+ * The child leaves are resolved only once for all the instances, the instances are appended after the
+ * existing children of \p parent and the duplicate instances are checked in a single pass at the end.
+ * No other node than the instances and their leaves is created or removed (unlike in lyd_insert(),
+ * nodes from other cases of a choice are not deleted).
+ *
+ * @param[in] parent Parent node for the instances being created. NULL in case of creating top level instances,
+ * they are then returned as siblings and the duplicates are checked only among them.
+ * @param[in] schema Schema node of the list.
+ * @param[in] leaves Names of the leaves or leaf-lists (children of \p schema) created in every instance, optionally
+ * prefixed with their module name ("module:name"). The list keys must come first in the order they are defined in.
+ * @param[in] leaf_count Number of items in \p leaves.
+ * @param[in] values String values of the leaves, \p leaf_count values for each instance. The values are interpreted
+ * the same way as in lyd_new_leaf(), NULL value of a non-key leaf means the leaf is not created in the instance.
+ * @param[in] count Number of instances to create.
+ * @return First new instance, NULL on error (no instance is created then).
+ */
+struct lyd_node *lyd_new_list_batch(struct lyd_node *parent, const struct lys_node *schema, const char **leaves,
+                                    int leaf_count, const char **values, uint32_t count);
+
 /**
  * @brief Change value of a leaf node.
  *
@@ -1280,6 +1309,71 @@ int lyd_validate_modules(struct lyd_node **node, const struct lys_module **modul
  */
 void lyd_free_val_diff(struct lyd_difflist *diff);
 
+/**
+ * @defgroup vmetrics Validation metrics
+ * @ingroup datatree
+ *
+ * Opt-in statistics about the cost of the individual constraints evaluated during data validation,
+ * accumulated per context. They are meant for finding the constraints (must and when conditions, leafrefs,
+ * and unique statements) that make the validation of some data slow.
+ *
+ * @{
+ */
+
+/**
+ * @brief Types of the constraints measured by the validation metrics.
+ */
+typedef enum {
+    LYD_VMETRIC_MUST,       /**< must condition */
+    LYD_VMETRIC_WHEN,       /**< when condition */
+    LYD_VMETRIC_LEAFREF,    /**< leafref path */
+    LYD_VMETRIC_UNIQUE      /**< all the unique statements of a list */
+} LYD_VMETRIC_TYPE;
+
+/**
+ * @brief Validation metrics of a single constraint.
+ */
+struct lyd_vmetric {
+    LYD_VMETRIC_TYPE type;  /**< constraint type */
+    const char *path;       /**< schema path of the node with the constraint */
+    const char *expr;       /**< must or when condition, leafref path, NULL for unique */
+    uint32_t count;         /**< number of evaluations of the constraint */
+    uint64_t time;          /**< cumulative time of the evaluations in nanoseconds */
+};
+
+/**
+ * @brief Enable or disable collecting validation metrics in a context. Disabling them also discards
+ * all the collected metrics.
+ *
+ * The metrics are collected in a thread-safe manner, but this function must not be called while some data
+ * of \p ctx are being validated.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] enable Non-zero to enable the metrics, zero to disable them.
+ * @return 0 on success, non-zero on error.
+ */
+int lyd_vmetrics_enable(struct ly_ctx *ctx, int enable);
+
+/**
+ * @brief Get the validation metrics collected so far, ordered by their cumulative time, the most expensive
+ * constraints first.
+ *
+ * @param[in] ctx Context to use.
+ * @param[out] count Number of the returned metrics.
+ * @return Array of the metrics to be freed by the caller, NULL if there are none or on error. The strings in it
+ * are valid until the metrics are reset or disabled.
+ */
+struct lyd_vmetric *lyd_vmetrics_get(struct ly_ctx *ctx, uint32_t *count);
+
+/**
+ * @brief Discard all the validation metrics collected so far, they stay enabled.
+ *
+ * @param[in] ctx Context to use.
+ */
+void lyd_vmetrics_reset(struct ly_ctx *ctx);
+
+/**@} vmetrics */
+
 /**
  * @brief Check restrictions applicable to the particular leaf/leaf-list on the given string value.
  *
@@ -1430,7 +1524,8 @@ const struct lys_type *lyd_leaf_type(const struct lyd_node_leaf_list *leaf);
 * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
 * node of the data tree to print the specific subtree.
 * @param[in] format Data output format.
-* @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+* @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS,
+ *                    #LYP_LYB_INDEX, and #LYP_LYB_COMPACT options.
 * @return 0 on success, 1 on failure (#ly_errno is set).
 */
 int lyd_print_mem(char **strp, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1442,7 +1537,8 @@ int lyd_print_mem(char **strp, const struct lyd_node *root, LYD_FORMAT format, i
  * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
  * node of the data tree to print the specific subtree.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS,
+ *                    #LYP_LYB_INDEX, and #LYP_LYB_COMPACT options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1454,7 +1550,8 @@ int lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, int opt
  * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
  * node of the data tree to print the specific subtree.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS,
+ *                    #LYP_LYB_INDEX, and #LYP_LYB_COMPACT options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_file(FILE *f, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1466,7 +1563,8 @@ int lyd_print_file(FILE *f, const struct lyd_node *root, LYD_FORMAT format, int
  * @param[in] root Root node of the data tree to print. It can be actually any (not only real root)
  * node of the data tree to print the specific subtree.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS,
+ *                    #LYP_LYB_INDEX, and #LYP_LYB_COMPACT options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_path(const char *path, const struct lyd_node *root, LYD_FORMAT format, int options);
@@ -1479,7 +1577,8 @@ int lyd_print_path(const char *path, const struct lyd_node *root, LYD_FORMAT for
  * node of the data tree to print the specific subtree.
  * @param[in] arg Optional caller-specific argument to be passed to the \p writeclb callback.
  * @param[in] format Data output format.
- * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS option.
+ * @param[in] options [printer flags](@ref printerflags). \p format LYD_LYB accepts only #LYP_WITHSIBLINGS,
+ *                    #LYP_LYB_INDEX, and #LYP_LYB_COMPACT options.
  * @return 0 on success, 1 on failure (#ly_errno is set).
  */
 int lyd_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), void *arg,
@@ -1504,6 +1603,51 @@ double lyd_dec64_to_double(const struct lyd_node *node);
  */
 int lyd_lyb_data_length(const char *data);
 
+/**
+ * @brief Parse only the subtree with a specific path from LYB data printed with #LYP_LYB_INDEX.
+ *
+ * The index is used to find the subtree without parsing the data before it. Indexed are the top-level
+ * subtrees and the list instances that are children of top-level nodes. The smallest indexed subtree
+ * containing the node identified by \p path is parsed, with only the node itself and its keys, if any,
+ * created for its top-level parent. The returned data tree is not validated.
+ *
+ * @param[in] ctx Context with the schemas of the data.
+ * @param[in] data LYB data.
+ * @param[in] data_len Length of \p data including the index.
+ * @param[in] options [Parser options](@ref parseroptions), the data type is required.
+ * @param[in] path Simple data path of a single data node (as for lyd_new_path()), with all the list keys.
+ * @return Top-level node of the parsed subtree, NULL if not found or on error.
+ */
+struct lyd_node *lyd_lyb_parse_subtree(struct ly_ctx *ctx, const char *data, size_t data_len, int options,
+                                       const char *path);
+
+/**
+ * @brief Print the result of lyd_diff() as a LYB change set into a memory block allocated inside the function.
+ *
+ * Each difference is stored with its type and the data paths (lyd_path()) of the nodes it refers to. Created nodes
+ * and new values of changed nodes are stored whole, in the LYB encoding. The change set can be applied to another
+ * instance of the first tree with lyd_lyb_apply_diff().
+ *
+ * @param[out] strp Pointer to store the resulting data. The caller is responsible for freeing it.
+ * @param[in] diff Differences of two data trees from lyd_diff().
+ * @return 0 on success, 1 on failure (#ly_errno is set).
+ */
+int lyd_lyb_print_diff(char **strp, const struct lyd_difflist *diff);
+
+/**
+ * @brief Apply a LYB change set printed by lyd_lyb_print_diff() to a data tree.
+ *
+ * The changes are applied in place and in their order, the nodes are found by their paths. On error, the changes
+ * applied so far are kept. The resulting data tree is not validated.
+ *
+ * @param[in,out] root Data tree to change, may be changed to another top-level sibling or to NULL.
+ * @param[in] ctx Context with the schemas of the data, needed only if \p root points to NULL.
+ * @param[in] data LYB change set.
+ * @param[in] options [Parser options](@ref parseroptions), the data type is required.
+ * @return 0 on success, 1 on failure (#ly_errno is set).
+ */
+int lyd_lyb_apply_diff(struct lyd_node **root, struct ly_ctx *ctx, const char *data, int options);
+
 #ifdef LY_ENABLED_LYD_PRIV
 
 /**
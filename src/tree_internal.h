@@ -64,6 +64,17 @@ struct lyd_node_pos {
     uint32_t pos;
 };
 
+/**
+ * @brief LYB index entry of a top-level subtree or of a list instance that is a child of a top-level node.
+ */
+struct lyb_index_entry {
+    uint64_t offset;            /* subtree offset from the start of the LYB data */
+    uint32_t parent;            /* index of the parent entry, #LYB_INDEX_TOP for top-level subtrees */
+    uint32_t hash;              /* lyb_index_hash() of the subtree root */
+    uint8_t parent_written;     /* data written into the current parent chunk before the subtree */
+    uint8_t parent_inner;       /* inner chunks started in the current parent chunk before the subtree */
+};
+
 /**
  * @brief Internal structure for LYB parser/printer.
  */
@@ -76,13 +87,19 @@ struct lyb_state {
     const struct lys_module **models;
     int mod_count;
     struct ly_ctx *ctx;
+    uint8_t flags;                  /* LYB header flags */
 
     /* LYB printer only */
-    struct {
-        struct lys_node *first_sibling;
-        struct hash_table *ht;
-    } *sib_ht;
-    int sib_ht_count;
+    struct hash_table *sib_ht;      /* sibling hash tables (struct lyb_sib_ht) keyed by the first sibling */
+    struct lyb_index_entry *index;  /* index entries, if printing the index */
+    uint32_t index_count;
+    uint32_t index_size;
+    struct hash_table *str_ht;      /* string table records (struct lyb_str_rec) keyed by the dictionary string */
+
+    /* LYB parser only */
+    struct hash_table *sib_lookup;  /* schema children lookups (struct lyb_sib_lookup *) keyed by the parent */
+    struct lyb_str *strs;           /* string table */
+    uint32_t str_count;
 };
 
 /* struct lyb_state allocation step */
@@ -129,10 +146,55 @@ struct lyb_state {
 /* Type large enough for all meta data */
 #define LYB_META uint16_t
 
+/* Header flag, the data are followed by an index of subtrees */
+#define LYB_HEADER_INDEX 0x01
+
+/* Header flag, the models are followed by a table of repeated strings and numbers are variable-length */
+#define LYB_HEADER_COMPACT 0x02
+
+/* Header flag, the subtrees are changes of a data tree (type, path, optional anchor path and node) */
+#define LYB_HEADER_DIFF 0x04
+
+/* All the known header flags, data with any other flag set are of an unsupported format */
+#define LYB_HEADER_MASK (LYB_HEADER_INDEX | LYB_HEADER_COMPACT | LYB_HEADER_DIFF)
+
+/* Value types stored as variable-length numbers in compact LYB data */
+#define LYB_COMPACT_NUMBER(type) (((type) == LY_TYPE_INT16) || ((type) == LY_TYPE_UINT16) || ((type) == LY_TYPE_INT32) \
+        || ((type) == LY_TYPE_UINT32) || ((type) == LY_TYPE_INT64) || ((type) == LY_TYPE_UINT64) || ((type) == LY_TYPE_DEC64))
+
+/* Maximum bytes of a variable-length number */
+#define LYB_VARINT_MAX_BYTES 10
+
+/* Size of one serialized index entry (offset, parent, hash, parent written, parent inner chunks) */
+#define LYB_INDEX_ENTRY_BYTES 18
+
+/* Index entry parent of top-level subtrees */
+#define LYB_INDEX_TOP UINT32_MAX
+
+/* Index entry allocation step */
+#define LYB_INDEX_STEP 64
+
 LYB_HASH lyb_hash(struct lys_node *sibling, uint8_t collision_id);
 
 int lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **models, int mod_count);
 
+/**
+ * @brief Hash of a data node identifying it in the LYB index.
+ *
+ * Covers the module and the node name and also the key values of a list or the value of a leaf-list.
+ *
+ * @param[in] node Data node to hash.
+ * @return Node hash.
+ */
+uint32_t lyb_index_hash(const struct lyd_node *node);
+
+/**
+ * @brief Set the number of threads parsing LYB data with #LYD_OPT_LYB_THREADS, for testing.
+ *
+ * @param[in] count Number of threads, 0 to use one thread per online CPU (the default).
+ */
+void lyb_set_thread_count(uint32_t count);
+
 /**
  * Macros to work with ::lyd_node#when_status
  * +--- bit 1 - some when-stmt connected with the node (resolve_applies_when() is true)
@@ -165,6 +227,23 @@ int lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **mod
     void lyd_insert_hash(struct lyd_node *node);
 
     void lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent);
+
+/**
+ * @brief Hash all the nodes of subtrees built without hashing them one by one (bulk load).
+ *
+ * Every node is hashed after its children and every children hash table is (re)created
+ * only once with the size matching the final number of children.
+ *
+ * @param[in] first First sibling of the subtrees.
+ */
+    void lyd_hash_siblings(struct lyd_node *first);
+
+/**
+ * @brief Hash a node whose children were all already hashed and (re)create its children hash table.
+ *
+ * @param[in] parent Node to hash.
+ */
+    void lyd_hash_parent(struct lyd_node *parent);
 #endif
 
 /**
@@ -483,6 +562,64 @@ int lys_get_sibling(const struct lys_node *siblings, const char *mod_name, int m
 int lys_getnext_data(const struct lys_module *mod, const struct lys_node *parent, const char *name, int nam_len,
                      LYS_NODE type, int getnext_opts, const struct lys_node **ret);
 
+/**
+ * @brief Find a data node (instantiable in the data tree) using the schema node index. The index is built
+ * lazily for every schema parent (container, list, notification, input, output) or module (top-level nodes)
+ * with enough data children and is invalidated on every schema tree change (augments, deviations, ...).
+ * Does not log.
+ *
+ * @param[in] parent Schema parent of the node, NULL for top-level nodes.
+ * @param[in] module Module of top-level nodes, ignored if \p parent is set.
+ * @param[in] node_mod Main module of the node, NULL for any.
+ * @param[in] node_ns Namespace (dictionary string) of the node module, NULL for any.
+ * @param[in] name Node name.
+ * @param[in] nam_len Node \p name length.
+ * @param[in] type ORed desired type of the node. 0 means any (data node) type.
+ * @param[in] options lys_getnext() options, only #LYS_GETNEXT_NOSTATECHECK is supported.
+ * @param[out] ret Found node.
+ * @return 0 on success, 1 if there is no such node, -1 if the index cannot be used and lys_getnext() must be.
+ */
+int lys_node_idx_find(const struct lys_node *parent, const struct lys_module *module, const struct lys_module *node_mod,
+                      const char *node_ns, const char *name, int nam_len, LYS_NODE type, int options,
+                      const struct lys_node **ret);
+
+/**
+ * @brief Invalidate the schema node index of a context, must be called on every schema tree change.
+ *
+ * @param[in] ctx Context with the index.
+ */
+void lys_node_idx_clear(struct ly_ctx *ctx);
+
+/**
+ * @brief Add a module into the module index of its context. Does nothing without the cache.
+ *
+ * @param[in] module Module being added into the context.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int ly_ctx_mod_idx_add(struct lys_module *module);
+
+/**
+ * @brief Remove a module from the module index of its context, if it is there. Does nothing without the cache.
+ *
+ * @param[in] module Module being freed.
+ */
+void ly_ctx_mod_idx_remove(struct lys_module *module);
+
+/**
+ * @brief Iterate over the modules (including disabled ones) with a name or namespace using the module index.
+ * The order of the modules is arbitrary.
+ *
+ * @param[in] ctx Context with the modules.
+ * @param[in] key Module name or namespace.
+ * @param[in] key_len Length of \p key, 0 if it is terminated.
+ * @param[in] by_ns Whether \p key is the namespace.
+ * @param[in,out] module Previously returned module, NULL to get the first one. Set to the next module.
+ * @return 0 if a module was returned, 1 if there are no more modules, -1 if there is no index and the caller
+ * must search the modules itself.
+ */
+int ly_ctx_mod_idx_next(const struct ly_ctx *ctx, const char *key, size_t key_len, int by_ns,
+                        struct lys_module **module);
+
 int lyd_get_unique_default(const char* unique_expr, struct lyd_node *list, const char **dflt);
 
 int lyd_build_relative_data_path(const struct lys_module *module, const struct lyd_node *node, const char *schema_id,
@@ -493,6 +630,22 @@ void lyd_free_value(lyd_val value, LY_DATA_TYPE value_type, uint8_t value_flags,
 
 int lyd_list_equal(struct lyd_node *node1, struct lyd_node *node2, int with_defaults);
 
+/**
+ * @brief Get the type describing the typed value of a leaf, if it can be used directly.
+ *
+ * @param[in] leaf Leaf or leaf-list node.
+ * @return Type of the value, NULL if the value is a union member, leafref, user type, or unresolved.
+ */
+struct lys_type *lyd_leaf_type_typed(const struct lyd_node_leaf_list *leaf);
+
+/**
+ * @brief Get hash of a canonical value string.
+ *
+ * @param[in] value_str Canonical value.
+ * @return Value hash.
+ */
+uint32_t lyd_value_hash(const char *value_str);
+
 int lys_make_implemented_r(struct lys_module *module, struct unres_schema *unres);
 
 /**
@@ -223,11 +223,266 @@ lys_get_sibling(const struct lys_node *siblings, const char *mod_name, int mod_n
     return EXIT_FAILURE;
 }
 
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Record of the schema node index. Every indexed scope has one scope record (with no name),
+ * every data node in the scope has its own node record.
+ */
+struct lys_node_idx_rec {
+    const void *scope;           /* schema parent or module of top-level nodes */
+    const char *name;            /* node name, NULL for the scope record */
+    uint16_t nam_len;            /* length of name */
+    uint8_t indexed;             /* scope record only, whether the scope nodes are in the index */
+    const struct lys_node *node; /* indexed node, NULL for the scope record */
+};
+
+static int
+lys_node_idx_equal(void *val1_p, void *val2_p, int mod, void *UNUSED(cb_data))
+{
+    struct lys_node_idx_rec *rec1, *rec2;
+
+    rec1 = (struct lys_node_idx_rec *)val1_p;
+    rec2 = (struct lys_node_idx_rec *)val2_p;
+
+    if (rec1->scope != rec2->scope) {
+        return 0;
+    }
+    if (!rec1->name || !rec2->name) {
+        return rec1->name == rec2->name;
+    }
+    if ((rec1->nam_len != rec2->nam_len) || strncmp(rec1->name, rec2->name, rec1->nam_len)) {
+        return 0;
+    }
+    if (mod && (rec1->node != rec2->node)) {
+        return 0;
+    }
+    return 1;
+}
+
+static uint32_t
+lys_node_idx_hash(const void *scope, const char *name, uint16_t nam_len)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&scope, sizeof scope);
+    if (name) {
+        hash = dict_hash_multi(hash, name, nam_len);
+    }
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Add all the data nodes of a scope into the schema node index. Scopes with only a few
+ * nodes or with several nodes of the same name and module are only marked as not indexed.
+ *
+ * @param[in] ht Schema node index.
+ * @param[in] parent Schema parent, NULL for top-level nodes.
+ * @param[in] module Module of top-level nodes.
+ * @param[out] scope_rec Stored scope record.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lys_node_idx_build(struct hash_table *ht, const struct lys_node *parent, const struct lys_module *module,
+                   struct lys_node_idx_rec **scope_rec)
+{
+    const struct lys_node *node;
+    struct lys_node_idx_rec rec, *match;
+    struct ly_set *set;
+    unsigned int i;
+    uint32_t hash;
+    int r, indexed = 1;
+
+    set = ly_set_new();
+    LY_CHECK_ERR_RETURN(!set, LOGMEM(module ? module->ctx : parent->module->ctx), EXIT_FAILURE);
+
+    node = NULL;
+    while ((node = lys_getnext(node, parent, module, LYS_GETNEXT_NOSTATECHECK))) {
+        ly_set_add(set, (void *)node, LY_SET_OPT_USEASLIST);
+    }
+    if (set->number < LY_CACHE_HT_MIN_CHILDREN) {
+        indexed = 0;
+    }
+
+    for (i = 0; indexed && (i < set->number); ++i) {
+        node = set->set.s[i];
+        rec.scope = parent ? (void *)parent : (void *)module;
+        rec.name = node->name;
+        rec.nam_len = strlen(node->name);
+        rec.indexed = 0;
+        rec.node = node;
+        hash = lys_node_idx_hash(rec.scope, rec.name, rec.nam_len);
+
+        /* there must not be 2 nodes with the same name from the same module (input and output nodes) */
+        r = lyht_find(ht, &rec, hash, (void **)&match);
+        while (!r) {
+            if (lys_node_module(match->node) == lys_node_module(node)) {
+                indexed = 0;
+                break;
+            }
+            r = lyht_find_next(ht, match, hash, (void **)&match);
+        }
+        if (indexed && (lyht_insert(ht, &rec, hash, NULL) == -1)) {
+            ly_set_free(set);
+            return EXIT_FAILURE;
+        }
+    }
+    /* the already inserted node records of a scope that is not indexed are never searched, they are not removed
+     * because lyht_find() on a table with removed records moves them, which is not allowed with a shared lock */
+    ly_set_free(set);
+
+    /* scope record */
+    rec.scope = parent ? (void *)parent : (void *)module;
+    rec.name = NULL;
+    rec.nam_len = 0;
+    rec.indexed = indexed;
+    rec.node = NULL;
+    if (lyht_insert(ht, &rec, lys_node_idx_hash(rec.scope, NULL, 0), (void **)scope_rec) == -1) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Check whether lys_getnext() would skip a node found in the index because of its if-features
+ * or the if-features of its schema-only parents.
+ */
+static int
+lys_node_idx_disabled(const struct lys_node *node, const struct lys_node *parent)
+{
+    while (node && (node != parent)) {
+        if ((node->nodetype != LYS_AUGMENT) && lys_is_disabled(node, 0)) {
+            return 1;
+        }
+        node = (node->nodetype == LYS_AUGMENT) ? ((struct lys_node_augment *)node)->target : node->parent;
+    }
+    return 0;
+}
+
+void
+lys_node_idx_clear(struct ly_ctx *ctx)
+{
+    /* schema changes are not thread-safe, so a quick check is fine */
+    if (!ctx || !ctx->snode_idx) {
+        return;
+    }
+
+    pthread_rwlock_wrlock(&ctx->snode_idx_lock);
+    lyht_free(ctx->snode_idx);
+    ctx->snode_idx = NULL;
+    pthread_rwlock_unlock(&ctx->snode_idx_lock);
+}
+
+int
+lys_node_idx_find(const struct lys_node *parent, const struct lys_module *module, const struct lys_module *node_mod,
+                  const char *node_ns, const char *name, int nam_len, LYS_NODE type, int options,
+                  const struct lys_node **ret)
+{
+    struct ly_ctx *ctx;
+    struct lys_node_idx_rec rec, *match;
+    uint32_t hash;
+    int r;
+
+    assert((parent || module) && name && ret);
+    *ret = NULL;
+
+    if (parent) {
+        if (!(parent->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_NOTIF | LYS_INPUT | LYS_OUTPUT))) {
+            /* not an indexed scope */
+            return -1;
+        }
+        ctx = parent->module->ctx;
+        rec.scope = parent;
+    } else {
+        if (module->type) {
+            return -1;
+        }
+        if (!(options & LYS_GETNEXT_NOSTATECHECK) && (module->disabled || !module->implemented)) {
+            /* no nodes from a disabled/imported module */
+            return 1;
+        }
+        ctx = module->ctx;
+        rec.scope = module;
+    }
+    if ((nam_len < 1) || (nam_len > UINT16_MAX)) {
+        return 1;
+    }
+
+    /* find the scope record, the index is only read so concurrent lookups can share the lock */
+    rec.name = NULL;
+    rec.nam_len = 0;
+    rec.node = NULL;
+    pthread_rwlock_rdlock(&ctx->snode_idx_lock);
+    if (!ctx->snode_idx || lyht_find(ctx->snode_idx, &rec, lys_node_idx_hash(rec.scope, NULL, 0), (void **)&match)) {
+        /* build it on the first use, exclusively */
+        pthread_rwlock_unlock(&ctx->snode_idx_lock);
+        pthread_rwlock_wrlock(&ctx->snode_idx_lock);
+        if (!ctx->snode_idx) {
+            ctx->snode_idx = lyht_new(1024, sizeof rec, lys_node_idx_equal, NULL, 1);
+            LY_CHECK_ERR_GOTO(!ctx->snode_idx, LOGMEM(ctx), error);
+        }
+        if (lyht_find(ctx->snode_idx, &rec, lys_node_idx_hash(rec.scope, NULL, 0), (void **)&match)
+                && lys_node_idx_build(ctx->snode_idx, parent, module, &match)) {
+            goto error;
+        }
+    }
+    if (!match->indexed) {
+        pthread_rwlock_unlock(&ctx->snode_idx_lock);
+        return -1;
+    }
+
+    /* find the node itself */
+    rec.name = name;
+    rec.nam_len = nam_len;
+    hash = lys_node_idx_hash(rec.scope, name, nam_len);
+    r = lyht_find(ctx->snode_idx, &rec, hash, (void **)&match);
+    while (!r) {
+        if ((!node_mod || (lys_node_module(match->node) == node_mod))
+                && (!node_ns || ly_strequal(lys_node_module(match->node)->ns, node_ns, 1))) {
+            if (!type || (match->node->nodetype & type)) {
+                *ret = match->node;
+            }
+            break;
+        }
+        r = lyht_find_next(ctx->snode_idx, match, hash, (void **)&match);
+    }
+
+    pthread_rwlock_unlock(&ctx->snode_idx_lock);
+
+    if (*ret && !(options & LYS_GETNEXT_NOSTATECHECK) && lys_node_idx_disabled(*ret, parent)) {
+        *ret = NULL;
+    }
+    return *ret ? 0 : 1;
+
+error:
+    pthread_rwlock_unlock(&ctx->snode_idx_lock);
+    return -1;
+}
+
+#else
+
+void
+lys_node_idx_clear(struct ly_ctx *UNUSED(ctx))
+{
+    return;
+}
+
+int
+lys_node_idx_find(const struct lys_node *UNUSED(parent), const struct lys_module *UNUSED(module),
+                  const struct lys_module *UNUSED(node_mod), const char *UNUSED(node_ns), const char *UNUSED(name),
+                  int UNUSED(nam_len), LYS_NODE UNUSED(type), int UNUSED(options), const struct lys_node **UNUSED(ret))
+{
+    return -1;
+}
+
+#endif
+
 int
 lys_getnext_data(const struct lys_module *mod, const struct lys_node *parent, const char *name, int nam_len,
                  LYS_NODE type, int getnext_opts, const struct lys_node **ret)
 {
     const struct lys_node *node;
+    int r;
 
     assert((mod || parent) && name);
     assert(!(type & (LYS_AUGMENT | LYS_USES | LYS_GROUPING | LYS_CHOICE | LYS_CASE | LYS_INPUT | LYS_OUTPUT)));
@@ -236,6 +491,17 @@ lys_getnext_data(const struct lys_module *mod, const struct lys_node *parent, co
         mod = lys_node_module(parent);
     }
 
+    if (!(getnext_opts & ~LYS_GETNEXT_NOSTATECHECK)) {
+        /* use the schema node index, if possible */
+        r = lys_node_idx_find(parent, mod, lys_main_module(mod), NULL, name, nam_len, type, getnext_opts, &node);
+        if (r > -1) {
+            if (!r && ret) {
+                *ret = node;
+            }
+            return r ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    }
+
     /* try to find the node */
     node = NULL;
     while ((node = lys_getnext(node, parent, mod, getnext_opts))) {
@@ -428,6 +694,8 @@ lys_node_unlink(struct lys_node *node)
 
     /* unlink from data model if necessary */
     if (node->module) {
+        lys_node_idx_clear(node->module->ctx);
+
         /* get main module with data tree */
         main_module = lys_node_module(node);
         if (main_module->data == node) {
@@ -782,6 +1050,8 @@ lys_node_addchild(struct lys_node *parent, struct lys_module *module, struct lys
 
     assert(child);
 
+    lys_node_idx_clear(ctx);
+
     if (parent) {
         type = parent->nodetype;
         module = parent->module;
@@ -2403,6 +2673,8 @@ lys_tpdf_free(struct ly_ctx *ctx, struct lys_tpdf *tpdf,
         return;
     }
 
+    lytype_tpdf_forget(tpdf);
+
     lydict_remove(ctx, tpdf->name);
     lydict_remove(ctx, tpdf->dsc);
     lydict_remove(ctx, tpdf->ref);
@@ -2807,6 +3079,7 @@ lys_node_free(struct lys_node *node, void (*private_destructor)(const struct lys
     assert(node->module->ctx);
 
     ctx = node->module->ctx;
+    lys_node_idx_clear(ctx);
 
     /* remove private object */
     if (node->priv && private_destructor) {
@@ -2890,7 +3163,8 @@ lys_implemented_module(const struct lys_module *mod)
     FUN_IN;
 
     struct ly_ctx *ctx;
-    int i;
+    struct lys_module *iter = NULL;
+    int i, r;
 
     if (!mod || mod->implemented) {
         /* invalid argument or the module itself is implemented */
@@ -2898,6 +3172,16 @@ lys_implemented_module(const struct lys_module *mod)
     }
 
     ctx = mod->ctx;
+    while (!(r = ly_ctx_mod_idx_next(ctx, mod->name, 0, 0, &iter))) {
+        if (iter->implemented) {
+            /* we have some revision of the module implemented */
+            return iter;
+        }
+    }
+    if (r != -1) {
+        return (struct lys_module *)mod;
+    }
+
     for (i = 0; i < ctx->models.used; i++) {
         if (!ctx->models.list[i]->implemented) {
             continue;
@@ -3824,6 +4108,7 @@ lys_free(struct lys_module *module, void (*private_destructor)(const struct lys_
 
     /* remove schema from the context */
     ctx = module->ctx;
+    ly_ctx_mod_idx_remove(module);
     if (remove_from_ctx && ctx->models.used) {
         for (i = 0; i < ctx->models.used; i++) {
             if (ctx->models.list[i] == module) {
@@ -4525,6 +4810,7 @@ apply_aug(struct lys_node_augment *augment, struct unres_schema *unres)
     }
 
     /* reconnect augmenting data into the target - add them to the target child list */
+    lys_node_idx_clear(augment->module->ctx);
     if (augment->target->child) {
         child = augment->target->child->prev;
         child->next = augment->child;
@@ -4552,6 +4838,7 @@ remove_aug(struct lys_node_augment *augment)
 
     elem = augment->child;
     if (elem) {
+        lys_node_idx_clear(augment->module->ctx);
         LY_TREE_FOR(elem, last) {
             if (!last->next || (last->next->parent != (struct lys_node *)augment)) {
                 break;
@@ -4602,6 +4889,8 @@ lys_switch_deviation(struct lys_deviation *dev, const struct lys_module *module,
         return;
     }
 
+    lys_node_idx_clear(module->ctx);
+
     if (dev->deviate[0].mod == LY_DEVIATE_NO) {
         if (dev->orig_node) {
             /* removing not-supported deviation ... */
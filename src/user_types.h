@@ -30,7 +30,7 @@ extern "C" {
 /**
  * @brief User types API version
  */
-#define LYTYPE_API_VERSION 1
+#define LYTYPE_API_VERSION 2
 
 /**
  * @brief Macro to store version of user type plugins API in the plugins.
@@ -59,6 +59,39 @@ extern "C" {
 typedef int (*lytype_store_clb)(struct ly_ctx *ctx, const char *type_name, const char **value_str, lyd_val *value,
                                 char **err_msg);
 
+/**
+ * @brief Callback for validating user type values instead of matching them with the type patterns.
+ *
+ * It is used instead of all the patterns of the type, including the patterns of the types it is derived from.
+ * If the callback cannot decide, the value is matched with the patterns as usual, so it does not have to recognize
+ * every valid (or invalid) value, but any decision it makes must be the same as the one of the patterns. Also,
+ * if the value does not match and the error is to be printed, the patterns are still used to generate it.
+ * Other restrictions (such as length) are always checked.
+ *
+ * @param[in] type_name Name of the type being validated.
+ * @param[in] value_str String value to be validated.
+ * @return 0 if the value matches all the patterns,
+ * @return 1 if the value does not match some pattern,
+ * @return -1 if the patterns need to be used.
+ */
+typedef int (*lytype_validate_clb)(const char *type_name, const char *value_str);
+
+/**
+ * @brief Callback for duplicating user type values.
+ *
+ * If not defined, the duplicated value is stored again from its string value using #lytype_store_clb.
+ *
+ * @param[in] ctx libyang ctx of the duplicated value.
+ * @param[in] type_name Name of the type being duplicated.
+ * @param[in] value_str String value of the duplicate, already in the dictionary of \p ctx.
+ * @param[in] orig Original stored value.
+ * @param[out] dup Value union for the duplicated value.
+ * @param[out] err_msg Can be filled on error. If not, a generic error message will be printed.
+ * @return 0 on success, non-zero if an error occurred and the value could not be duplicated.
+ */
+typedef int (*lytype_dup_clb)(struct ly_ctx *ctx, const char *type_name, const char *value_str, lyd_val orig,
+                              lyd_val *dup, char **err_msg);
+
 struct lytype_plugin_list {
     const char *module;          /**< Name of the module where the type is defined. */
     const char *revision;        /**< Optional module revision - if not specified, the plugin applies to any revision,
@@ -67,10 +100,28 @@ struct lytype_plugin_list {
                                       different revision, but all with the same store callback. The only valid use case
                                       for the NULL revision is the case when the module has no revision. */
     const char *name;            /**< Name of the type to be stored in a custom way. */
-    lytype_store_clb store_clb;  /**< Callback used for storing values of this type. */
+    lytype_store_clb store_clb;  /**< Callback used for storing values of this type, can be NULL. */
     void (*free_clb)(void *ptr); /**< Callback used for freeing values of this type. */
+    lytype_validate_clb validate_clb; /**< Optional callback used for validating values of this type faster
+                                           than by its patterns. */
+    lytype_dup_clb dup_clb;      /**< Optional callback used for duplicating values of this type. */
 };
 
+/**
+ * @brief Duplicate callback for types storing their canonical value as ::lyd_val.string, can be directly used
+ * as #lytype_dup_clb. The value string of the duplicate is just shared.
+ *
+ * @param[in] ctx libyang ctx of the duplicated value.
+ * @param[in] type_name Name of the type being duplicated.
+ * @param[in] value_str String value of the duplicate, already in the dictionary of \p ctx.
+ * @param[in] orig Original stored value.
+ * @param[out] dup Value union for the duplicated value.
+ * @param[out] err_msg Not used.
+ * @return 0.
+ */
+int lytype_dup_string(struct ly_ctx *ctx, const char *type_name, const char *value_str, lyd_val orig, lyd_val *dup,
+                      char **err_msg);
+
 /**
  * @}
  */
@@ -1,7 +1,7 @@
 /**
  * @file user_inet_types.c
  * @author Michal Vasko <mvasko@cesnet.cz>
- * @brief ietf-inet-types typedef conversion to canonical format
+ * @brief ietf-inet-types typedef validation and conversion to canonical format
  *
  * Copyright (c) 2018 CESNET, z.s.p.o.
  *
@@ -35,90 +35,353 @@ LYTYPE_VERSION_CHECK
 #  define UNUSED(x) UNUSED_ ## x
 #endif
 
-static char *
-convert_ipv6_addr(const char *ipv6_addr, char **err_msg)
+static int
+is_digit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+static int
+is_hex_digit(char c)
+{
+    return is_digit(c) || ((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F'));
+}
+
+static int
+is_alnum(char c)
+{
+    return is_digit(c) || ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'));
+}
+
+/**
+ * @brief Check a decimal number without leading zeros.
+ *
+ * @param[in] str String to check.
+ * @param[in] max Maximal value.
+ * @param[out] end Pointer to the first character after the number.
+ * @return 0 if valid, non-zero otherwise.
+ */
+static int
+check_dec_num(const char *str, int max, const char **end)
+{
+    int val = 0, len;
+
+    for (len = 0; is_digit(str[len]); ++len) {
+        if ((len && !val) || (len == 3)) {
+            /* leading zero or too long */
+            return 1;
+        }
+        val = val * 10 + (str[len] - '0');
+    }
+    if (!len || (val > max)) {
+        return 1;
+    }
+
+    *end = str + len;
+    return 0;
+}
+
+/**
+ * @brief Check a dotted-quad IPv4 address (without leading zeros).
+ *
+ * @param[in] str String to check.
+ * @param[out] end Pointer to the first character after the address.
+ * @return 0 if valid, non-zero otherwise.
+ */
+static int
+check_ipv4(const char *str, const char **end)
+{
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        if (i) {
+            if (str[0] != '.') {
+                return 1;
+            }
+            ++str;
+        }
+        if (check_dec_num(str, 255, &str)) {
+            return 1;
+        }
+    }
+
+    *end = str;
+    return 0;
+}
+
+/**
+ * @brief Check an IPv6 address in the text form of RFC 4291 section 2.2 (groups of 1 - 4 hexadecimal digits,
+ * at most one "::", and an optional IPv4 address in the last 32 bits).
+ *
+ * @param[in] str String to check.
+ * @param[out] end Pointer to the first character after the address.
+ * @return 0 if valid, non-zero otherwise.
+ */
+static int
+check_ipv6(const char *str, const char **end)
+{
+    int groups = 0, compressed = 0, len;
+
+    if ((str[0] == ':') && (str[1] == ':')) {
+        compressed = 1;
+        str += 2;
+        if (!is_hex_digit(str[0])) {
+            /* just "::" */
+            *end = str;
+            return 0;
+        }
+    }
+
+    while (1) {
+        for (len = 0; is_hex_digit(str[len]); ++len) {
+            if (len == 4) {
+                return 1;
+            }
+        }
+        if (!len) {
+            return 1;
+        }
+
+        if (str[len] == '.') {
+            /* IPv4 address in the last 32 bits */
+            if ((groups > 6) || check_ipv4(str, &str)) {
+                return 1;
+            }
+            groups += 2;
+            break;
+        }
+        str += len;
+        ++groups;
+
+        if (str[0] != ':') {
+            break;
+        }
+        if (str[1] == ':') {
+            if (compressed) {
+                return 1;
+            }
+            compressed = 1;
+            str += 2;
+            if (!is_hex_digit(str[0])) {
+                /* "::" at the end */
+                break;
+            }
+        } else {
+            ++str;
+        }
+    }
+
+    if (compressed ? (groups > 7) : (groups != 8)) {
+        return 1;
+    }
+
+    *end = str;
+    return 0;
+}
+
+/**
+ * @brief Check an optional zone index of an IP address.
+ *
+ * @param[in] str String to check.
+ * @return 0 if valid, 1 if not, -1 if it includes non-ASCII characters that are not checked.
+ */
+static int
+check_zone(const char *str)
+{
+    int ret = 0;
+
+    if (!str[0]) {
+        /* no zone */
+        return 0;
+    }
+
+    if ((str[0] != '%') || !str[1]) {
+        return 1;
+    }
+    for (++str; str[0]; ++str) {
+        if (str[0] & 0x80) {
+            /* possibly a Unicode letter or number */
+            ret = -1;
+        } else if (!is_alnum(str[0])) {
+            return 1;
+        }
+    }
+    return ret;
+}
+
+static int
+ipv4_validate_clb(const char *type_name, const char *value_str)
 {
-    char buf[sizeof(struct in6_addr)], *str;
+    const char *end;
 
-    str = malloc(INET6_ADDRSTRLEN);
-    if (!str) {
-        *err_msg = NULL;
-        return NULL;
+    if (check_ipv4(value_str, &end)) {
+        return 1;
+    }
+    if (!strcmp(type_name, "ipv4-address-no-zone")) {
+        return end[0] ? 1 : 0;
     }
+    return check_zone(end);
+}
+
+static int
+ipv6_validate_clb(const char *type_name, const char *value_str)
+{
+    const char *end;
+
+    if (!strchr(value_str, ':')) {
+        /* cannot be an IPv6 address */
+        return 1;
+    }
+
+    /* the patterns are less strict, let them decide about anything not recognized */
+    if (check_ipv6(value_str, &end)) {
+        return -1;
+    }
+    if (!strcmp(type_name, "ipv6-address-no-zone")) {
+        return end[0] ? -1 : 0;
+    }
+    return check_zone(end) ? -1 : 0;
+}
+
+static int
+ipv4_prefix_validate_clb(const char *UNUSED(type_name), const char *value_str)
+{
+    const char *end;
+
+    if (check_ipv4(value_str, &end) || (end[0] != '/') || check_dec_num(end + 1, 32, &end) || end[0]) {
+        return 1;
+    }
+    return 0;
+}
+
+static int
+ipv6_prefix_validate_clb(const char *UNUSED(type_name), const char *value_str)
+{
+    const char *end;
+
+    if (!strchr(value_str, ':')) {
+        /* cannot be an IPv6 prefix */
+        return 1;
+    }
+
+    /* the patterns are less strict, let them decide about anything not recognized */
+    if (check_ipv6(value_str, &end) || (end[0] != '/') || check_dec_num(end + 1, 128, &end) || end[0]) {
+        return -1;
+    }
+    return 0;
+}
+
+static int
+domain_name_validate_clb(const char *UNUSED(type_name), const char *value_str)
+{
+    const char *label;
+    int len;
 
-    if (!inet_pton(AF_INET6, ipv6_addr, buf)) {
-        if (asprintf(err_msg, "Failed to convert IPv6 address \"%s\".", ipv6_addr) == -1) {
+    if (!strcmp(value_str, ".")) {
+        return 0;
+    }
+
+    label = value_str;
+    do {
+        /* label of 1 - 63 characters, starting with an alphanumeric character or '_' and ending with
+         * an alphanumeric character, '-' and '_' are allowed inside */
+        for (len = 0; is_alnum(label[len]) || (label[len] == '-') || (label[len] == '_'); ++len);
+        if (!len || (len > 63) || (label[0] == '-') || !is_alnum(label[len - 1])) {
+            return 1;
+        }
+        if (!label[len]) {
+            break;
+        } else if (label[len] != '.') {
+            return 1;
+        }
+        label += len + 1;
+    } while (label[0]);
+
+    return 0;
+}
+
+/**
+ * @brief Convert an IPv6 address into its canonical format.
+ *
+ * @param[in] ipv6_addr Address to convert.
+ * @param[in] len Length of @p ipv6_addr.
+ * @param[out] result Buffer of INET6_ADDRSTRLEN bytes for the canonical address.
+ * @param[out] err_msg Error message on error.
+ * @return 0 on success, non-zero on error.
+ */
+static int
+convert_ipv6_addr(const char *ipv6_addr, int len, char *result, char **err_msg)
+{
+    char buf[sizeof(struct in6_addr)], addr[INET6_ADDRSTRLEN];
+
+    if (len < INET6_ADDRSTRLEN) {
+        memcpy(addr, ipv6_addr, len);
+        addr[len] = '\0';
+    }
+    if ((len >= INET6_ADDRSTRLEN) || !inet_pton(AF_INET6, addr, buf)) {
+        if (asprintf(err_msg, "Failed to convert IPv6 address \"%.*s\".", len, ipv6_addr) == -1) {
             *err_msg = NULL;
         }
-        free(str);
-        return NULL;
+        return 1;
     }
 
-    if (!inet_ntop(AF_INET6, buf, str, INET6_ADDRSTRLEN)) {
+    if (!inet_ntop(AF_INET6, buf, result, INET6_ADDRSTRLEN)) {
         if (asprintf(err_msg, "Failed to convert IPv6 address (%s).", strerror(errno)) == -1) {
             *err_msg = NULL;
         }
-        free(str);
-        return NULL;
+        return 1;
     }
 
-    return str;
+    return 0;
 }
 
 static int
 ip_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const char **value_str, lyd_val *value, char **err_msg)
 {
-    char *ptr, *ipv6_addr, *result, *tmp;
+    char result[INET6_ADDRSTRLEN], *str;
+    const char *zone;
+    int len;
 
     if (!strchr(*value_str, ':')) {
         /* not an IPv6 address */
         return 0;
     }
 
-    if ((ptr = strchr(*value_str, '%'))) {
-        /* there is a zone index */
-        ipv6_addr = strndup(*value_str, ptr - *value_str);
-    } else {
-        ipv6_addr = (char *)*value_str;
-    }
+    /* there may be a zone index */
+    zone = strchr(*value_str, '%');
+    len = zone ? zone - *value_str : (int)strlen(*value_str);
 
     /* convert to canonical format */
-    result = convert_ipv6_addr(ipv6_addr, err_msg);
-    if (ptr) {
-        free(ipv6_addr);
+    if (convert_ipv6_addr(*value_str, len, result, err_msg)) {
+        return 1;
     }
 
-    /* failure */
-    if (!result) {
-        return 1;
+    if (((int)strlen(result) == len) && !strncmp(*value_str, result, len)) {
+        /* already canonical */
+        return 0;
     }
 
-    if (strncmp(*value_str, result, strlen(result))) {
-        /* some conversion took place, update the value */
-        if (ptr) {
-            tmp = result;
-            if (asprintf(&result, "%s%s", tmp, ptr) == -1) {
-                free(tmp);
-                *err_msg = NULL;
-                return 1;
-            }
-            free(tmp);
+    /* some conversion took place, update the value */
+    if (zone) {
+        if (asprintf(&str, "%s%s", result, zone) == -1) {
+            *err_msg = NULL;
+            return 1;
         }
-
         lydict_remove(ctx, *value_str);
-        *value_str = lydict_insert_zc(ctx, result);
-        value->string = *value_str;
+        *value_str = lydict_insert_zc(ctx, str);
     } else {
-        free(result);
+        lydict_remove(ctx, *value_str);
+        *value_str = lydict_insert(ctx, result, 0);
     }
-
+    value->string = *value_str;
     return 0;
 }
 
 static int
 ipv4_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const char **value_str, lyd_val *value, char **err_msg)
 {
-    char *pref_str, *ptr, *result;
+    const char *pref_str;
+    char *ptr, result[INET_ADDRSTRLEN + 3];
     uint32_t pref, addr_bin, i, mask;
 
     if (sizeof addr_bin < sizeof(struct in_addr)) {
@@ -145,22 +408,15 @@ ipv4_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const c
         return 1;
     }
 
-    result = malloc(INET_ADDRSTRLEN + 3);
-    if (!result) {
-        *err_msg = NULL;
-        return 1;
+    /* copy just the network prefix and convert it to binary form */
+    if (pref_str - *value_str < INET_ADDRSTRLEN) {
+        memcpy(result, *value_str, pref_str - *value_str);
+        result[pref_str - *value_str] = '\0';
     }
-
-    /* copy just the network prefix */
-    strncpy(result, *value_str, pref_str - *value_str);
-    result[pref_str - *value_str] = '\0';
-
-    /* convert it to binary form */
-    if (inet_pton(AF_INET, result, (void *)&addr_bin) != 1) {
-        if (asprintf(err_msg, "Failed to convert IPv4 address \"%s\".", result) == -1) {
+    if ((pref_str - *value_str >= INET_ADDRSTRLEN) || (inet_pton(AF_INET, result, (void *)&addr_bin) != 1)) {
+        if (asprintf(err_msg, "Failed to convert IPv4 address \"%.*s\".", (int)(pref_str - *value_str), *value_str) == -1) {
             *err_msg = NULL;
         }
-        free(result);
         return 1;
     }
 
@@ -180,7 +436,6 @@ ipv4_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const c
         if (asprintf(err_msg, "Failed to convert IPv4 address (%s).", strerror(errno)) == -1) {
             *err_msg = NULL;
         }
-        free(result);
         return 1;
     }
 
@@ -190,10 +445,8 @@ ipv4_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const c
     if (strcmp(result, *value_str)) {
         /* some conversion took place, update the value */
         lydict_remove(ctx, *value_str);
-        *value_str = lydict_insert_zc(ctx, result);
+        *value_str = lydict_insert(ctx, result, 0);
         value->string = *value_str;
-    } else {
-        free(result);
     }
 
     return 0;
@@ -202,7 +455,8 @@ ipv4_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const c
 static int
 ipv6_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const char **value_str, lyd_val *value, char **err_msg)
 {
-    char *pref_str, *ptr, *result;
+    const char *pref_str;
+    char *ptr, result[INET6_ADDRSTRLEN + 4];
     unsigned long int pref, i, j;
     union {
         struct in6_addr s;
@@ -227,22 +481,15 @@ ipv6_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const c
         return 1;
     }
 
-    result = malloc(INET6_ADDRSTRLEN + 4);
-    if (!result) {
-        *err_msg = NULL;
-        return 1;
+    /* copy just the network prefix and convert it to binary form */
+    if (pref_str - *value_str < INET6_ADDRSTRLEN) {
+        memcpy(result, *value_str, pref_str - *value_str);
+        result[pref_str - *value_str] = '\0';
     }
-
-    /* copy just the network prefix */
-    strncpy(result, *value_str, pref_str - *value_str);
-    result[pref_str - *value_str] = '\0';
-
-    /* convert it to binary form */
-    if (inet_pton(AF_INET6, result, (void *)&addr_bin.s) != 1) {
-        if (asprintf(err_msg, "Failed to convert IPv6 address \"%s\".", result) == -1) {
+    if ((pref_str - *value_str >= INET6_ADDRSTRLEN) || (inet_pton(AF_INET6, result, (void *)&addr_bin.s) != 1)) {
+        if (asprintf(err_msg, "Failed to convert IPv6 address \"%.*s\".", (int)(pref_str - *value_str), *value_str) == -1) {
             *err_msg = NULL;
         }
-        free(result);
         return 1;
     }
 
@@ -264,7 +511,6 @@ ipv6_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const c
         if (asprintf(err_msg, "Failed to convert IPv6 address (%s).", strerror(errno)) == -1) {
             *err_msg = NULL;
         }
-        free(result);
         return 1;
     }
 
@@ -274,10 +520,8 @@ ipv6_prefix_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const c
     if (strcmp(result, *value_str)) {
         /* some conversion took place, update the value */
         lydict_remove(ctx, *value_str);
-        *value_str = lydict_insert_zc(ctx, result);
+        *value_str = lydict_insert(ctx, result, 0);
         value->string = *value_str;
-    } else {
-        free(result);
     }
 
     return 0;
@@ -294,12 +538,15 @@ ip_prefix_store_clb(struct ly_ctx *ctx, const char *type_name, const char **valu
 
 /* Name of this array must match the file name! */
 struct lytype_plugin_list user_inet_types[] = {
-    {"ietf-inet-types", "2013-07-15", "ip-address", ip_store_clb, NULL},
-    {"ietf-inet-types", "2013-07-15", "ipv6-address", ip_store_clb, NULL},
-    {"ietf-inet-types", "2013-07-15", "ip-address-no-zone", ip_store_clb, NULL},
-    {"ietf-inet-types", "2013-07-15", "ipv6-address-no-zone", ip_store_clb, NULL},
-    {"ietf-inet-types", "2013-07-15", "ip-prefix", ip_prefix_store_clb, NULL},
-    {"ietf-inet-types", "2013-07-15", "ipv4-prefix", ipv4_prefix_store_clb, NULL},
-    {"ietf-inet-types", "2013-07-15", "ipv6-prefix", ipv6_prefix_store_clb, NULL},
-    {NULL, NULL, NULL, NULL, NULL} /* terminating item */
+    {"ietf-inet-types", "2013-07-15", "ip-address", ip_store_clb, NULL, NULL, lytype_dup_string},
+    {"ietf-inet-types", "2013-07-15", "ipv4-address", NULL, NULL, ipv4_validate_clb, NULL},
+    {"ietf-inet-types", "2013-07-15", "ipv6-address", ip_store_clb, NULL, ipv6_validate_clb, lytype_dup_string},
+    {"ietf-inet-types", "2013-07-15", "ip-address-no-zone", ip_store_clb, NULL, NULL, lytype_dup_string},
+    {"ietf-inet-types", "2013-07-15", "ipv4-address-no-zone", NULL, NULL, ipv4_validate_clb, NULL},
+    {"ietf-inet-types", "2013-07-15", "ipv6-address-no-zone", ip_store_clb, NULL, ipv6_validate_clb, lytype_dup_string},
+    {"ietf-inet-types", "2013-07-15", "ip-prefix", ip_prefix_store_clb, NULL, NULL, lytype_dup_string},
+    {"ietf-inet-types", "2013-07-15", "ipv4-prefix", ipv4_prefix_store_clb, NULL, ipv4_prefix_validate_clb, lytype_dup_string},
+    {"ietf-inet-types", "2013-07-15", "ipv6-prefix", ipv6_prefix_store_clb, NULL, ipv6_prefix_validate_clb, lytype_dup_string},
+    {"ietf-inet-types", "2013-07-15", "domain-name", NULL, NULL, domain_name_validate_clb, NULL},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL} /* terminating item */
 };
@@ -234,6 +234,12 @@ hex_string_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const ch
     char *str;
     uint32_t i, len;
 
+    for (i = 0; (*value_str)[i] && (((*value_str)[i] < 'A') || ((*value_str)[i] > 'Z')); ++i);
+    if (!(*value_str)[i]) {
+        /* already in the canonical format */
+        return 0;
+    }
+
     str = strdup(*value_str);
     if (!str) {
         /* we can hardly allocate an error message */
@@ -242,7 +248,7 @@ hex_string_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const ch
     }
 
     len = strlen(str);
-    for (i = 0; i < len; ++i) {
+    for (; i < len; ++i) {
         if ((str[i] >= 'A') && (str[i] <= 'Z')) {
             /* make it lowercase (canonical format) */
             str[i] += 32;
@@ -256,12 +262,169 @@ hex_string_store_clb(struct ly_ctx *ctx, const char *UNUSED(type_name), const ch
     return 0;
 }
 
+static int
+is_digit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+static int
+is_hex_digit(char c)
+{
+    return is_digit(c) || ((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F'));
+}
+
+static int
+is_alpha(char c)
+{
+    return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'));
+}
+
+/**
+ * @brief Check a sequence of digits.
+ *
+ * @param[in] str String to check.
+ * @param[in] count Number of digits, 0 for one or more digits.
+ * @param[in] hex Whether the digits are hexadecimal.
+ * @return Pointer to the first character after the digits, NULL if not valid.
+ */
+static const char *
+check_digits(const char *str, int count, int hex)
+{
+    int i;
+
+    for (i = 0; hex ? is_hex_digit(str[i]) : is_digit(str[i]); ++i) {
+        if (count && (i == count)) {
+            return NULL;
+        }
+    }
+    if (count ? (i != count) : !i) {
+        return NULL;
+    }
+    return str + i;
+}
+
+static int
+date_and_time_validate_clb(const char *UNUSED(type_name), const char *value_str)
+{
+    /* only the syntax, the date and time itself is checked by the store callback */
+    if (!(value_str = check_digits(value_str, 4, 0)) || (value_str[0] != '-')
+            || !(value_str = check_digits(value_str + 1, 2, 0)) || (value_str[0] != '-')
+            || !(value_str = check_digits(value_str + 1, 2, 0)) || (value_str[0] != 'T')
+            || !(value_str = check_digits(value_str + 1, 2, 0)) || (value_str[0] != ':')
+            || !(value_str = check_digits(value_str + 1, 2, 0)) || (value_str[0] != ':')
+            || !(value_str = check_digits(value_str + 1, 2, 0))) {
+        return 1;
+    }
+    if ((value_str[0] == '.') && !(value_str = check_digits(value_str + 1, 0, 0))) {
+        return 1;
+    }
+
+    if (value_str[0] == 'Z') {
+        return value_str[1] ? 1 : 0;
+    } else if ((value_str[0] != '+') && (value_str[0] != '-')) {
+        return 1;
+    }
+    if (!(value_str = check_digits(value_str + 1, 2, 0)) || (value_str[0] != ':')
+            || !(value_str = check_digits(value_str + 1, 2, 0)) || value_str[0]) {
+        return 1;
+    }
+    return 0;
+}
+
+static int
+hex_string_validate_clb(const char *type_name, const char *value_str)
+{
+    int i, octets;
+
+    /* mac-address has exactly 6 octets, phys-address and hex-string any number of them */
+    octets = strcmp(type_name, "mac-address") ? 0 : 6;
+
+    if (!value_str[0]) {
+        return octets ? 1 : 0;
+    }
+    for (i = 0; 1; ++i) {
+        if (!(value_str = check_digits(value_str, 2, 1))) {
+            return 1;
+        }
+        if (!value_str[0]) {
+            break;
+        } else if (value_str[0] != ':') {
+            return 1;
+        }
+        ++value_str;
+    }
+    return (octets && (i + 1 != octets)) ? 1 : 0;
+}
+
+static int
+uuid_validate_clb(const char *UNUSED(type_name), const char *value_str)
+{
+    if (!(value_str = check_digits(value_str, 8, 1)) || (value_str[0] != '-')
+            || !(value_str = check_digits(value_str + 1, 4, 1)) || (value_str[0] != '-')
+            || !(value_str = check_digits(value_str + 1, 4, 1)) || (value_str[0] != '-')
+            || !(value_str = check_digits(value_str + 1, 4, 1)) || (value_str[0] != '-')
+            || !(value_str = check_digits(value_str + 1, 12, 1)) || value_str[0]) {
+        return 1;
+    }
+    return 0;
+}
+
+static int
+dotted_quad_validate_clb(const char *UNUSED(type_name), const char *value_str)
+{
+    int i, len, val;
+
+    for (i = 0; i < 4; ++i) {
+        if (i) {
+            if (value_str[0] != '.') {
+                return 1;
+            }
+            ++value_str;
+        }
+        /* decimal octet without leading zeros */
+        val = 0;
+        for (len = 0; is_digit(value_str[len]); ++len) {
+            if ((len && !val) || (len == 3)) {
+                return 1;
+            }
+            val = val * 10 + (value_str[len] - '0');
+        }
+        if (!len || (val > 255)) {
+            return 1;
+        }
+        value_str += len;
+    }
+    return value_str[0] ? 1 : 0;
+}
+
+static int
+yang_identifier_validate_clb(const char *UNUSED(type_name), const char *value_str)
+{
+    int i;
+
+    if (!is_alpha(value_str[0]) && (value_str[0] != '_')) {
+        return 1;
+    }
+    for (i = 1; value_str[i]; ++i) {
+        if (!is_alpha(value_str[i]) && !is_digit(value_str[i]) && (value_str[i] != '-') && (value_str[i] != '_')
+                && (value_str[i] != '.')) {
+            return 1;
+        }
+    }
+    /* the second pattern (not starting with "xml") ends with ".*" so it is not anchored at the end
+     * and hence matches any value matching the first one */
+    return 0;
+}
+
 /* Name of this array must match the file name! */
 struct lytype_plugin_list user_yang_types[] = {
-    {"ietf-yang-types", "2013-07-15", "date-and-time", date_and_time_store_clb, NULL},
-    {"ietf-yang-types", "2013-07-15", "phys-address", hex_string_store_clb, NULL},
-    {"ietf-yang-types", "2013-07-15", "mac-address", hex_string_store_clb, NULL},
-    {"ietf-yang-types", "2013-07-15", "hex-string", hex_string_store_clb, NULL},
-    {"ietf-yang-types", "2013-07-15", "uuid", hex_string_store_clb, NULL},
-    {NULL, NULL, NULL, NULL, NULL} /* terminating item */
+    {"ietf-yang-types", "2013-07-15", "date-and-time", date_and_time_store_clb, NULL, date_and_time_validate_clb, lytype_dup_string},
+    {"ietf-yang-types", "2013-07-15", "phys-address", hex_string_store_clb, NULL, hex_string_validate_clb, lytype_dup_string},
+    {"ietf-yang-types", "2013-07-15", "mac-address", hex_string_store_clb, NULL, hex_string_validate_clb, lytype_dup_string},
+    {"ietf-yang-types", "2013-07-15", "hex-string", hex_string_store_clb, NULL, hex_string_validate_clb, lytype_dup_string},
+    {"ietf-yang-types", "2013-07-15", "uuid", hex_string_store_clb, NULL, uuid_validate_clb, lytype_dup_string},
+    {"ietf-yang-types", "2013-07-15", "dotted-quad", NULL, NULL, dotted_quad_validate_clb, NULL},
+    {"ietf-yang-types", "2013-07-15", "yang-identifier", NULL, NULL, yang_identifier_validate_clb, NULL},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL} /* terminating item */
 };
@@ -13,10 +13,14 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "common.h"
+#include "context.h"
+#include "hash_table.h"
 #include "validation.h"
 #include "libyang.h"
 #include "xpath.h"
@@ -137,9 +141,11 @@ lyv_data_context(struct lyd_node *node, int options, struct unres_data *unres)
  * actions (cb_data):
  * 0  - compare all uniques
  * n  - compare n-th unique
+ *
+ * When used as a hash table callback, \p val2_p is the stored instance.
  */
 static int
-lyv_list_uniq_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *cb_data)
+lyv_list_uniq_equal(void *val1_p, void *val2_p, int mod, void *cb_data)
 {
     struct ly_ctx *ctx;
     struct lys_node_list *slist;
@@ -151,8 +157,14 @@ lyv_list_uniq_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *cb_data)
 
     assert(val1_p && val2_p);
 
-    first = *((struct lyd_node **)val1_p);
-    second = *((struct lyd_node **)val2_p);
+    if (mod) {
+        /* removing/inserting a particular instance */
+        return *((struct lyd_node **)val1_p) == *((struct lyd_node **)val2_p);
+    }
+
+    /* report the instances in the order they were added */
+    first = *((struct lyd_node **)val2_p);
+    second = *((struct lyd_node **)val1_p);
     action = (intptr_t)cb_data;
 
     assert(first && (first->schema->nodetype == LYS_LIST));
@@ -236,16 +248,442 @@ unique_errmsg_cleanup:
     return 0;
 }
 
+/**
+ * @brief Get hash of the values of a unique statement in a list instance.
+ *
+ * @param[in] list List instance.
+ * @param[in] uniq Unique statement of the list.
+ * @param[out] hash Hash of the unique values.
+ * @return 0 on success, 1 if some of the unique values is not set, -1 on error.
+ */
+static int
+lyv_unique_hash(struct lyd_node *list, struct lys_unique *uniq, uint32_t *hash)
+{
+    struct lyd_node *diter;
+    const char *id;
+    uint32_t val_hash;
+    uint8_t i;
+
+    for (i = 0, *hash = 0; i < uniq->expr_size; i++) {
+        diter = resolve_data_descendant_schema_nodeid(uniq->expr[i], list->child);
+        if (diter) {
+            val_hash = lyd_value_hash(((struct lyd_node_leaf_list *)diter)->value_str);
+        } else {
+            /* use default value */
+            if (lyd_get_unique_default(uniq->expr[i], list, &id)) {
+                return -1;
+            }
+            if (!id) {
+                /* unique item not present nor has default value */
+                return 1;
+            }
+            val_hash = lyd_value_hash(id);
+        }
+        *hash = dict_hash_multi(*hash, (char *)&val_hash, sizeof val_hash);
+    }
+
+    /* finish the hash value */
+    *hash = dict_hash_multi(*hash, NULL, 0);
+    return 0;
+}
+
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Record of an instance in lyd_unique_index#members.
+ */
+struct lyd_unique_member {
+    struct lyd_node *list;          /**< indexed list instance */
+    uint32_t hash[];                /**< hash of the values of each unique, 0 if the instance is not in
+                                         lyd_unique_index#uniq (all the values not set) */
+};
+
+/* size of struct lyd_unique_member with all the hashes aligned for the hash table records */
+#define LYV_UNIQUE_MEMBER_SIZE(slist) ((sizeof(struct lyd_unique_member) + (slist)->unique_size * sizeof(uint32_t) \
+        + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+static int
+lyv_unique_member_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct lyd_unique_member *)val1_p)->list == ((struct lyd_unique_member *)val2_p)->list;
+}
+
+static int
+lyv_unique_parent_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return (*(struct lyd_unique_index **)val1_p)->parent == (*(struct lyd_unique_index **)val2_p)->parent;
+}
+
+static uint32_t
+lyv_unique_node_hash(const struct lyd_node *node)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (char *)&node, sizeof node);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+static void
+lyv_unique_index_free_single(struct lyd_unique_index *idx)
+{
+    uint8_t j;
+
+    if (!idx) {
+        return;
+    }
+
+    if (idx->uniq) {
+        for (j = 0; j < ((struct lys_node_list *)idx->schema)->unique_size; ++j) {
+            lyht_free(idx->uniq[j]);
+        }
+    }
+    free(idx->uniq);
+    lyht_free(idx->members);
+    free(idx);
+}
+
+/**
+ * @brief Find the first unique index of a parent in the context. Must be called with the index lock held.
+ *
+ * @param[in] ctx Context with the indexes.
+ * @param[in] parent Parent of the instances.
+ * @return Pointer to the first index of \p parent in the context hash table, NULL if there is none.
+ */
+static struct lyd_unique_index **
+lyv_unique_index_first(struct ly_ctx *ctx, const struct lyd_node *parent)
+{
+    struct lyd_unique_index key, *key_p = &key, **match;
+
+    if (!ctx->uniq_idx) {
+        return NULL;
+    }
+
+    key.parent = parent;
+    if (lyht_find(ctx->uniq_idx, &key_p, lyv_unique_node_hash(parent), (void **)&match)) {
+        return NULL;
+    }
+    return match;
+}
+
+void
+lyv_unique_index_free(const struct lyd_node *parent)
+{
+    struct ly_ctx *ctx = parent->schema->module->ctx;
+    struct lyd_unique_index **first, *idx = NULL, *next;
+
+    if (!__atomic_load_n(&ctx->uniq_idx_count, __ATOMIC_RELAXED)) {
+        /* no indexes at all */
+        return;
+    }
+
+    pthread_mutex_lock(&ctx->uniq_idx_lock);
+    first = lyv_unique_index_first(ctx, parent);
+    if (first) {
+        idx = *first;
+        lyht_remove(ctx->uniq_idx, &idx, lyv_unique_node_hash(parent));
+        __atomic_sub_fetch(&ctx->uniq_idx_count, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&ctx->uniq_idx_lock);
+
+    for (; idx; idx = next) {
+        next = idx->next;
+        lyv_unique_index_free_single(idx);
+    }
+}
+
+void
+lyv_unique_index_clean(struct ly_ctx *ctx)
+{
+    struct ht_rec *hrec;
+    struct lyd_unique_index *idx, *next;
+    uint32_t i;
+
+    if (!ctx->uniq_idx) {
+        return;
+    }
+
+    for (i = 0; i < ctx->uniq_idx->size; ++i) {
+        hrec = lyht_get_rec(ctx->uniq_idx->recs, ctx->uniq_idx->rec_size, i);
+        if (hrec->hits > 0) {
+            for (idx = *(struct lyd_unique_index **)hrec->val; idx; idx = next) {
+                next = idx->next;
+                lyv_unique_index_free_single(idx);
+            }
+        }
+    }
+    lyht_free(ctx->uniq_idx);
+    ctx->uniq_idx = NULL;
+    ctx->uniq_idx_count = 0;
+}
+
+/**
+ * @brief Find unique index of instances of a list in a parent.
+ *
+ * The indexes of a parent are only changed by the thread working with its data tree,
+ * so they can be traversed without the lock.
+ *
+ * @param[in] parent Parent of the instances.
+ * @param[in] schema List schema node.
+ * @return Found index, NULL if there is none.
+ */
+static struct lyd_unique_index *
+lyv_unique_index_find(const struct lyd_node *parent, const struct lys_node *schema)
+{
+    struct ly_ctx *ctx = parent->schema->module->ctx;
+    struct lyd_unique_index **first, *idx = NULL;
+
+    if (!__atomic_load_n(&ctx->uniq_idx_count, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ctx->uniq_idx_lock);
+    first = lyv_unique_index_first(ctx, parent);
+    if (first) {
+        idx = *first;
+    }
+    pthread_mutex_unlock(&ctx->uniq_idx_lock);
+
+    for (; idx && (idx->schema != schema); idx = idx->next);
+    return idx;
+}
+
+static struct lyd_unique_index *
+lyv_unique_index_new(const struct lyd_node *parent, const struct lys_node *schema)
+{
+    struct ly_ctx *ctx = schema->module->ctx;
+    struct lys_node_list *slist = (struct lys_node_list *)schema;
+    struct lyd_unique_index *idx, **first;
+    uint8_t j;
+
+    idx = calloc(1, sizeof *idx);
+    LY_CHECK_ERR_RETURN(!idx, LOGMEM(ctx), NULL);
+    idx->parent = parent;
+    idx->schema = schema;
+
+    idx->members = lyht_new(LYHT_MIN_SIZE, LYV_UNIQUE_MEMBER_SIZE(slist), lyv_unique_member_equal, NULL, 1);
+    LY_CHECK_ERR_GOTO(!idx->members, LOGMEM(ctx), error);
+    idx->uniq = calloc(slist->unique_size, sizeof *idx->uniq);
+    LY_CHECK_ERR_GOTO(!idx->uniq, LOGMEM(ctx), error);
+    for (j = 0; j < slist->unique_size; ++j) {
+        idx->uniq[j] = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_node *), lyv_list_uniq_equal, (void *)(j + 1L), 1);
+        LY_CHECK_ERR_GOTO(!idx->uniq[j], LOGMEM(ctx), error);
+    }
+
+    /* store it in the context */
+    pthread_mutex_lock(&ctx->uniq_idx_lock);
+    if (!ctx->uniq_idx) {
+        ctx->uniq_idx = lyht_new(LYHT_MIN_SIZE, sizeof idx, lyv_unique_parent_equal, NULL, 1);
+        LY_CHECK_ERR_GOTO(!ctx->uniq_idx, LOGMEM(ctx); pthread_mutex_unlock(&ctx->uniq_idx_lock), error);
+    }
+    first = lyv_unique_index_first(ctx, parent);
+    if (first) {
+        /* the first index stays in the hash table */
+        idx->next = (*first)->next;
+        (*first)->next = idx;
+    } else {
+        if (lyht_insert(ctx->uniq_idx, &idx, lyv_unique_node_hash(parent), NULL)) {
+            pthread_mutex_unlock(&ctx->uniq_idx_lock);
+            LOGINT(ctx);
+            goto error;
+        }
+        __atomic_add_fetch(&ctx->uniq_idx_count, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&ctx->uniq_idx_lock);
+    return idx;
+
+error:
+    lyv_unique_index_free_single(idx);
+    return NULL;
+}
+
+/**
+ * @brief Add a list instance into a unique index, check that its unique values are not used by other instances.
+ *
+ * @param[in] idx Unique index of the instance siblings.
+ * @param[in] list List instance not yet in \p idx.
+ * @return 0 on success, 1 on unique violation (the instance is not added), -1 on error.
+ */
+static int
+lyv_unique_index_add(struct lyd_unique_index *idx, struct lyd_node *list)
+{
+    struct lys_node_list *slist = (struct lys_node_list *)list->schema;
+    struct lyd_unique_member *member;
+    int r, ret = 0;
+    uint8_t j, k;
+
+    member = calloc(1, LYV_UNIQUE_MEMBER_SIZE(slist));
+    LY_CHECK_ERR_RETURN(!member, LOGMEM(slist->module->ctx), -1);
+    member->list = list;
+
+    for (j = 0; j < slist->unique_size; ++j) {
+        r = lyv_unique_hash(list, &slist->unique[j], &member->hash[j]);
+        if (r == 1) {
+            /* skip this unique since its set is incomplete */
+            member->hash[j] = 0;
+            continue;
+        } else if (!r && !member->hash[j]) {
+            /* 0 is reserved for not indexed instances */
+            member->hash[j] = 1;
+        }
+        if (r || !lyht_find(idx->uniq[j], &list, member->hash[j], NULL)) {
+            /* error or the same values found (error printed in the callback) */
+            ret = r ? -1 : 1;
+            goto revert;
+        }
+
+        if (lyht_insert(idx->uniq[j], &list, member->hash[j], NULL)) {
+            LOGINT(slist->module->ctx);
+            ret = -1;
+            goto revert;
+        }
+    }
+
+    if (lyht_insert(idx->members, member, lyv_unique_node_hash(list), NULL)) {
+        LOGINT(slist->module->ctx);
+        ret = -1;
+        goto revert;
+    }
+    free(member);
+    return 0;
+
+revert:
+    for (k = 0; k < j; ++k) {
+        if (member->hash[k]) {
+            lyht_remove(idx->uniq[k], &list, member->hash[k]);
+        }
+    }
+    free(member);
+    return ret;
+}
+
+void
+lyv_unique_index_remove(struct lyd_node *list)
+{
+    struct lys_node_list *slist = (struct lys_node_list *)list->schema;
+    struct lyd_unique_index *idx;
+    struct lyd_unique_member *member;
+    uint32_t hash;
+    uint8_t j;
+
+    if (!list->parent || (slist->nodetype != LYS_LIST) || !slist->unique_size) {
+        return;
+    }
+
+    idx = lyv_unique_index_find(list->parent, list->schema);
+    if (!idx) {
+        return;
+    }
+
+    hash = lyv_unique_node_hash(list);
+    if (lyht_find(idx->members, &list, hash, (void **)&member)) {
+        /* not indexed */
+        return;
+    }
+
+    /* the stored hashes are used, the unique values may have already changed */
+    for (j = 0; j < slist->unique_size; ++j) {
+        if (member->hash[j] && lyht_remove(idx->uniq[j], &list, member->hash[j])) {
+            assert(0);
+        }
+    }
+    lyht_remove(idx->members, &list, hash);
+}
+
+void
+lyv_unique_index_drop(struct lyd_node *list)
+{
+    struct ly_ctx *ctx = list->schema->module->ctx;
+    struct lyd_unique_index **first, **prev, *idx = NULL;
+
+    if (!list->parent || !__atomic_load_n(&ctx->uniq_idx_count, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    pthread_mutex_lock(&ctx->uniq_idx_lock);
+    first = lyv_unique_index_first(ctx, list->parent);
+    if (first) {
+        for (prev = first; *prev && ((*prev)->schema != list->schema); prev = &(*prev)->next);
+        idx = *prev;
+        if (!idx) {
+            /* no index of these instances */
+        } else if ((prev == first) && !idx->next) {
+            /* the only index of the parent */
+            lyht_remove(ctx->uniq_idx, &idx, lyv_unique_node_hash(list->parent));
+            __atomic_sub_fetch(&ctx->uniq_idx_count, 1, __ATOMIC_RELAXED);
+        } else {
+            /* the parent stays the same so the record can be changed in place */
+            *prev = idx->next;
+        }
+    }
+    pthread_mutex_unlock(&ctx->uniq_idx_lock);
+
+    lyv_unique_index_free_single(idx);
+}
+
+/**
+ * @brief Check list unique leaves using persistent index stored in the list parent.
+ *
+ * The index is created with all the instances when first needed, afterwards only the
+ * changed instances (with #LYD_VAL_UNIQUE) are re-added into it.
+ *
+ * @param[in] list List instance with a parent.
+ * @return 0 on success, non-zero on error.
+ */
+static int
+lyv_data_unique_index(struct lyd_node *list)
+{
+    struct lyd_unique_index *idx;
+    struct lyd_node *iter;
+    int ret;
+
+    idx = lyv_unique_index_find(list->parent, list->schema);
+    if (idx) {
+        /* only this instance was changed, index it again */
+        list->validity &= ~LYD_VAL_UNIQUE;
+        lyv_unique_index_remove(list);
+        ret = lyv_unique_index_add(idx, list);
+        if (ret) {
+            /* check it again next time */
+            list->validity |= LYD_VAL_UNIQUE;
+        }
+        return ret;
+    }
+
+    /* create the index with all the instances */
+    idx = lyv_unique_index_new(list->parent, list->schema);
+    if (!idx) {
+        return -1;
+    }
+    ret = 0;
+    LY_TREE_FOR(list->parent->child, iter) {
+        if (iter->schema != list->schema) {
+            continue;
+        }
+
+        /* remove the flag */
+        iter->validity &= ~LYD_VAL_UNIQUE;
+        if (!ret) {
+            ret = lyv_unique_index_add(idx, iter);
+        }
+    }
+
+    if (ret) {
+        /* the index is not complete, create it again the next time */
+        lyv_unique_index_drop(list);
+    }
+    return ret;
+}
+
+#endif
+
 int
 lyv_data_unique(struct lyd_node *list)
 {
-    struct lyd_node *diter;
     struct ly_set *set;
-    uint32_t i, j, n = 0;
-    int ret = 0;
+    uint32_t j, n = 0;
+    int r, ret = 0;
     uint32_t hash, u, usize = 0;
     struct hash_table **uniqtables = NULL;
-    const char *id;
     char *path;
     struct lys_node_list *slist;
     struct ly_ctx *ctx = list->schema->module->ctx;
@@ -255,6 +693,12 @@ lyv_data_unique(struct lyd_node *list)
         return 0;
     }
 
+#ifdef LY_ENABLED_CACHE
+    if (list->parent) {
+        return lyv_data_unique_index(list);
+    }
+#endif
+
     slist = (struct lys_node_list *)list->schema;
 
     /* get all list instances */
@@ -267,14 +711,14 @@ lyv_data_unique(struct lyd_node *list)
         return -1;
     }
 
-    for (i = 0; i < set->number; ++i) {
+    for (u = 0; u < set->number; ++u) {
         /* remove the flag */
-        set->set.d[i]->validity &= ~LYD_VAL_UNIQUE;
+        set->set.d[u]->validity &= ~LYD_VAL_UNIQUE;
     }
 
     if (set->number == 2) {
         /* simple comparison */
-        if (lyv_list_uniq_equal(&set->set.d[0], &set->set.d[1], 0, (void *)0)) {
+        if (lyv_list_uniq_equal(&set->set.d[1], &set->set.d[0], 0, (void *)0)) {
             /* instance duplication */
             ly_set_free(set);
             return 1;
@@ -318,37 +762,21 @@ lyv_data_unique(struct lyd_node *list)
         for (u = 0; u < set->number; u++) {
             /* loop for unique - get the hash for the instances */
             for (j = 0; j < n; j++) {
-                id = NULL;
-                for (i = hash = 0; i < slist->unique[j].expr_size; i++) {
-                    diter = resolve_data_descendant_schema_nodeid(slist->unique[j].expr[i], set->set.d[u]->child);
-                    if (diter) {
-                        id = ((struct lyd_node_leaf_list *)diter)->value_str;
-                    } else {
-                        /* use default value */
-                        if (lyd_get_unique_default(slist->unique[j].expr[i], set->set.d[u], &id)) {
-                            ret = -1;
-                            goto cleanup;
-                        }
-                    }
-                    if (!id) {
-                        /* unique item not present nor has default value */
-                        break;
-                    }
-                    hash = dict_hash_multi(hash, id, strlen(id));
-                }
-                if (!id) {
+                r = lyv_unique_hash(set->set.d[u], &slist->unique[j], &hash);
+                if (r == -1) {
+                    ret = -1;
+                    goto cleanup;
+                } else if (r) {
                     /* skip this list instance since its unique set is incomplete */
                     continue;
                 }
 
-                /* finish the hash value */
-                hash = dict_hash_multi(hash, NULL, 0);
-
-                /* insert into the hashtable */
-                if (lyht_insert(uniqtables[j], &set->set.d[u], hash, NULL)) {
+                /* check and insert into the hashtable */
+                if (!lyht_find(uniqtables[j], &set->set.d[u], hash, NULL)) {
                     ret = 1;
                     goto cleanup;
                 }
+                lyht_insert(uniqtables[j], &set->set.d[u], hash, NULL);
             }
         }
     }
@@ -445,9 +873,8 @@ lyv_data_dup(struct lyd_node *node, struct lyd_node *start)
     struct lyd_node *diter, *key;
     struct ly_set *set;
     int i, ret = 0;
-    uint32_t hash, u, usize = 0;
+    uint32_t hash, val_hash, u, usize = 0;
     struct hash_table *keystable = NULL;
-    const char *id;
     struct ly_ctx *ctx = node->schema->module->ctx;
 
     /* get the first list/leaflist instance sibling */
@@ -505,14 +932,14 @@ lyv_data_dup(struct lyd_node *node, struct lyd_node *start)
         for (u = 0; u < set->number; u++) {
             /* get the hash for the instance - keys */
             if (node->schema->nodetype == LYS_LEAFLIST) {
-                id = ((struct lyd_node_leaf_list *)set->set.d[u])->value_str;
-                hash = dict_hash_multi(0, id, strlen(id));
+                val_hash = lyd_value_hash(((struct lyd_node_leaf_list *)set->set.d[u])->value_str);
+                hash = dict_hash_multi(0, (char *)&val_hash, sizeof val_hash);
             } else { /* LYS_LIST */
                 for (hash = i = 0, key = set->set.d[u]->child;
                         i < ((struct lys_node_list *)set->set.d[u]->schema)->keys_size;
                         i++, key = key->next) {
-                    id = ((struct lyd_node_leaf_list *)key)->value_str;
-                    hash = dict_hash_multi(hash, id, strlen(id));
+                    val_hash = lyd_value_hash(((struct lyd_node_leaf_list *)key)->value_str);
+                    hash = dict_hash_multi(hash, (char *)&val_hash, sizeof val_hash);
                 }
             }
             /* finish the hash value */
@@ -811,6 +1238,10 @@ lyv_data_content(struct lyd_node *node, int options, struct unres_data *unres)
         if (options & LYD_OPT_TRUSTED) {
             /* just remove flag */
             node->validity &= ~LYD_VAL_UNIQUE;
+#ifdef LY_ENABLED_CACHE
+            /* the instance is not indexed */
+            lyv_unique_index_drop(node);
+#endif
         } else {
             /* check the unique constraint at the end (once the parsing is done) */
             if (unres_data_add(unres, node, UNRES_UNIQ_LEAVES)) {
@@ -952,3 +1383,196 @@ autodelete:
 
     return 0;
 }
+
+/**
+ * @brief Validation metrics record stored in ::ly_ctx#vmetrics.
+ */
+struct lyv_vmetric_rec {
+    const void *stmt;       /**< constraint statement */
+    struct lyd_vmetric m;
+};
+
+/* ht callback, records are equal if they belong to the same statement */
+static int
+lyv_vmetric_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct lyv_vmetric_rec *)val1_p)->stmt == ((struct lyv_vmetric_rec *)val2_p)->stmt;
+}
+
+static uint32_t
+lyv_vmetric_hash(const void *stmt)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&stmt, sizeof stmt);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+int
+lyv_vmetric_start(struct ly_ctx *ctx, struct timespec *start)
+{
+    /* enabling and disabling cannot happen during validation, so a quick check is fine */
+    if (!ctx->vmetrics) {
+        return 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, start);
+    return 1;
+}
+
+void
+lyv_vmetric_add(struct ly_ctx *ctx, LYD_VMETRIC_TYPE type, const void *stmt, const struct lys_node *snode,
+                const char *expr, const struct timespec *start)
+{
+    struct timespec end;
+    struct lyv_vmetric_rec rec, *match;
+    uint64_t time;
+    uint32_t hash;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    time = (end.tv_sec - start->tv_sec) * 1000000000ULL + end.tv_nsec - start->tv_nsec;
+
+    hash = lyv_vmetric_hash(stmt);
+    rec.stmt = stmt;
+
+    pthread_mutex_lock(&ctx->vmetrics_lock);
+
+    if (!lyht_find(ctx->vmetrics, &rec, hash, (void **)&match)) {
+        ++match->m.count;
+        match->m.time += time;
+    } else {
+        /* first evaluation of this constraint */
+        rec.m.type = type;
+        rec.m.path = lydict_insert_zc(ctx, lys_path(snode, LYS_PATH_FIRST_PREFIX));
+        rec.m.expr = lydict_insert(ctx, expr, 0);
+        rec.m.count = 1;
+        rec.m.time = time;
+        if (lyht_insert(ctx->vmetrics, &rec, hash, NULL)) {
+            lydict_remove(ctx, rec.m.path);
+            lydict_remove(ctx, rec.m.expr);
+        }
+    }
+
+    pthread_mutex_unlock(&ctx->vmetrics_lock);
+}
+
+static void
+lyv_vmetrics_clear(struct ly_ctx *ctx, struct hash_table *vmetrics)
+{
+    struct ht_rec *hrec;
+    struct lyv_vmetric_rec *rec;
+    uint32_t i;
+
+    for (i = 0; i < vmetrics->size; ++i) {
+        hrec = lyht_get_rec(vmetrics->recs, vmetrics->rec_size, i);
+        if (hrec->hits > 0) {
+            rec = (struct lyv_vmetric_rec *)hrec->val;
+            lydict_remove(ctx, rec->m.path);
+            lydict_remove(ctx, rec->m.expr);
+        }
+    }
+}
+
+void
+lyv_vmetrics_free(struct ly_ctx *ctx)
+{
+    if (!ctx->vmetrics) {
+        return;
+    }
+
+    lyv_vmetrics_clear(ctx, ctx->vmetrics);
+    lyht_free(ctx->vmetrics);
+    ctx->vmetrics = NULL;
+}
+
+API int
+lyd_vmetrics_enable(struct ly_ctx *ctx, int enable)
+{
+    FUN_IN;
+
+    if (!ctx) {
+        LOGARG;
+        return -1;
+    }
+
+    if (!enable) {
+        lyv_vmetrics_free(ctx);
+    } else if (!ctx->vmetrics) {
+        ctx->vmetrics = lyht_new(16, sizeof(struct lyv_vmetric_rec), lyv_vmetric_equal, NULL, 1);
+        LY_CHECK_ERR_RETURN(!ctx->vmetrics, LOGMEM(ctx), -1);
+    }
+
+    return 0;
+}
+
+static int
+lyv_vmetric_cmp(const void *ptr1, const void *ptr2)
+{
+    const struct lyd_vmetric *m1 = ptr1, *m2 = ptr2;
+
+    /* descending order by time */
+    if (m1->time == m2->time) {
+        return 0;
+    }
+    return (m1->time < m2->time) ? 1 : -1;
+}
+
+API struct lyd_vmetric *
+lyd_vmetrics_get(struct ly_ctx *ctx, uint32_t *count)
+{
+    FUN_IN;
+
+    struct lyd_vmetric *metrics = NULL;
+    struct ht_rec *hrec;
+    uint32_t i;
+
+    if (!ctx || !count) {
+        LOGARG;
+        return NULL;
+    }
+    *count = 0;
+
+    if (!ctx->vmetrics) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ctx->vmetrics_lock);
+
+    if (ctx->vmetrics->used) {
+        metrics = malloc(ctx->vmetrics->used * sizeof *metrics);
+        LY_CHECK_ERR_GOTO(!metrics, LOGMEM(ctx), cleanup);
+
+        for (i = 0; i < ctx->vmetrics->size; ++i) {
+            hrec = lyht_get_rec(ctx->vmetrics->recs, ctx->vmetrics->rec_size, i);
+            if (hrec->hits > 0) {
+                metrics[(*count)++] = ((struct lyv_vmetric_rec *)hrec->val)->m;
+            }
+        }
+        qsort(metrics, *count, sizeof *metrics, lyv_vmetric_cmp);
+    }
+
+cleanup:
+    pthread_mutex_unlock(&ctx->vmetrics_lock);
+    return metrics;
+}
+
+API void
+lyd_vmetrics_reset(struct ly_ctx *ctx)
+{
+    FUN_IN;
+
+    struct hash_table *vmetrics;
+
+    if (!ctx || !ctx->vmetrics) {
+        return;
+    }
+
+    vmetrics = lyht_new(16, sizeof(struct lyv_vmetric_rec), lyv_vmetric_equal, NULL, 1);
+    LY_CHECK_ERR_RETURN(!vmetrics, LOGMEM(ctx), );
+
+    pthread_mutex_lock(&ctx->vmetrics_lock);
+    lyv_vmetrics_clear(ctx, ctx->vmetrics);
+    lyht_free(ctx->vmetrics);
+    ctx->vmetrics = vmetrics;
+    pthread_mutex_unlock(&ctx->vmetrics_lock);
+}
@@ -15,6 +15,8 @@
 #ifndef LY_VALIDATION_H_
 #define LY_VALIDATION_H_
 
+#include <time.h>
+
 #include "libyang.h"
 #include "resolve.h"
 #include "tree_data.h"
@@ -52,11 +54,59 @@ int lyv_data_content(struct lyd_node *node, int options, struct unres_data *unre
 /**
  * @brief Check list unique leaves.
  *
+ * With cache enabled, the instances with a parent are checked using a persistent index
+ * of their unique values (::lyd_unique_index) stored in the context.
+ *
  * @param[in] list List node to be checked.
  * @return 0 on success, non-zero on error.
  */
 int lyv_data_unique(struct lyd_node *list);
 
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Index of unique values of list instances, stored in the context (::ly_ctx#uniq_idx) by their parent.
+ */
+struct lyd_unique_index {
+    const struct lyd_node *parent;      /**< parent of the indexed list instances */
+    const struct lys_node *schema;      /**< schema node of the indexed list instances */
+    struct hash_table *members;         /**< all the indexed instances with the hashes of their unique values */
+    struct hash_table **uniq;           /**< instances hashed by their values of each unique statement of the list */
+    struct lyd_unique_index *next;      /**< index of another list in the same parent */
+};
+
+/**
+ * @brief Free all the unique indexes of a parent. Must be called before the parent is freed.
+ *
+ * @param[in] parent Parent of list instances.
+ */
+void lyv_unique_index_free(const struct lyd_node *parent);
+
+/**
+ * @brief Free all the unique indexes in a context, of the data trees that were not freed.
+ *
+ * @param[in] ctx Context with the indexes.
+ */
+void lyv_unique_index_clean(struct ly_ctx *ctx);
+
+/**
+ * @brief Remove a list instance from the unique index of its parent, if there is one. Must be called
+ * before the instance is unlinked.
+ *
+ * @param[in] list List instance.
+ */
+void lyv_unique_index_remove(struct lyd_node *list);
+
+/**
+ * @brief Drop the whole unique index of a list instance siblings, it will be created again
+ * when the instances are validated next time.
+ *
+ * @param[in] list List instance.
+ */
+void lyv_unique_index_drop(struct lyd_node *list);
+
+#endif
+
 /**
  * @brief Check for list/leaflist instance duplications.
  *
@@ -85,4 +135,33 @@ int lyv_data_dup(struct lyd_node *node, struct lyd_node *start);
 int lyv_multicases(struct lyd_node *node, struct lys_node *schemanode, struct lyd_node **first_sibling, int autodelete,
                    struct lyd_node *nodel);
 
+/**
+ * @brief Start measuring evaluation of a constraint, if validation metrics are enabled.
+ *
+ * @param[in] ctx Context of the data.
+ * @param[out] start Start time.
+ * @return 1 if the evaluation is being measured and ::lyv_vmetric_add() should be called, 0 otherwise.
+ */
+int lyv_vmetric_start(struct ly_ctx *ctx, struct timespec *start);
+
+/**
+ * @brief Add an evaluation of a constraint into the validation metrics.
+ *
+ * @param[in] ctx Context of the data.
+ * @param[in] type Constraint type.
+ * @param[in] stmt Constraint statement identifying it.
+ * @param[in] snode Schema node with the constraint.
+ * @param[in] expr Constraint expression, if any.
+ * @param[in] start Start time from ::lyv_vmetric_start().
+ */
+void lyv_vmetric_add(struct ly_ctx *ctx, LYD_VMETRIC_TYPE type, const void *stmt, const struct lys_node *snode,
+                     const char *expr, const struct timespec *start);
+
+/**
+ * @brief Free all the validation metrics of a context.
+ *
+ * @param[in] ctx Context to use.
+ */
+void lyv_vmetrics_free(struct ly_ctx *ctx);
+
 #endif /* LY_VALIDATION_H_ */
@@ -222,7 +222,7 @@ lyxml_correct_elem_ns(struct ly_ctx *ctx, struct lyxml_elem *elem, struct lyxml_
     LY_TREE_DFS_BEGIN(elem, tmp, iter) {
         if (iter->ns) {
             /* find the root of elem NS */
-            for (ns_root = iter->ns->parent; ns_root; ns_root = ns_root->parent);
+            for (ns_root = iter->ns->parent; ns_root && ns_root->parent; ns_root = ns_root->parent);
 
             /* elem NS is defined outside elem subtree */
             if (ns_root != elem_root) {
@@ -867,18 +867,14 @@ parse_attr(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml
                 /* attribute in a namespace (but disregard the special "xml" namespace) */
                 start = c + 1;
 
-                /* look for the prefix in namespaces */
+                /* remember the prefix for resolution after all the element namespaces are known */
                 prefix = malloc((c - data + 1) * sizeof *prefix);
                 LY_CHECK_ERR_GOTO(!prefix, LOGMEM(ctx), error);
                 memcpy(prefix, data, c - data);
                 prefix[c - data] = '\0';
-                attr->ns = lyxml_get_ns(parent, prefix);
-                if (!attr->ns) {
-                    /* remember the prefix for later resolution */
-                    attr->type = LYXML_ATTR_STD_UNRES;
-                    attr->ns = (struct lyxml_ns *)prefix;
-                    prefix = NULL;
-                }
+                attr->type = LYXML_ATTR_STD_UNRES;
+                attr->ns = (struct lyxml_ns *)prefix;
+                prefix = NULL;
             } else if (((*c == 'm') && (xml_flag == 1)) ||
                     ((*c == 'l') && (xml_flag == 2))) {
                 ++xml_flag;
@@ -938,9 +934,159 @@ error:
     return NULL;
 }
 
+/**
+ * @brief Record of the namespace scope hash table, the innermost declaration of a prefix.
+ */
+struct lyxml_ns_scope_rec {
+    const char *prefix;         /* declared prefix, NULL for the default namespace */
+    struct lyxml_ns *ns;        /* innermost declaration */
+};
+
+/**
+ * @brief Namespaces in scope of the element being parsed. Prefixes are resolved using the hash table,
+ * declarations shadowed by nested elements are kept on the stack and restored when their elements end.
+ */
+struct lyxml_ns_scope {
+    struct hash_table *ht;      /* prefix -> innermost declaration, see struct lyxml_ns_scope_rec */
+    struct {
+        const char *prefix;     /* prefix declared by the element */
+        struct lyxml_ns *shadowed; /* previous declaration of the prefix, NULL if there was none */
+    } *stack;
+    uint32_t used;
+    uint32_t size;
+};
+
+static int
+lyxml_ns_scope_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyxml_ns_scope_rec *rec1, *rec2;
+
+    rec1 = (struct lyxml_ns_scope_rec *)val1_p;
+    rec2 = (struct lyxml_ns_scope_rec *)val2_p;
+
+    if (!rec1->prefix || !rec2->prefix) {
+        return rec1->prefix == rec2->prefix;
+    }
+    return !strcmp(rec1->prefix, rec2->prefix);
+}
+
+static uint32_t
+lyxml_ns_scope_hash(const char *prefix)
+{
+    /* the default namespace has the hash of an empty prefix, which cannot be declared */
+    return dict_hash_multi(dict_hash_multi(0, prefix, prefix ? strlen(prefix) : 0), NULL, 0);
+}
+
+/**
+ * @brief Equivalent of lyxml_get_ns() for the element being parsed.
+ *
+ * @param[in] scope Namespaces in scope.
+ * @param[in] prefix Prefix to resolve, NULL for the default namespace.
+ * @return Namespace declaration, NULL if there is none.
+ */
+static struct lyxml_ns *
+lyxml_ns_scope_get(struct lyxml_ns_scope *scope, const char *prefix)
+{
+    struct lyxml_ns_scope_rec rec, *match;
+
+    rec.prefix = prefix;
+    rec.ns = NULL;
+    if (lyht_find(scope->ht, &rec, lyxml_ns_scope_hash(prefix), (void **)&match)) {
+        return NULL;
+    }
+    if (!prefix && !match->ns->value) {
+        /* empty default namespace -> no default namespace */
+        return NULL;
+    }
+    return match->ns;
+}
+
+/**
+ * @brief Bring the namespaces declared by an element into scope.
+ *
+ * @param[in] ctx libyang context for logging.
+ * @param[in] scope Namespaces in scope.
+ * @param[in] elem Element with the complete start tag.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lyxml_ns_scope_push(struct ly_ctx *ctx, struct lyxml_ns_scope *scope, struct lyxml_elem *elem)
+{
+    struct lyxml_attr *attr;
+    struct lyxml_ns_scope_rec rec, *match;
+    struct lyxml_ns *shadowed;
+    uint32_t hash;
+    void *new;
+
+    for (attr = elem->attr; attr; attr = attr->next) {
+        if (attr->type != LYXML_ATTR_NS) {
+            continue;
+        }
+
+        rec.prefix = attr->name;
+        rec.ns = (struct lyxml_ns *)attr;
+        hash = lyxml_ns_scope_hash(rec.prefix);
+        if (!lyht_find(scope->ht, &rec, hash, (void **)&match)) {
+            if (match->ns->parent == elem) {
+                /* the first declaration in an element wins */
+                continue;
+            }
+            shadowed = match->ns;
+            *match = rec;
+        } else {
+            shadowed = NULL;
+            if (lyht_insert(scope->ht, &rec, hash, NULL)) {
+                LOGINT(ctx);
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (scope->used == scope->size) {
+            new = realloc(scope->stack, (scope->size ? scope->size * 2 : 16) * sizeof *scope->stack);
+            LY_CHECK_ERR_RETURN(!new, LOGMEM(ctx), EXIT_FAILURE);
+            scope->stack = new;
+            scope->size = scope->size ? scope->size * 2 : 16;
+        }
+        scope->stack[scope->used].prefix = attr->name;
+        scope->stack[scope->used].shadowed = shadowed;
+        ++scope->used;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Remove the namespaces of ended elements from scope.
+ *
+ * @param[in] scope Namespaces in scope.
+ * @param[in] depth Number of stacked declarations to keep.
+ */
+static void
+lyxml_ns_scope_pop(struct lyxml_ns_scope *scope, uint32_t depth)
+{
+    struct lyxml_ns_scope_rec rec, *match;
+    uint32_t hash;
+
+    while (scope->used > depth) {
+        --scope->used;
+        rec.prefix = scope->stack[scope->used].prefix;
+        rec.ns = NULL;
+        hash = lyxml_ns_scope_hash(rec.prefix);
+        if (scope->stack[scope->used].shadowed) {
+            if (!lyht_find(scope->ht, &rec, hash, (void **)&match)) {
+                match->ns = scope->stack[scope->used].shadowed;
+                match->prefix = match->ns->prefix;
+            }
+        } else {
+            lyht_remove(scope->ht, &rec, hash);
+        }
+    }
+}
+
 /* logs directly */
-struct lyxml_elem *
-lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent, int options)
+static struct lyxml_elem *
+lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent, int options,
+                 struct lyxml_ns_scope *scope)
 {
     const char *c = data, *start, *e;
     const char *lws;    /* leading white space for handling mixed content */
@@ -951,6 +1097,7 @@ lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct
     struct lyxml_elem *elem = NULL, *child;
     struct lyxml_attr *attr;
     unsigned int size;
+    uint32_t depth = scope->used;
     int nons_flag = 0, closed_flag = 0;
 
     *len = 0;
@@ -1013,6 +1160,23 @@ lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct
 
 process:
     ign_xmlws(c);
+    if (!strncmp("/>", c, 2) || (*c == '>')) {
+        /* the start tag is complete, resolve its prefixes */
+        if (lyxml_ns_scope_push(ctx, scope, elem)) {
+            goto error;
+        }
+        LY_TREE_FOR(elem->attr, attr) {
+            if (attr->type == LYXML_ATTR_STD_UNRES) {
+                str = (char *)attr->ns;
+                attr->ns = lyxml_ns_scope_get(scope, str);
+                free(str);
+                attr->type = LYXML_ATTR_STD;
+            }
+        }
+        if (!elem->ns && !nons_flag && parent) {
+            elem->ns = lyxml_ns_scope_get(scope, prefix_len ? prefix : NULL);
+        }
+    }
     if (!strncmp("/>", c, 2)) {
         /* we are done, it was EmptyElemTag */
         c += 2;
@@ -1138,7 +1302,7 @@ process:
                     lyxml_add_child(ctx, elem, child);
                     elem->flags |= LYXML_ELEM_MIXED;
                 }
-                child = lyxml_parse_elem(ctx, c, &size, elem, options);
+                child = lyxml_parse_elem(ctx, c, &size, elem, options, scope);
                 if (!child) {
                     goto error;
                 }
@@ -1211,23 +1375,13 @@ store_content:
         goto error;
     }
 
-    /* resolve all attribute prefixes */
-    LY_TREE_FOR(elem->attr, attr) {
-        if (attr->type == LYXML_ATTR_STD_UNRES) {
-            str = (char *)attr->ns;
-            attr->ns = lyxml_get_ns(elem, str);
-            free(str);
-            attr->type = LYXML_ATTR_STD;
-        }
-    }
-
-    if (!elem->ns && !nons_flag && parent) {
-        elem->ns = lyxml_get_ns(parent, prefix_len ? prefix : NULL);
-    }
+    lyxml_ns_scope_pop(scope, depth);
     free(prefix);
     return elem;
 
 error:
+    /* the declarations must not be used after the element is freed */
+    lyxml_ns_scope_pop(scope, depth);
     lyxml_free(ctx, elem);
     free(prefix);
     return NULL;
@@ -1242,18 +1396,22 @@ lyxml_parse_mem(struct ly_ctx *ctx, const char *data, int options)
     const char *c = data;
     unsigned int len;
     struct lyxml_elem *root, *first = NULL, *next;
+    struct lyxml_ns_scope scope = {NULL, NULL, 0, 0};
 
     if (!ctx) {
         LOGARG;
         return NULL;
     }
 
+    scope.ht = lyht_new(8, sizeof(struct lyxml_ns_scope_rec), lyxml_ns_scope_equal, NULL, 1);
+    LY_CHECK_ERR_RETURN(!scope.ht, LOGMEM(ctx), NULL);
+
 repeat:
     /* process document */
     while (1) {
         if (!*c) {
             /* eof */
-            return first;
+            goto cleanup;
         } else if (is_xmlws(*c)) {
             /* skip whitespaces */
             ign_xmlws(c);
@@ -1287,7 +1445,7 @@ repeat:
         }
     }
 
-    root = lyxml_parse_elem(ctx, c, &len, NULL, options);
+    root = lyxml_parse_elem(ctx, c, &len, NULL, options, &scope);
     if (!root) {
         goto error;
     } else if (!first) {
@@ -1311,13 +1469,17 @@ repeat:
         }
     }
 
+cleanup:
+    lyht_free(scope.ht);
+    free(scope.stack);
     return first;
 
 error:
     LY_TREE_FOR_SAFE(first, next, root) {
         lyxml_free(ctx, root);
     }
-    return NULL;
+    first = NULL;
+    goto cleanup;
 }
 
 API struct lyxml_elem *
@@ -1365,27 +1527,40 @@ error:
 int
 lyxml_dump_text(struct lyout *out, const char *text, LYXML_DATA_TYPE type)
 {
-    unsigned int i, n;
+    size_t i, len, run;
+    unsigned int n;
 
     if (!text) {
         return 0;
     }
 
-    for (i = n = 0; text[i]; i++) {
+    len = strlen(text);
+    for (i = n = 0; i < len; i++) {
+        /* write the characters not needing an escape at once */
+        run = ly_strlen_noesc(text + i, len - i, 0);
+        if (run) {
+            ly_write(out, text + i, run);
+            n += run;
+            i += run;
+            if (i == len) {
+                break;
+            }
+        }
+
         switch (text[i]) {
         case '&':
-            n += ly_print(out, "&amp;");
+            n += ly_write(out, "&amp;", 5);
             break;
         case '<':
-            n += ly_print(out, "&lt;");
+            n += ly_write(out, "&lt;", 4);
             break;
         case '>':
             /* not needed, just for readability */
-            n += ly_print(out, "&gt;");
+            n += ly_write(out, "&gt;", 4);
             break;
         case '"':
             if (type == LYXML_DATA_ATTR) {
-                n += ly_print(out, "&quot;");
+                n += ly_write(out, "&quot;", 6);
                 break;
             }
             /* falls through */
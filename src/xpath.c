@@ -26,6 +26,7 @@
 #include <limits.h>
 #include <errno.h>
 #include <math.h>
+#include <float.h>
 #include <pcre.h>
 
 #include "xpath.h"
@@ -591,6 +592,69 @@ cast_string_to_number(const char *str)
     return num;
 }
 
+/**
+ * @brief Cast a leaf into an XPath number using its typed value.
+ *
+ * @param[in] leaf Leaf to use.
+ * @param[out] num Cast number.
+ *
+ * @return 1 if the value was cast, 0 if the string value must be cast instead.
+ */
+static int
+cast_leaf_to_number(const struct lyd_node_leaf_list *leaf, long double *num)
+{
+    struct lys_type *type;
+    long double div;
+    int i;
+
+    type = lyd_leaf_type_typed(leaf);
+    if (!type) {
+        return 0;
+    }
+
+    switch (type->base) {
+    case LY_TYPE_INT8:
+        *num = leaf->value.int8;
+        break;
+    case LY_TYPE_INT16:
+        *num = leaf->value.int16;
+        break;
+    case LY_TYPE_INT32:
+        *num = leaf->value.int32;
+        break;
+    case LY_TYPE_INT64:
+        *num = leaf->value.int64;
+        break;
+    case LY_TYPE_UINT8:
+        *num = leaf->value.uint8;
+        break;
+    case LY_TYPE_UINT16:
+        *num = leaf->value.uint16;
+        break;
+    case LY_TYPE_UINT32:
+        *num = leaf->value.uint32;
+        break;
+    case LY_TYPE_UINT64:
+        *num = leaf->value.uint64;
+        break;
+    case LY_TYPE_DEC64:
+        /* the division is exact (as parsing the string would be) only if the value fits the mantissa */
+        if ((leaf->value.dec64 >= (1LL << (LDBL_MANT_DIG < 63 ? LDBL_MANT_DIG : 62)))
+                || (leaf->value.dec64 <= -(1LL << (LDBL_MANT_DIG < 63 ? LDBL_MANT_DIG : 62)))) {
+            return 0;
+        }
+        for (i = 0, div = 1; i < type->info.dec64.dig; ++i) {
+            div *= 10;
+        }
+        *num = leaf->value.dec64 / div;
+        break;
+    default:
+        return 0;
+    }
+
+    return 1;
+}
+
 /*
  * lyxp_set manipulation functions
  */
@@ -1499,14 +1563,66 @@ set_sort_compare(struct lyxp_set_node *item1, struct lyxp_set_node *item2,
     return -1;
 }
 
+/**
+ * @brief Get a node-set item as a leaf, if its value can be used directly.
+ *
+ * @param[in] set Set with the item.
+ * @param[in] idx Index of the item.
+ *
+ * @return Leaf, NULL if the item is not a leaf or it must be cast the standard way.
+ */
+static struct lyd_node_leaf_list *
+set_item_leaf(const struct lyxp_set *set, uint32_t idx)
+{
+    struct lyd_node *node;
+
+    if (set->val.nodes[idx].type != LYXP_NODE_ELEM) {
+        return NULL;
+    }
+
+    node = set->val.nodes[idx].node;
+    if (!(node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) || (node->validity & LYD_VAL_INUSE)) {
+        return NULL;
+    }
+
+    return (struct lyd_node_leaf_list *)node;
+}
+
 static int
 set_comp_cast(struct lyxp_set *trg, struct lyxp_set *src, enum lyxp_set_type type, const struct lyd_node *cur_node,
               const struct lys_module *local_mod, uint32_t src_idx, int options)
 {
+    struct lyd_node_leaf_list *leaf;
+    long double num;
+
     assert(src->type == LYXP_SET_NODE_SET);
 
     memset(trg, 0, sizeof *trg);
 
+    /* leaves can be cast directly from their values */
+    leaf = set_item_leaf(src, src_idx);
+    if (leaf) {
+        switch (type) {
+        case LYXP_SET_NUMBER:
+            if (cast_leaf_to_number(leaf, &num)) {
+                set_fill_number(trg, num);
+                return EXIT_SUCCESS;
+            }
+            break;
+        case LYXP_SET_STRING:
+            trg->type = LYXP_SET_STRING;
+            trg->val.str = strdup(leaf->value_str ? leaf->value_str : "");
+            LY_CHECK_ERR_RETURN(!trg->val.str, LOGMEM(local_mod->ctx), -1);
+            return EXIT_SUCCESS;
+        case LYXP_SET_BOOLEAN:
+            /* non-empty node-set */
+            set_fill_boolean(trg, 1);
+            return EXIT_SUCCESS;
+        default:
+            break;
+        }
+    }
+
     /* insert node into target set */
     set_insert_node(trg, src->val.nodes[src_idx].node, src->val.nodes[src_idx].pos, src->val.nodes[src_idx].type, 0);
 
@@ -5335,6 +5451,7 @@ moveto_resolve_model(const char *mod_name_ns, uint16_t mod_nam_ns_len, struct ly
                      int is_name, int import_and_disabled_model)
 {
     uint16_t i;
+    int r;
     const char *str;
     struct lys_module *mod, *mainmod;
 
@@ -5363,6 +5480,19 @@ moveto_resolve_model(const char *mod_name_ns, uint16_t mod_nam_ns_len, struct ly
         }
     }
 
+    if (!import_and_disabled_model && mod_nam_ns_len) {
+        /* there is only one implemented module with a name/namespace, use the index if available */
+        mod = NULL;
+        while (!(r = ly_ctx_mod_idx_next(ctx, mod_name_ns, mod_nam_ns_len, !is_name, &mod))) {
+            if (mod->implemented && !mod->disabled) {
+                return mod;
+            }
+        }
+        if (r != -1) {
+            return NULL;
+        }
+    }
+
     for (i = 0; i < ctx->models.used; ++i) {
         if (!import_and_disabled_model && (!ctx->models.list[i]->implemented || ctx->models.list[i]->disabled)) {
             /* skip not implemented or disabled modules */
@@ -6733,6 +6863,98 @@ moveto_snode_parent(struct lyxp_set *set, struct lys_node *cur_node, int all_des
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Compare 2 node-sets of leaves using their values directly, without casting every leaf
+ *        into a string and comparing the strings.
+ *
+ * @param[in] set1 First node-set.
+ * @param[in] set2 Second node-set.
+ * @param[in] op Comparison operator.
+ *
+ * @return 1 or 0 as the result of the comparison, -1 if the values cannot be compared this way.
+ */
+static int
+set_comp_typed(const struct lyxp_set *set1, const struct lyxp_set *set2, const char *op)
+{
+    const struct lyxp_set *set;
+    struct lyd_node_leaf_list *leaf1, *leaf2;
+    struct lys_type *type, *first_type = NULL;
+    long double num1 = 0, num2 = 0;
+    uint32_t i, j;
+    int k, eq, result;
+
+    eq = ((op[0] == '=') || (op[0] == '!'));
+
+    /* check that all the values can be used */
+    for (k = 0; k < 2; ++k) {
+        set = (k ? set2 : set1);
+        for (i = 0; i < set->used; ++i) {
+            leaf1 = set_item_leaf(set, i);
+            if (!leaf1) {
+                return -1;
+            }
+
+            if (!eq) {
+                if (!cast_leaf_to_number(leaf1, &num1)) {
+                    return -1;
+                }
+                continue;
+            }
+
+            /* canonical values in the dictionary can be compared directly if they all have the same type,
+             * otherwise a value would be canonized for the type of the other one */
+            type = lyd_leaf_type_typed(leaf1);
+            if (!type) {
+                return -1;
+            }
+            switch (type->base) {
+            case LY_TYPE_BITS:
+            case LY_TYPE_INST:
+            case LY_TYPE_BINARY:
+                return -1;
+            default:
+                break;
+            }
+            if (!first_type) {
+                first_type = type;
+            } else if ((type->base != first_type->base)
+                    || ((type->base == LY_TYPE_DEC64) && (type->info.dec64.dig != first_type->info.dec64.dig))) {
+                return -1;
+            }
+        }
+    }
+
+    for (i = 0; i < set1->used; ++i) {
+        leaf1 = (struct lyd_node_leaf_list *)set1->val.nodes[i].node;
+        if (!eq) {
+            cast_leaf_to_number(leaf1, &num1);
+        }
+
+        for (j = 0; j < set2->used; ++j) {
+            leaf2 = (struct lyd_node_leaf_list *)set2->val.nodes[j].node;
+            if (eq) {
+                result = (leaf1->value_str == leaf2->value_str);
+                if (op[0] == '!') {
+                    result = !result;
+                }
+            } else {
+                cast_leaf_to_number(leaf2, &num2);
+                if (op[0] == '<') {
+                    result = (op[1] == '=') ? (num1 <= num2) : (num1 < num2);
+                } else {
+                    result = (op[1] == '=') ? (num1 >= num2) : (num1 > num2);
+                }
+            }
+
+            if (result) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief Move context \p set to the result of a comparison. Handles '=', '!=', '<=', '<', '>=', or '>'.
  *        Result is LYXP_SET_BOOLEAN. Indirectly context position aware.
@@ -6788,6 +7010,15 @@ moveto_op_comp(struct lyxp_set *set1, struct lyxp_set *set2, const char *op, str
     iter1.type = LYXP_SET_EMPTY;
     iter2.type = LYXP_SET_EMPTY;
 
+    /* comparing leaves, try their values directly */
+    if ((set1->type == LYXP_SET_NODE_SET) && (set2->type == LYXP_SET_NODE_SET)) {
+        result = set_comp_typed(set1, set2, op);
+        if (result > -1) {
+            set_fill_boolean(set1, result);
+            return EXIT_SUCCESS;
+        }
+    }
+
     /* iterative evaluation with node-sets */
     if (LYXP_IS_NODE_SET_OR_EMPTY(set1->type) || LYXP_IS_NODE_SET_OR_EMPTY(set2->type)) {
         if (LYXP_IS_NODE_SET_OR_EMPTY(set1->type)) {
@@ -8812,6 +9043,8 @@ lyxp_set_print_xml(FILE *f, struct lyxp_set *set)
         }
         break;
     }
+
+    ly_print_frags_free(&out);
 }
 
 #endif
@@ -630,12 +630,55 @@ test_ly_ctx_remove_module2(void **state)
     /* ... make sure that x is still present ... */
     mod = ly_ctx_get_module(ctx, "x", NULL, 0);
     assert_ptr_not_equal(mod, NULL);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "uri:x", NULL, 0), mod);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "uri:y", NULL, 0), NULL);
 
     /* ... and check that the backlinks in it were removed */
     assert_true(!mod->features[0].depfeatures || !mod->features[0].depfeatures->number);
     assert_true(!mod->ident[0].der || !mod->ident[0].der->number);
 }
 
+static void
+test_ly_ctx_get_module_revisions(void **state)
+{
+    (void) state; /* unused */
+    const struct lys_module *a_new, *a_old, *c;
+
+    ctx = ly_ctx_new(TESTS_DIR"/api/files/", 0);
+    assert_ptr_not_equal(ctx, NULL);
+
+    /* the newest revision of a is implemented, c imports the older one */
+    a_new = lys_parse_path(ctx, TESTS_DIR"/api/files/a.yin", LYS_IN_YIN);
+    assert_ptr_not_equal(a_new, NULL);
+    c = ly_ctx_load_module(ctx, "c", NULL);
+    assert_ptr_not_equal(c, NULL);
+    a_old = ly_ctx_get_module(ctx, "a", "2015-01-01", 0);
+    assert_ptr_not_equal(a_old, NULL);
+    assert_ptr_not_equal(a_old, a_new);
+
+    assert_ptr_equal(ly_ctx_get_module(ctx, "a", NULL, 0), a_new);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "a", NULL, 1), a_new);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "a", "2016-03-01", 0), a_new);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "a", "2014-01-01", 0), NULL);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "urn:a", NULL, 0), a_new);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "urn:a", "2015-01-01", 0), a_old);
+    assert_ptr_equal(lys_implemented_module(a_old), a_new);
+
+    /* disabled modules are not found */
+    assert_int_equal(lys_set_disabled(c), 0);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "c", NULL, 0), NULL);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "urn:c", NULL, 0), NULL);
+    assert_true(c->disabled);
+    assert_int_equal(lys_set_enabled(c), 0);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "c", NULL, 0), c);
+
+    /* removing c removes also the older revision of a */
+    assert_int_equal(ly_ctx_remove_module(c, NULL), 0);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "c", NULL, 0), NULL);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "a", "2015-01-01", 0), NULL);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "urn:a", NULL, 0), a_new);
+}
+
 static void
 test_lys_set_enabled(void **state)
 {
@@ -1122,6 +1165,66 @@ test_ly_log_options(void **state)
     assert_null(i);
 }
 
+static void
+test_ly_log_errlimit(void **state)
+{
+    (void)state;
+    const struct ly_err_item *i;
+    const struct lys_module *mod;
+    struct lyd_node *data;
+    char *path;
+    int count;
+    const char *yang = "module errlim {namespace urn:errlim; prefix el;"
+        "leaf-list target {type string;}"
+        "list l {key name; leaf name {type string;} leaf ref {type leafref {path /target;}}}}";
+    const char *xml = "<target xmlns=\"urn:errlim\">a</target>"
+        "<l xmlns=\"urn:errlim\"><name>x</name><ref>b</ref></l>";
+
+    ly_set_log_clb(NULL, 1);
+    ly_log_options(LY_LOSTORE);
+    assert_int_equal(ly_log_errlimit(2), 0);
+
+    for (count = 0; count < 5; ++count) {
+        path = ly_path_data2schema(ctx, "/a:f/g/h");
+        assert_null(path);
+        assert_int_equal(ly_errno, LY_EVALID);
+    }
+
+    /* only the first 2 errors are stored */
+    count = 0;
+    for (i = ly_err_first(ctx); i; i = i->next) {
+        assert_string_equal(i->path, "f");
+        ++count;
+    }
+    assert_int_equal(count, 2);
+
+    /* removing the last error makes room for exactly one more */
+    ly_err_clean(ctx, ly_err_first(ctx)->next);
+    for (count = 0; count < 3; ++count) {
+        assert_null(ly_path_data2schema(ctx, "/a:f/g/h"));
+    }
+    count = 0;
+    for (i = ly_err_first(ctx); i; i = i->next) {
+        ++count;
+    }
+    assert_int_equal(count, 2);
+
+    /* storing works again after cleaning */
+    ly_err_clean(ctx, NULL);
+    assert_int_equal(ly_log_errlimit(0), 2);
+
+    /* the data path of an error generated during data unres resolution */
+    mod = lys_parse_mem(ctx, yang, LYS_IN_YANG);
+    assert_non_null(mod);
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_null(data);
+    assert_int_equal(ly_vecode(ctx), LYVE_NOLEAFREF);
+    assert_string_equal(ly_errpath(ctx), "/errlim:l[name='x']/ref");
+
+    ly_log_options(LY_LOLOG | LY_LOSTORE_LAST);
+    ly_err_clean(ctx, NULL);
+}
+
 static void
 test_ly_path_data2schema(void **state)
 {
@@ -1616,6 +1719,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_ly_ctx_load_module, setup_f, teardown_f),
         cmocka_unit_test_teardown(test_ly_ctx_remove_module, teardown_f),
         cmocka_unit_test_teardown(test_ly_ctx_remove_module2, teardown_f),
+        cmocka_unit_test_teardown(test_ly_ctx_get_module_revisions, teardown_f),
         cmocka_unit_test_teardown(test_lys_set_enabled, teardown_f),
         cmocka_unit_test_teardown(test_lys_set_disabled, teardown_f),
         cmocka_unit_test(test_ly_ctx_clean),
@@ -1632,6 +1736,7 @@ int main(void)
         cmocka_unit_test(test_ly_get_log_clb),
         cmocka_unit_test(test_ly_set_log_clb),
         cmocka_unit_test_setup_teardown(test_ly_log_options, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_ly_log_errlimit, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_path_data2schema, setup_f, teardown_f),
         cmocka_unit_test(test_ly_get_loaded_plugins),
         cmocka_unit_test(test_ly_ctx_internal_modules_count),
@@ -227,12 +227,78 @@ test_dup_to_ctx_leafrefs(void **state)
     free(printed);
 }
 
+static void
+test_dup_subtree(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod;
+    const char *sch = "module x {"
+                    "  namespace urn:x;"
+                    "  prefix x;"
+                    "  identity base;"
+                    "  identity one { base base; }"
+                    "  container c {"
+                    "    list l {"
+                    "      key k;"
+                    "      leaf k { type string; }"
+                    "      leaf e { type enumeration { enum a; enum b; } }"
+                    "      leaf b { type bits { bit x; bit y; } }"
+                    "      leaf i { type identityref { base base; } }}}}";
+    const char *data = "<c xmlns=\"urn:x\">"
+                    "<l><k>1</k><e>a</e><b>y</b><i>one</i></l>"
+                    "<l><k>2</k><e>b</e><b>x y</b><i>one</i></l>"
+                    "<l><k>3</k></l><l><k>4</k></l><l><k>5</k></l></c>";
+    struct lyd_node_leaf_list *leaf1, *leaf2;
+    struct ly_set *set;
+    char *str1, *str2;
+
+    mod = lys_parse_mem(st->ctx1, sch, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+
+    st->dt1 = lyd_parse_mem(st->ctx1, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    st->dt2 = lyd_dup(st->dt1, LYD_DUP_OPT_RECURSIVE);
+    assert_ptr_not_equal(st->dt2, NULL);
+    assert_int_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL), 0);
+
+    /* the values are shared or copied */
+    leaf1 = (struct lyd_node_leaf_list *)st->dt1->child->next->child->next;
+    leaf2 = (struct lyd_node_leaf_list *)st->dt2->child->next->child->next;
+    assert_string_equal(leaf2->schema->name, "e");
+    assert_ptr_equal(leaf1->value_str, leaf2->value_str);
+    assert_ptr_equal(leaf1->value.enm, leaf2->value.enm);
+    leaf1 = (struct lyd_node_leaf_list *)leaf1->next;
+    leaf2 = (struct lyd_node_leaf_list *)leaf2->next;
+    assert_ptr_not_equal(leaf1->value.bit, leaf2->value.bit);
+    assert_ptr_equal(leaf1->value.bit[0], leaf2->value.bit[0]);
+    assert_ptr_equal(leaf1->value.bit[1], leaf2->value.bit[1]);
+    leaf1 = (struct lyd_node_leaf_list *)leaf1->next;
+    leaf2 = (struct lyd_node_leaf_list *)leaf2->next;
+    assert_ptr_equal(leaf1->value.ident, leaf2->value.ident);
+
+    /* the copy is independent */
+    lyd_print_mem(&str1, st->dt1, LYD_XML, 0);
+    lyd_free(st->dt1);
+    st->dt1 = NULL;
+    lyd_print_mem(&str2, st->dt2, LYD_XML, 0);
+    assert_string_equal(str1, str2);
+    free(str1);
+    free(str2);
+
+    set = lyd_find_path(st->dt2, "/x:c/l[k='4']");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    ly_set_free(set);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
                     cmocka_unit_test_setup_teardown(test_dup_to_ctx, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_dup_to_ctx_bits, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_dup_to_ctx_leafrefs, setup_f, teardown_f),};
+                    cmocka_unit_test_setup_teardown(test_dup_to_ctx_leafrefs, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_dup_subtree, setup_f, teardown_f),};
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
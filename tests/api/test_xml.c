@@ -592,6 +592,64 @@ test_lyxml_xmlns_correct_format(void **state)
     lyxml_free(ctx, xml);
 }
 
+static void
+test_lyxml_print_escape(void **state)
+{
+    (void) state; /* unused */
+    struct lyxml_elem *xml;
+    char *result = NULL;
+
+    xml = lyxml_parse_mem(ctx, "<x>&lt;text&gt; longer than a block &amp; with &lt;tag&gt; and \"quotes\" &amp;</x>", 0);
+    assert_ptr_not_equal(xml, NULL);
+
+    assert_int_not_equal(lyxml_print_mem(&result, xml, 0), 0);
+    assert_string_equal(result, "<x>&lt;text&gt; longer than a block &amp; with &lt;tag&gt; and \"quotes\" &amp;</x>");
+
+    lyxml_free(ctx, xml);
+    free(result);
+}
+
+static void
+test_lyxml_ns_scope(void **state)
+{
+    (void) state; /* unused */
+    struct lyxml_elem *xml, *a, *b, *c, *d;
+    const char *data =
+        "<a xmlns=\"urn:d1\" xmlns:p=\"urn:p1\">"
+          "<b p:attr=\"1\" xmlns:p=\"urn:p2\">"
+            "<p:c xmlns=\"\"><d/></p:c>"
+          "</b>"
+          "<p:b q:attr=\"2\" xmlns:q=\"urn:q1\"><c/></p:b>"
+        "</a>";
+
+    xml = lyxml_parse_mem(ctx, data, 0);
+    assert_ptr_not_equal(xml, NULL);
+
+    a = xml;
+    assert_string_equal(a->ns->value, "urn:d1");
+
+    /* the attribute prefix is declared after the attribute */
+    b = a->child;
+    assert_string_equal(b->ns->value, "urn:d1");
+    assert_ptr_not_equal(b->attr->ns, NULL);
+    assert_string_equal(b->attr->ns->value, "urn:p2");
+
+    /* shadowed prefix and an empty default namespace */
+    c = b->child;
+    assert_string_equal(c->ns->value, "urn:p2");
+    d = c->child;
+    assert_ptr_not_equal(d->ns, NULL);
+    assert_string_equal(d->ns->value, "");
+
+    /* the shadowed declarations are back in scope */
+    b = b->next;
+    assert_string_equal(b->ns->value, "urn:p1");
+    assert_string_equal(b->attr->ns->value, "urn:q1");
+    assert_string_equal(b->child->ns->value, "urn:d1");
+
+    lyxml_free(ctx, xml);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -602,6 +660,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lyxml_print_fd, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyxml_print_mem, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyxml_print_clb, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyxml_print_escape, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyxml_unlink, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyxml_get_attr, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyxml_get_ns, setup_f, teardown_f),
@@ -609,6 +668,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lyxml_free_withsiblings, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyxml_xmlns_wrong_format, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyxml_xmlns_correct_format, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyxml_ns_scope, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -361,6 +361,49 @@ test_functions_operators(void **state)
     st->set = NULL;
 }
 
+static void
+test_value_comparisons(void **state)
+{
+    struct state *st = (*state);
+
+    st->set = lyd_find_path(st->dt, "//ietf-ip:ipv4[ietf-ip:mtu > 60]");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "//ietf-ip:ipv6[ietf-ip:dup-addr-detect-transmits >= 52.0]");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 2);
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "//ietf-ip:ipv6[ietf-ip:dup-addr-detect-transmits < ../ietf-ip:ipv4/ietf-ip:mtu]");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "//ietf-ip:ipv4/ietf-ip:neighbor[ietf-ip:ip = //ietf-ip:ipv4/ietf-ip:address/ietf-ip:ip]");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->set->set.d[0]->child)->value_str, "10.0.0.1");
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[enabled != ../interface/enabled]");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 2);
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[ietf-ip:ipv6/ietf-ip:mtu = '1280']");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    ly_set_free(st->set);
+    st->set = NULL;
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -368,6 +411,7 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_simple, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_advanced, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_functions_operators, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_value_comparisons, setup_f, teardown_f),
                     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,648 @@
+/**
+ * @file bench.c
+ * @brief Benchmark of the libyang data operations on generated data sets.
+ *
+ * Copyright (c) 2018 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libyang.h"
+
+#ifndef BENCH_VERSION
+#   define BENCH_VERSION LY_VERSION
+#endif
+
+#define DEEP_LEVELS 8
+
+static const char *schema =
+    "module bench {\n"
+    "  yang-version 1.1;\n"
+    "  namespace \"urn:libyang:bench\";\n"
+    "  prefix b;\n"
+    "\n"
+    "  container deep {\n"
+    "    list item {\n"
+    "      key id;\n"
+    "      leaf id { type uint32; }\n"
+    "      container c1 { container c2 { container c3 { container c4 {\n"
+    "      container c5 { container c6 { container c7 { container c8 {\n"
+    "        leaf v { type string; }\n"
+    "        leaf n { type int32; }\n"
+    "      } } } } } } } }\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  container wide {\n"
+    "    list item {\n"
+    "      key name;\n"
+    "      leaf name { type string; }\n"
+    "      leaf a { type int32; }\n"
+    "      leaf b { type string; }\n"
+    "      leaf c { type boolean; }\n"
+    "      leaf d { type decimal64 { fraction-digits 2; } }\n"
+    "      leaf-list tag { type string; }\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  container lref {\n"
+    "    list target {\n"
+    "      key id;\n"
+    "      leaf id { type uint32; }\n"
+    "    }\n"
+    "    list ref {\n"
+    "      key id;\n"
+    "      leaf id { type uint32; }\n"
+    "      leaf t { type leafref { path \"../../target/id\"; } }\n"
+    "      leaf-list tl { type leafref { path \"../../target/id\"; } }\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  container cond {\n"
+    "    list item {\n"
+    "      key id;\n"
+    "      must \"kind != 'b' or b\";\n"
+    "      leaf id { type uint32; }\n"
+    "      leaf kind { type enumeration { enum a; enum b; } }\n"
+    "      leaf a { when \"../kind = 'a'\"; type string; }\n"
+    "      leaf b { when \"../kind = 'b'\"; type string; }\n"
+    "      leaf v { type uint32; must \". >= ../id\"; }\n"
+    "    }\n"
+    "  }\n"
+    "\n"
+    "  container ordered {\n"
+    "    list item {\n"
+    "      key id;\n"
+    "      ordered-by user;\n"
+    "      leaf id { type uint32; }\n"
+    "      leaf v { type string; }\n"
+    "    }\n"
+    "    leaf-list ll { type uint32; ordered-by user; }\n"
+    "  }\n"
+    "\n"
+    "  container text {\n"
+    "    list item {\n"
+    "      key id;\n"
+    "      leaf id { type uint32; }\n"
+    "      leaf descr { type string; }\n"
+    "      anydata content;\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
+struct buf {
+    char *data;
+    size_t len;
+    size_t size;
+};
+
+static void
+buf_add(struct buf *buf, const char *format, ...)
+{
+    va_list ap;
+    int len;
+
+    while (1) {
+        va_start(ap, format);
+        len = vsnprintf(buf->data + buf->len, buf->size - buf->len, format, ap);
+        va_end(ap);
+        if ((size_t)len < buf->size - buf->len) {
+            break;
+        }
+
+        buf->size = buf->size ? buf->size * 2 : 4096;
+        buf->data = realloc(buf->data, buf->size);
+        if (!buf->data) {
+            fprintf(stderr, "yangbench error: Memory allocation failed.\n");
+            exit(1);
+        }
+    }
+    buf->len += len;
+}
+
+/* deterministic permutation of 0..size-1, the generated data must be the same in every run */
+static uint32_t
+permute(uint32_t i, uint32_t size)
+{
+    /* 2654435761 is odd and so coprime with any power of 2, search for the first result in range */
+    uint32_t mask = 1, r = i;
+
+    while (mask < size) {
+        mask = (mask << 1) | 1;
+    }
+    do {
+        r = (r * 2654435761u + 12345) & mask;
+    } while (r >= size);
+
+    return r;
+}
+
+static void
+gen_deep(struct buf *buf, uint32_t size)
+{
+    uint32_t i, j;
+
+    buf_add(buf, "<deep xmlns=\"urn:libyang:bench\">");
+    for (i = 0; i < size; ++i) {
+        buf_add(buf, "<item><id>%u</id>", i);
+        for (j = 1; j <= DEEP_LEVELS; ++j) {
+            buf_add(buf, "<c%u>", j);
+        }
+        buf_add(buf, "<v>value-%u</v><n>%d</n>", i, (int)(i % 1000) - 500);
+        for (j = DEEP_LEVELS; j; --j) {
+            buf_add(buf, "</c%u>", j);
+        }
+        buf_add(buf, "</item>");
+    }
+    buf_add(buf, "</deep>");
+}
+
+static void
+gen_wide(struct buf *buf, uint32_t size)
+{
+    uint32_t i;
+
+    buf_add(buf, "<wide xmlns=\"urn:libyang:bench\">");
+    for (i = 0; i < size; ++i) {
+        buf_add(buf, "<item><name>item-%u</name><a>%u</a><b>some text %u</b><c>%s</c><d>%u.%02u</d>"
+                "<tag>t%u</tag><tag>t%u</tag></item>", i, i * 7, i, (i % 2) ? "true" : "false", i, i % 100,
+                i % 10, 10 + i % 10);
+    }
+    buf_add(buf, "</wide>");
+}
+
+static void
+gen_lref(struct buf *buf, uint32_t size)
+{
+    uint32_t i;
+
+    buf_add(buf, "<lref xmlns=\"urn:libyang:bench\">");
+    for (i = 0; i < size; ++i) {
+        buf_add(buf, "<target><id>%u</id></target>", i);
+    }
+    /* every leafref is resolved by searching all the targets, keep the references sparse */
+    for (i = 0; i < size; i += 100) {
+        buf_add(buf, "<ref><id>%u</id><t>%u</t><tl>%u</tl><tl>%u</tl></ref>", i, permute(i, size), i,
+                (i + 1) % size);
+    }
+    buf_add(buf, "</lref>");
+}
+
+static void
+gen_cond(struct buf *buf, uint32_t size)
+{
+    uint32_t i;
+
+    buf_add(buf, "<cond xmlns=\"urn:libyang:bench\">");
+    for (i = 0; i < size; ++i) {
+        if (i % 2) {
+            buf_add(buf, "<item><id>%u</id><kind>b</kind><b>b-%u</b><v>%u</v></item>", i, i, i + 1);
+        } else {
+            buf_add(buf, "<item><id>%u</id><kind>a</kind><a>a-%u</a><v>%u</v></item>", i, i, i);
+        }
+    }
+    buf_add(buf, "</cond>");
+}
+
+static void
+gen_ordered(struct buf *buf, uint32_t size)
+{
+    uint32_t i;
+
+    buf_add(buf, "<ordered xmlns=\"urn:libyang:bench\">");
+    for (i = 0; i < size; ++i) {
+        buf_add(buf, "<item><id>%u</id><v>v%u</v></item>", permute(i, size), i);
+    }
+    for (i = 0; i < size; ++i) {
+        buf_add(buf, "<ll>%u</ll>", permute(size - i - 1, size));
+    }
+    buf_add(buf, "</ordered>");
+}
+
+/* about 400 characters of text with a few of them escaped in XML or JSON */
+#define TEXT_PARAGRAPH "This list entry describes a configuration item in prose, as descriptions and documentation " \
+    "embedded in data usually do. Most of the text needs no escaping at all, only an occasional &amp; or &lt;tag&gt; " \
+    "and a \"quoted\" word or a C:\\path\\with\\backslashes must be handled. The rest is copied as is: letters, " \
+    "digits 0123456789, punctuation (,.;:!?) and brackets [] {} that are special in neither of the formats. "
+
+static void
+gen_text(struct buf *buf, uint32_t size)
+{
+    uint32_t i;
+
+    buf_add(buf, "<text xmlns=\"urn:libyang:bench\">");
+    for (i = 0; i < size; ++i) {
+        buf_add(buf, "<item><id>%u</id><descr>%u: " TEXT_PARAGRAPH TEXT_PARAGRAPH "</descr>"
+                "<content><p>" TEXT_PARAGRAPH "</p><p>" TEXT_PARAGRAPH "</p></content></item>", i, i);
+    }
+    buf_add(buf, "</text>");
+}
+
+static const struct dataset {
+    const char *name;
+    void (*gen)(struct buf *buf, uint32_t size);
+    const char *xpath;
+} datasets[] = {
+    {"deep", gen_deep, "/bench:deep/item/c1/c2/c3/c4/c5/c6/c7/c8[n > 0]/v"},
+    {"wide", gen_wide, "/bench:wide/item[c = 'true'][tag = 't5']/name"},
+    {"leafref", gen_lref, "/bench:lref/ref[id = 4200]/tl"},
+    {"must-when", gen_cond, "/bench:cond/item[kind = 'b']/b"},
+    {"ordered", gen_ordered, "/bench:ordered/item[last()]/v"},
+    {"text", gen_text, "/bench:text/item[id = 4200]/descr"},
+    {NULL, NULL, NULL}
+};
+
+/* one benchmark run */
+struct bench {
+    struct ly_ctx *ctx;
+    const struct dataset *ds;
+    uint32_t size;
+    uint32_t nodes;
+    int repeat;
+    int print_only;
+    uint64_t *samples;
+    FILE *out;
+};
+
+static uint64_t
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int
+sample_cmp(const void *ptr1, const void *ptr2)
+{
+    uint64_t s1 = *(uint64_t *)ptr1, s2 = *(uint64_t *)ptr2;
+
+    return (s1 > s2) - (s1 < s2);
+}
+
+static void
+report(struct bench *b, const char *op)
+{
+    int i;
+    uint64_t sum = 0;
+
+    qsort(b->samples, b->repeat, sizeof *b->samples, sample_cmp);
+    for (i = 0; i < b->repeat; ++i) {
+        sum += b->samples[i];
+    }
+
+    fprintf(b->out, "{\"version\":\"%s\",\"dataset\":\"%s\",\"size\":%u,\"nodes\":%u,\"op\":\"%s\",\"repeat\":%d,"
+            "\"min_us\":%.1f,\"median_us\":%.1f,\"mean_us\":%.1f}\n", BENCH_VERSION, b->ds->name, b->size, b->nodes, op,
+            b->repeat, b->samples[0] / 1000.0, b->samples[b->repeat / 2] / 1000.0, sum / 1000.0 / b->repeat);
+    fflush(b->out);
+}
+
+static uint32_t
+count_nodes(struct lyd_node *tree)
+{
+    struct lyd_node *next, *elem;
+    uint32_t count = 0;
+
+    LY_TREE_DFS_BEGIN(tree, next, elem) {
+        ++count;
+        LY_TREE_DFS_END(tree, next, elem);
+    }
+
+    return count;
+}
+
+static int
+bench_parse(struct bench *b, const char *op, const char *data, LYD_FORMAT format, int options)
+{
+    struct lyd_node *tree;
+    uint64_t start;
+    int i;
+
+    for (i = 0; i < b->repeat; ++i) {
+        start = now();
+        tree = lyd_parse_mem(b->ctx, data, format, options);
+        b->samples[i] = now() - start;
+        if (!tree) {
+            fprintf(stderr, "yangbench error: %s of \"%s\" failed.\n", op, b->ds->name);
+            return 1;
+        }
+        lyd_free_withsiblings(tree);
+    }
+
+    report(b, op);
+    return 0;
+}
+
+static int
+bench_print(struct bench *b, const char *op, struct lyd_node *tree, LYD_FORMAT format, char **result)
+{
+    uint64_t start;
+    int i;
+
+    for (i = 0; i < b->repeat; ++i) {
+        free(*result);
+        *result = NULL;
+        start = now();
+        if (lyd_print_mem(result, tree, format, LYP_WITHSIBLINGS)) {
+            fprintf(stderr, "yangbench error: %s of \"%s\" failed.\n", op, b->ds->name);
+            return 1;
+        }
+        b->samples[i] = now() - start;
+    }
+
+    report(b, op);
+    return 0;
+}
+
+static int
+bench_dataset(struct bench *b)
+{
+    struct buf xml = {NULL, 0, 0};
+    struct lyd_node *tree = NULL, *tree2, *dup;
+    struct lyd_difflist *diff;
+    struct ly_set *set;
+    char *json = NULL, *lyb = NULL, *printed = NULL;
+    uint64_t start;
+    int i, ret = 1;
+
+    b->ds->gen(&xml, b->size);
+
+    tree = lyd_parse_mem(b->ctx, xml.data, LYD_XML, LYD_OPT_CONFIG);
+    if (!tree) {
+        fprintf(stderr, "yangbench error: Parsing generated data \"%s\" failed.\n", b->ds->name);
+        goto cleanup;
+    }
+    b->nodes = count_nodes(tree);
+
+    /* printers, the results are parsed below */
+    if (bench_print(b, "print_xml", tree, LYD_XML, &printed) || bench_print(b, "print_json", tree, LYD_JSON, &json)
+            || bench_print(b, "print_lyb", tree, LYD_LYB, &lyb)) {
+        goto cleanup;
+    }
+    if (b->print_only) {
+        ret = 0;
+        goto cleanup;
+    }
+
+    /* parsers, all including validation */
+    if (bench_parse(b, "parse_xml", xml.data, LYD_XML, LYD_OPT_CONFIG)
+            || bench_parse(b, "parse_json", json, LYD_JSON, LYD_OPT_CONFIG)
+            || bench_parse(b, "parse_lyb", lyb, LYD_LYB, LYD_OPT_CONFIG)
+            || bench_parse(b, "parse_xml_trusted", xml.data, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_TRUSTED)) {
+        goto cleanup;
+    }
+
+    /* validation alone */
+    for (i = 0; i < b->repeat; ++i) {
+        tree2 = lyd_parse_mem(b->ctx, xml.data, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+        start = now();
+        if (!tree2 || lyd_validate(&tree2, LYD_OPT_CONFIG, b->ctx)) {
+            fprintf(stderr, "yangbench error: validate of \"%s\" failed.\n", b->ds->name);
+            lyd_free_withsiblings(tree2);
+            goto cleanup;
+        }
+        b->samples[i] = now() - start;
+        lyd_free_withsiblings(tree2);
+    }
+    report(b, "validate");
+
+    /* duplication */
+    for (i = 0; i < b->repeat; ++i) {
+        start = now();
+        dup = lyd_dup_withsiblings(tree, LYD_DUP_OPT_RECURSIVE);
+        b->samples[i] = now() - start;
+        if (!dup) {
+            fprintf(stderr, "yangbench error: dup of \"%s\" failed.\n", b->ds->name);
+            goto cleanup;
+        }
+        lyd_free_withsiblings(dup);
+    }
+    report(b, "dup");
+
+    /* diff of the same data */
+    for (i = 0; i < b->repeat; ++i) {
+        dup = lyd_dup_withsiblings(tree, LYD_DUP_OPT_RECURSIVE);
+        start = now();
+        diff = dup ? lyd_diff(tree, dup, 0) : NULL;
+        b->samples[i] = now() - start;
+        lyd_free_withsiblings(dup);
+        if (!diff) {
+            fprintf(stderr, "yangbench error: diff of \"%s\" failed.\n", b->ds->name);
+            goto cleanup;
+        }
+        lyd_free_diff(diff);
+    }
+    report(b, "diff");
+
+    /* merge into the same data */
+    for (i = 0; i < b->repeat; ++i) {
+        dup = lyd_dup_withsiblings(tree, LYD_DUP_OPT_RECURSIVE);
+        start = now();
+        if (!dup || lyd_merge(dup, tree, 0)) {
+            fprintf(stderr, "yangbench error: merge of \"%s\" failed.\n", b->ds->name);
+            lyd_free_withsiblings(dup);
+            goto cleanup;
+        }
+        b->samples[i] = now() - start;
+        lyd_free_withsiblings(dup);
+    }
+    report(b, "merge");
+
+    /* xpath */
+    for (i = 0; i < b->repeat; ++i) {
+        start = now();
+        set = lyd_find_path(tree, b->ds->xpath);
+        b->samples[i] = now() - start;
+        if (!set) {
+            fprintf(stderr, "yangbench error: xpath of \"%s\" failed.\n", b->ds->name);
+            goto cleanup;
+        }
+        ly_set_free(set);
+    }
+    report(b, "xpath");
+
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(tree);
+    free(xml.data);
+    free(json);
+    free(lyb);
+    free(printed);
+    return ret;
+}
+
+static int
+write_datasets(const char *dir, uint32_t size)
+{
+    const struct dataset *ds;
+    struct buf xml;
+    char *path;
+    FILE *f;
+
+    if (asprintf(&path, "%s/bench.yang", dir) == -1) {
+        return 1;
+    }
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "yangbench error: Unable to write \"%s\" (%s).\n", path, strerror(errno));
+        free(path);
+        return 1;
+    }
+    fputs(schema, f);
+    fclose(f);
+    free(path);
+
+    for (ds = datasets; ds->name; ++ds) {
+        memset(&xml, 0, sizeof xml);
+        ds->gen(&xml, size);
+
+        if (asprintf(&path, "%s/%s-%u.xml", dir, ds->name, size) == -1) {
+            free(xml.data);
+            return 1;
+        }
+        f = fopen(path, "w");
+        if (!f) {
+            fprintf(stderr, "yangbench error: Unable to write \"%s\" (%s).\n", path, strerror(errno));
+            free(path);
+            free(xml.data);
+            return 1;
+        }
+        fwrite(xml.data, 1, xml.len, f);
+        fclose(f);
+        free(path);
+        free(xml.data);
+    }
+
+    return 0;
+}
+
+static void
+help(void)
+{
+    const struct dataset *ds;
+
+    fprintf(stdout, "Usage: yangbench [-s SIZE] [-r REPEAT] [-d DATASET]... [-p] [-o OUTFILE]\n"
+                    "       yangbench -w DIR [-s SIZE]\n\n"
+                    "Measures libyang data operations on generated data, the results are printed as JSON objects,\n"
+                    "one per line.\n\n"
+                    "  -s SIZE     Number of list instances in each data set (default 10000).\n"
+                    "  -r REPEAT   Number of repetitions of each operation (default 5).\n"
+                    "  -d DATASET  Data set to use, can be specified multiple times (default all).\n"
+                    "  -p          Measure only the printers, e.g. for large data sets (\"-d wide -s 125000\"\n"
+                    "              has 1M nodes).\n"
+                    "  -o OUTFILE  Write the results to OUTFILE instead of stdout.\n"
+                    "  -w DIR      Only write the schema and the generated data sets into DIR.\n\n"
+                    "Data sets:");
+    for (ds = datasets; ds->name; ++ds) {
+        fprintf(stdout, " %s", ds->name);
+    }
+    fprintf(stdout, "\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct bench b;
+    const struct dataset *ds;
+    const char *selected[sizeof datasets / sizeof *datasets], *dir = NULL;
+    int opt, i, sel_count = 0, ret = 1;
+
+    memset(&b, 0, sizeof b);
+    b.size = 10000;
+    b.repeat = 5;
+    b.out = stdout;
+
+    while ((opt = getopt(argc, argv, "s:r:d:po:w:h")) != -1) {
+        switch (opt) {
+        case 's':
+            b.size = strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            b.repeat = atoi(optarg);
+            break;
+        case 'd':
+            for (ds = datasets; ds->name && strcmp(ds->name, optarg); ++ds);
+            if (!ds->name || (sel_count == (sizeof datasets / sizeof *datasets) - 1)) {
+                fprintf(stderr, "yangbench error: Unknown data set \"%s\".\n", optarg);
+                goto cleanup;
+            }
+            selected[sel_count++] = ds->name;
+            break;
+        case 'p':
+            b.print_only = 1;
+            break;
+        case 'o':
+            if (b.out != stdout) {
+                fclose(b.out);
+            }
+            b.out = fopen(optarg, "w");
+            if (!b.out) {
+                fprintf(stderr, "yangbench error: Unable to open \"%s\" (%s).\n", optarg, strerror(errno));
+                goto cleanup;
+            }
+            break;
+        case 'w':
+            dir = optarg;
+            break;
+        case 'h':
+            help();
+            ret = 0;
+            goto cleanup;
+        default:
+            help();
+            goto cleanup;
+        }
+    }
+    if (!b.size || (b.repeat < 1)) {
+        fprintf(stderr, "yangbench error: Invalid size or repetition count.\n");
+        goto cleanup;
+    }
+
+    if (dir) {
+        ret = write_datasets(dir, b.size);
+        goto cleanup;
+    }
+
+    b.samples = malloc(b.repeat * sizeof *b.samples);
+    b.ctx = ly_ctx_new(NULL, 0);
+    if (!b.samples || !b.ctx || !lys_parse_mem(b.ctx, schema, LYS_IN_YANG)) {
+        goto cleanup;
+    }
+
+    for (b.ds = datasets; b.ds->name; ++b.ds) {
+        for (i = 0; (i < sel_count) && strcmp(selected[i], b.ds->name); ++i);
+        if (sel_count && (i == sel_count)) {
+            continue;
+        }
+
+        if (bench_dataset(&b)) {
+            goto cleanup;
+        }
+    }
+    ret = 0;
+
+cleanup:
+    if (b.out && (b.out != stdout)) {
+        fclose(b.out);
+    }
+    free(b.samples);
+    ly_ctx_destroy(b.ctx, NULL);
+    return ret;
+}
@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <cmocka.h>
@@ -694,6 +695,52 @@ test_parse_string(void **state)
     assert_ptr_equal(st->dt, NULL);
 }
 
+static void
+test_print_string(void **state)
+{
+    struct state *st;
+    const struct lys_module *mod;
+    const char *escaped = "\"\\\t\n";
+    char value[41], *printed;
+    int i, j;
+
+    if (setup_f(&st, TESTS_DIR "/schema/yin/ietf", NULL, 0)) {
+        fail();
+    }
+
+    (*state) = st;
+
+    mod = lys_parse_mem(st->ctx, "module str {namespace urn:str; prefix s; leaf str {type string;}}", LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+
+    /* escaped character at every position of a string longer than the blocks scanned at once */
+    for (j = 0; escaped[j]; ++j) {
+        for (i = 0; i < 40; ++i) {
+            memset(value, 'a', 40);
+            value[40] = '\0';
+            value[i] = escaped[j];
+
+            st->dt = lyd_new_leaf(NULL, mod, "str", value);
+            assert_ptr_not_equal(st->dt, NULL);
+            assert_int_equal(lyd_print_mem(&printed, st->dt, LYD_JSON, 0), 0);
+            lyd_free(st->dt);
+
+            st->dt = lyd_parse_mem(st->ctx, printed, LYD_JSON, LYD_OPT_CONFIG);
+            free(printed);
+            assert_ptr_not_equal(st->dt, NULL);
+            assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, value);
+            lyd_free(st->dt);
+        }
+    }
+
+    st->dt = lyd_new_leaf(NULL, mod, "str", "tab\there, \"quotes\", back\\slash, <tag> & \xc3\xa9 in a longer string\n");
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_int_equal(lyd_print_mem(&printed, st->dt, LYD_JSON, 0), 0);
+    assert_string_equal(printed, "{\"str:str\":\"tab\\u0009here, \\\"quotes\\\", back\\\\slash, <tag> & \xc3\xa9 in a longer "
+                        "string\\u000A\"}");
+    free(printed);
+}
+
 int
 main(void)
 {
@@ -702,6 +749,7 @@ main(void)
                     cmocka_unit_test_teardown(test_parse_numbers, teardown_f),
                     cmocka_unit_test_teardown(test_parse_error_numbers, teardown_f),
                     cmocka_unit_test_teardown(test_parse_string, teardown_f),
+                    cmocka_unit_test_teardown(test_print_string, teardown_f),
                     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
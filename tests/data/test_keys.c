@@ -204,6 +204,85 @@ test_keys_inorder2(void **state)
     assert_int_equal(lyd_validate(&(st->dt), LYD_OPT_CONFIG, NULL), 0);
 }
 
+static void
+test_keys_batch(void **state)
+{
+    struct state *st = (*state);
+    const char *leaves[] = {"key1", "key2", "value"}, *values[] = {"1", "1", "a", "1", "2", NULL, "2", "1", "c"};
+    const char *dup_values[] = {"1", "1", "a", "1", "1", "b"};
+    const char *correct = "<l xmlns=\"urn:libyang:tests:keys\"><key1>1</key1><key2>1</key2><value>a</value></l>"
+                          "<l xmlns=\"urn:libyang:tests:keys\"><key1>1</key1><key2>2</key2></l>"
+                          "<l xmlns=\"urn:libyang:tests:keys\"><key1>2</key1><key2>1</key2><value>c</value></l>";
+    const char *schema = "module batch {namespace urn:batch; prefix b;"
+                         "container c {list e {key k; leaf k {type uint32;} leaf v {type string;}}}}";
+    const char *e_leaves[] = {"batch:k", "v"}, *e_values[20];
+    char buf[10][11];
+    const struct lys_node *slist;
+    struct lyd_node *node;
+    struct ly_set *set;
+    char *printed;
+    int i;
+
+    slist = ly_ctx_get_node(st->ctx, NULL, "/keys:l", 0);
+    assert_ptr_not_equal(slist, NULL);
+
+    /* keys in a wrong order */
+    leaves[0] = "key2";
+    leaves[1] = "key1";
+    assert_ptr_equal(lyd_new_list_batch(NULL, slist, leaves, 3, values, 3), NULL);
+    leaves[0] = "key1";
+    leaves[1] = "key2";
+
+    /* missing key value */
+    values[3] = NULL;
+    assert_ptr_equal(lyd_new_list_batch(NULL, slist, leaves, 3, values, 3), NULL);
+    values[3] = "1";
+
+    /* duplicate instances */
+    assert_ptr_equal(lyd_new_list_batch(NULL, slist, leaves, 3, dup_values, 2), NULL);
+
+    st->dt = lyd_new_list_batch(NULL, slist, leaves, 3, values, 3);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_int_equal(lyd_validate(&(st->dt), LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(lyd_print_mem(&printed, st->dt, LYD_XML, LYP_WITHSIBLINGS), 0);
+    assert_string_equal(printed, correct);
+    free(printed);
+    lyd_free_withsiblings(st->dt);
+
+    /* instances appended to existing ones */
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, schema, LYS_IN_YANG), NULL);
+    slist = ly_ctx_get_node(st->ctx, NULL, "/batch:c/e", 0);
+    assert_ptr_not_equal(slist, NULL);
+
+    st->dt = lyd_new_path(NULL, st->ctx, "/batch:c/e[k='0']/v", "0", 0, 0);
+    assert_ptr_not_equal(st->dt, NULL);
+    for (i = 0; i < 10; ++i) {
+        sprintf(buf[i], "%d", i);
+        e_values[2 * i] = buf[i];
+        e_values[2 * i + 1] = (i % 2) ? buf[i] : NULL;
+    }
+
+    /* duplicate with the existing instance */
+    assert_ptr_equal(lyd_new_list_batch(st->dt, slist, e_leaves, 2, e_values, 10), NULL);
+    assert_ptr_equal(st->dt->child->next, NULL);
+
+    node = lyd_new_list_batch(st->dt, slist, e_leaves, 2, e_values + 2, 9);
+    assert_ptr_not_equal(node, NULL);
+    assert_ptr_equal(node->parent, st->dt);
+    assert_ptr_equal(st->dt->child->next, node);
+    assert_int_equal(lyd_validate(&(st->dt), LYD_OPT_CONFIG, NULL), 0);
+
+    set = lyd_find_path(st->dt, "/batch:c/e[k='7']/v");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "7");
+    ly_set_free(set);
+
+    assert_int_equal(lyd_find_sibling_val(st->dt->child, slist, "[k='9']", &node), 0);
+    assert_ptr_not_equal(node, NULL);
+    assert_string_equal(((struct lyd_node_leaf_list *)node->child)->value_str, "9");
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -212,7 +291,8 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_keys_missing, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_keys_missing2, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_keys_inorder, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_keys_inorder2, setup_f, teardown_f), };
+                    cmocka_unit_test_setup_teardown(test_keys_inorder2, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_keys_batch, setup_f, teardown_f), };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -144,6 +144,126 @@ test_un_empty(void **state)
     assert_ptr_not_equal(st->dt, NULL);
 }
 
+static void
+test_un_change(void **state)
+{
+    struct state *st = (*state);
+    struct ly_set *set;
+    const char *xml = "<un xmlns=\"urn:libyang:tests:unique\">"
+                        "<list><name>x</name><value>1</value><a>1</a></list>"
+                        "<list><name>y</name><value>2</value><a>2</a></list>"
+                      "</un>";
+
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+
+    /* change the values so that they are the same as in the other instance */
+    set = lyd_find_path(st->dt, "/unique:un/list[name='y']/*[name() = 'value' or name() = 'a']");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 2);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)set->set.d[0], "1"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)set->set.d[1], "1"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+
+    /* and back */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)set->set.d[1], "2"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    ly_set_free(set);
+}
+
+static void
+test_un_edit(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *list;
+    struct ly_set *set;
+    const char *xml = "<un xmlns=\"urn:libyang:tests:unique\">"
+                        "<list><name>x</name><value>1</value><a>1</a></list>"
+                        "<list><name>y</name><value>2</value><a>2</a></list>"
+                        "<list><name>z</name><value>42</value></list>"
+                      "</un>";
+
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+
+    /* new instance with the same unique values */
+    list = lyd_new(st->dt, st->mod, "list");
+    assert_ptr_not_equal(list, NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "name", "w"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "value", "2"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "a", "2"), NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+    assert_string_equal(ly_errmsg(st->ctx), "Unique data leaf(s) \"value a\" not satisfied in \"/unique:un/list[name='y']\" and \"/unique:un/list[name='w']\".");
+
+    /* remove the original one */
+    set = lyd_find_path(st->dt, "/unique:un/list[name='y']");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    lyd_free(set->set.d[0]);
+    ly_set_free(set);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* removed unique leaf, the default value is the same as in another instance */
+    set = lyd_find_path(st->dt, "/unique:un/list[name='x']/value");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    lyd_free(set->set.d[0]);
+    ly_set_free(set);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    set = lyd_find_path(st->dt, "/unique:un/list[name='x']/a");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    lyd_free(set->set.d[0]);
+    ly_set_free(set);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+}
+
+static void
+test_un_trees(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *dt2, *list;
+    const char *xml = "<un xmlns=\"urn:libyang:tests:unique\">"
+                        "<list><name>x</name><value>1</value><a>1</a></list>"
+                        "<list><name>y</name><value>2</value><a>2</a></list>"
+                      "</un>";
+
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    dt2 = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(dt2, NULL);
+
+    /* the same unique values in the other tree are fine */
+    list = lyd_new(dt2, st->mod, "list");
+    assert_ptr_not_equal(list, NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "name", "w"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "value", "3"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "a", "3"), NULL);
+    assert_int_equal(lyd_validate(&dt2, LYD_OPT_CONFIG, NULL), 0);
+
+    list = lyd_new(st->dt, st->mod, "list");
+    assert_ptr_not_equal(list, NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "name", "w"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "value", "3"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "a", "3"), NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* freeing one tree does not affect the other one */
+    lyd_free_withsiblings(dt2);
+    list = lyd_new(st->dt, st->mod, "list");
+    assert_ptr_not_equal(list, NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "name", "v"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "value", "3"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(list, st->mod, "a", "3"), NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 1);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOUNIQ);
+}
+
 static void
 test_schema_inpath(void **state)
 {
@@ -170,6 +290,9 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_un_correct, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_un_defaults, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_un_empty, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_un_change, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_un_edit, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_un_trees, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_schema_inpath, setup_f, teardown_f),
     };
 
@@ -14,12 +14,14 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <cmocka.h>
 
 #include "tests/config.h"
 #include "libyang.h"
+#include "../../src/user_types.h"
 
 struct state {
     struct ly_ctx *ctx;
@@ -227,11 +229,209 @@ test_inet_types(void **state)
     assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, "::/55");
 }
 
+static void
+test_validation(void **state)
+{
+    struct state *st = (struct state *)*state;
+
+    /* valid values, checked without the patterns */
+    st->dt = lyd_new_leaf(NULL, st->mod, "yang6", "10.0.255.1");
+    assert_non_null(st->dt);
+    lyd_free_withsiblings(st->dt);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "yang7", "_id-1.x");
+    assert_non_null(st->dt);
+    lyd_free_withsiblings(st->dt);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet8", "www.example-1.com.");
+    assert_non_null(st->dt);
+    lyd_free_withsiblings(st->dt);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet8", ".");
+    assert_non_null(st->dt);
+    lyd_free_withsiblings(st->dt);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet2", "::ffff:10.0.0.1");
+    assert_non_null(st->dt);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, "::ffff:10.0.0.1");
+    lyd_free_withsiblings(st->dt);
+
+    /* invalid values, the error is still generated using the patterns */
+    st->dt = lyd_new_leaf(NULL, st->mod, "yang6", "10.0.256.1");
+    assert_null(st->dt);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOCONSTR);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "yang7", "1id");
+    assert_null(st->dt);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOCONSTR);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet8", "www.-example.com");
+    assert_null(st->dt);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOCONSTR);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet6", "10.0.0.0/33");
+    assert_null(st->dt);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOCONSTR);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet2", "10.0.0.1");
+    assert_null(st->dt);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOCONSTR);
+
+    st->dt = lyd_new_leaf(NULL, st->mod, "yang3", "12:34:56:78:9A");
+    assert_null(st->dt);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_NOCONSTR);
+
+    /* invalid for all the union member types */
+    st->dt = lyd_new_leaf(NULL, st->mod, "inet1", "10.0.0.1%");
+    assert_null(st->dt);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_INVAL);
+}
+
+static int
+upper_store_clb(struct ly_ctx *ctx, const char *type_name, const char **value_str, lyd_val *value, char **err_msg)
+{
+    char *str;
+    int i;
+
+    (void)type_name;
+    (void)err_msg;
+
+    str = strdup(*value_str);
+    for (i = 0; str[i]; ++i) {
+        if ((str[i] >= 'a') && (str[i] <= 'z')) {
+            str[i] -= 32;
+        }
+    }
+
+    lydict_remove(ctx, *value_str);
+    *value_str = lydict_insert_zc(ctx, str);
+    value->string = *value_str;
+    return 0;
+}
+
+static struct lytype_plugin_list upper_types[] = {
+    {"user-types-reg", NULL, "upper", upper_store_clb, NULL, NULL, NULL},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL}
+};
+
+static void
+test_register(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const struct lys_module *mod;
+    const char *yang = "module user-types-reg {namespace urn:user-types-reg; prefix utr;"
+                       "typedef upper {type string;} leaf l {type upper;}}";
+
+    mod = lys_parse_mem(st->ctx, yang, LYS_IN_YANG);
+    assert_non_null(mod);
+
+    st->dt = lyd_new_leaf(NULL, mod, "l", "value");
+    assert_non_null(st->dt);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, "value");
+    lyd_free_withsiblings(st->dt);
+
+    /* the plugin is used even for an already loaded module */
+    assert_int_equal(ly_register_types(upper_types, "upper"), 0);
+
+    st->dt = lyd_new_leaf(NULL, mod, "l", "value");
+    assert_non_null(st->dt);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->dt)->value_str, "VALUE");
+
+    /* collision */
+    assert_int_equal(ly_register_types(upper_types, "upper"), 1);
+}
+
+static int number_dups;
+
+static int
+number_store_clb(struct ly_ctx *ctx, const char *type_name, const char **value_str, lyd_val *value, char **err_msg)
+{
+    uint32_t *num;
+
+    (void)ctx;
+    (void)type_name;
+    (void)err_msg;
+
+    num = malloc(sizeof *num);
+    *num = strtoul(*value_str, NULL, 10);
+    value->ptr = num;
+    return 0;
+}
+
+static int
+number_dup_clb(struct ly_ctx *ctx, const char *type_name, const char *value_str, lyd_val orig, lyd_val *dup,
+               char **err_msg)
+{
+    uint32_t *num;
+
+    (void)ctx;
+    (void)type_name;
+    (void)value_str;
+    (void)err_msg;
+
+    num = malloc(sizeof *num);
+    *num = *(uint32_t *)orig.ptr;
+    dup->ptr = num;
+    ++number_dups;
+    return 0;
+}
+
+static struct lytype_plugin_list number_types[] = {
+    {"user-types-num", NULL, "number", number_store_clb, free, NULL, number_dup_clb},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL}
+};
+
+static void
+test_dup(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const struct lys_module *mod, *mod2;
+    struct ly_ctx *ctx2;
+    struct lyd_node *dup;
+    const char *yang = "module user-types-num {namespace urn:user-types-num; prefix utn;"
+                       "typedef number {type string {pattern '[0-9]+';}} leaf-list ll {type number;}}";
+
+    assert_int_equal(ly_register_types(number_types, "number"), 0);
+
+    mod = lys_parse_mem(st->ctx, yang, LYS_IN_YANG);
+    assert_non_null(mod);
+
+    st->dt = lyd_new_leaf(NULL, mod, "ll", "0042");
+    assert_non_null(st->dt);
+    assert_int_equal(*(uint32_t *)((struct lyd_node_leaf_list *)st->dt)->value.ptr, 42);
+
+    /* the stored value is duplicated directly */
+    number_dups = 0;
+    dup = lyd_dup(st->dt, 0);
+    assert_non_null(dup);
+    assert_int_equal(number_dups, 1);
+    assert_ptr_not_equal(((struct lyd_node_leaf_list *)dup)->value.ptr, ((struct lyd_node_leaf_list *)st->dt)->value.ptr);
+    assert_int_equal(*(uint32_t *)((struct lyd_node_leaf_list *)dup)->value.ptr, 42);
+    lyd_free(dup);
+
+    /* and into a different context */
+    ctx2 = ly_ctx_new(NULL, 0);
+    assert_non_null(ctx2);
+    mod2 = lys_parse_mem(ctx2, yang, LYS_IN_YANG);
+    assert_non_null(mod2);
+
+    dup = lyd_dup_to_ctx(st->dt, 0, ctx2);
+    assert_non_null(dup);
+    assert_int_equal(number_dups, 2);
+    assert_int_equal(*(uint32_t *)((struct lyd_node_leaf_list *)dup)->value.ptr, 42);
+
+    lyd_free(dup);
+    ly_ctx_destroy(ctx2, NULL);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_yang_types, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_inet_types, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_validation, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_register, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_dup, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,200 @@
+/**
+ * @file test_vmetrics.c
+ * @brief Cmocka tests for the validation metrics.
+ *
+ * Copyright (c) 2018 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include "tests/config.h"
+#include "libyang.h"
+
+struct state {
+    struct ly_ctx *ctx;
+    const struct lys_module *mod;
+    struct lyd_node *dt;
+};
+
+static const char *schema =
+    "module vm {namespace urn:vm; prefix vm;"
+    "  container c {"
+    "    must \"count(l) < 100\";"
+    "    list l {key k; unique v;"
+    "      leaf k {type string;}"
+    "      leaf v {type int32;}"
+    "      leaf r {type leafref {path \"../../l/k\";}}"
+    "      leaf w {when \"../v > 1\"; type string;}"
+    "    }"
+    "  }"
+    "}";
+
+static const char *data =
+    "<c xmlns=\"urn:vm\">"
+    "  <l><k>a</k><v>1</v><r>b</r></l>"
+    "  <l><k>b</k><v>2</v><r>a</r><w>x</w></l>"
+    "  <l><k>c</k><v>3</v><w>y</w></l>"
+    "</c>";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    /* libyang context */
+    st->ctx = ly_ctx_new(NULL, 0);
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto error;
+    }
+
+    st->mod = lys_parse_mem(st->ctx, schema, LYS_IN_YANG);
+    if (!st->mod) {
+        fprintf(stderr, "Failed to load schema.\n");
+        goto error;
+    }
+
+    return 0;
+
+error:
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st);
+    (*state) = NULL;
+
+    return -1;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+static const struct lyd_vmetric *
+find_vmetric(const struct lyd_vmetric *vmetrics, uint32_t count, LYD_VMETRIC_TYPE type)
+{
+    uint32_t u;
+
+    for (u = 0; u < count; ++u) {
+        if (vmetrics[u].type == type) {
+            return &vmetrics[u];
+        }
+    }
+
+    return NULL;
+}
+
+static void
+test_disabled(void **state)
+{
+    struct state *st = (struct state *)*state;
+    uint32_t count;
+
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_non_null(st->dt);
+
+    assert_null(lyd_vmetrics_get(st->ctx, &count));
+    assert_int_equal(count, 0);
+}
+
+static void
+test_collect(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct lyd_vmetric *vmetrics;
+    const struct lyd_vmetric *m;
+    uint32_t u, count;
+
+    assert_int_equal(lyd_vmetrics_enable(st->ctx, 1), 0);
+
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_non_null(st->dt);
+
+    vmetrics = lyd_vmetrics_get(st->ctx, &count);
+    assert_non_null(vmetrics);
+    assert_int_equal(count, 4);
+
+    m = find_vmetric(vmetrics, count, LYD_VMETRIC_MUST);
+    assert_non_null(m);
+    assert_string_equal(m->path, "/vm:c");
+    assert_string_equal(m->expr, "count(l) < 100");
+    assert_int_equal(m->count, 1);
+
+    m = find_vmetric(vmetrics, count, LYD_VMETRIC_WHEN);
+    assert_non_null(m);
+    assert_string_equal(m->path, "/vm:c/l/w");
+    assert_string_equal(m->expr, "../v > 1");
+    /* evaluated at least once for each instance */
+    assert_true(m->count >= 2);
+
+    m = find_vmetric(vmetrics, count, LYD_VMETRIC_LEAFREF);
+    assert_non_null(m);
+    assert_string_equal(m->path, "/vm:c/l/r");
+    assert_string_equal(m->expr, "../../l/k");
+    assert_int_equal(m->count, 2);
+
+    m = find_vmetric(vmetrics, count, LYD_VMETRIC_UNIQUE);
+    assert_non_null(m);
+    assert_string_equal(m->path, "/vm:c/l");
+    assert_null(m->expr);
+    assert_int_not_equal(m->count, 0);
+
+    /* ordered by time */
+    for (u = 1; u < count; ++u) {
+        assert_true(vmetrics[u - 1].time >= vmetrics[u].time);
+    }
+    free(vmetrics);
+
+    /* accumulated over validations */
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    vmetrics = lyd_vmetrics_get(st->ctx, &count);
+    assert_non_null(vmetrics);
+    m = find_vmetric(vmetrics, count, LYD_VMETRIC_MUST);
+    assert_non_null(m);
+    assert_int_equal(m->count, 2);
+    free(vmetrics);
+
+    /* reset */
+    lyd_vmetrics_reset(st->ctx);
+    assert_null(lyd_vmetrics_get(st->ctx, &count));
+    assert_int_equal(count, 0);
+
+    /* disable */
+    assert_int_equal(lyd_vmetrics_enable(st->ctx, 0), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_null(lyd_vmetrics_get(st->ctx, &count));
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_disabled, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_collect, setup_f, teardown_f),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
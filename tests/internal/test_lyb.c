@@ -658,6 +658,543 @@ test_leafrefs(void **state)
     check_data_tree(st->dt1, st->dt2);
 }
 
+static void
+test_index(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod;
+    struct lyd_node *node;
+    struct ly_set *set;
+    char path[64], value[512], *str1, *str2;
+    int i, len;
+    const char *test_index =
+    "module test-index {"
+    "   namespace \"urn:test-index\";"
+    "   prefix ti;"
+    ""
+    "   container c {"
+    "       list l {"
+    "           key \"k1 k2\";"
+    "           leaf k1 { type uint16; }"
+    "           leaf k2 { type string; }"
+    "           leaf v { type string; }"
+    "           leaf-list ll { type int8; }"
+    "       }"
+    "       leaf x { type string; }"
+    "   }"
+    "   list top {"
+    "       key \"k\";"
+    "       leaf k { type string; }"
+    "       leaf v { type string; }"
+    "   }"
+    "   leaf t { type string; }"
+    "}";
+
+    mod = lys_parse_mem(st->ctx, test_index, LYS_YANG);
+    assert_non_null(mod);
+
+    /* values of different lengths so that the list instances start in various chunk positions */
+    st->dt1 = lyd_new_path(NULL, st->ctx, "/test-index:c/x", "x", 0, 0);
+    assert_non_null(st->dt1);
+    for (i = 0; i < 300; ++i) {
+        sprintf(path, "/test-index:c/l[k1='%d'][k2='n%d']/v", i, i);
+        memset(value, 'a' + i % 26, (i * 7) % 400);
+        value[(i * 7) % 400] = '\0';
+        assert_non_null(lyd_new_path(st->dt1, NULL, path, value, 0, 0));
+        sprintf(path, "/test-index:c/l[k1='%d'][k2='n%d']/ll", i, i);
+        sprintf(value, "%d", i % 100);
+        assert_non_null(lyd_new_path(st->dt1, NULL, path, value, 0, 0));
+    }
+    for (i = 0; i < 20; ++i) {
+        sprintf(path, "/test-index:top[k='t%d']/v", i);
+        assert_non_null(lyd_new_path(st->dt1, NULL, path, "value", 0, 0));
+    }
+    assert_non_null(lyd_new_path(st->dt1, NULL, "/test-index:t", "leaf", 0, 0));
+    assert_int_equal(lyd_validate(&st->dt1, LYD_OPT_CONFIG, NULL), 0);
+
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_INDEX), 0);
+    len = lyd_lyb_data_length(st->mem);
+    assert_true(len > 0);
+
+    /* the data can be parsed normally */
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    /* list instances */
+    for (i = 0; i < 300; ++i) {
+        sprintf(path, "/test-index:c/l[k1='%d'][k2='n%d']", i, i);
+        node = lyd_lyb_parse_subtree(st->ctx, st->mem, len, LYD_OPT_CONFIG | LYD_OPT_STRICT, path);
+        assert_non_null(node);
+        assert_string_equal(node->schema->name, "c");
+        assert_non_null(node->child);
+        assert_null(node->child->next);
+
+        set = lyd_find_path(st->dt1, path);
+        assert_int_equal(set->number, 1);
+        lyd_print_mem(&str1, set->set.d[0], LYD_XML, 0);
+        ly_set_free(set);
+        lyd_print_mem(&str2, node->child, LYD_XML, 0);
+        assert_string_equal(str1, str2);
+        free(str1);
+        free(str2);
+        lyd_free(node);
+    }
+
+    /* whole top-level subtrees */
+    node = lyd_lyb_parse_subtree(st->ctx, st->mem, len, LYD_OPT_CONFIG, "/test-index:top[k='t13']");
+    assert_non_null(node);
+    assert_string_equal(((struct lyd_node_leaf_list *)node->child->next)->value_str, "value");
+    lyd_free(node);
+    node = lyd_lyb_parse_subtree(st->ctx, st->mem, len, LYD_OPT_CONFIG, "/test-index:t");
+    assert_non_null(node);
+    assert_string_equal(((struct lyd_node_leaf_list *)node)->value_str, "leaf");
+    lyd_free(node);
+
+    /* not present */
+    assert_null(lyd_lyb_parse_subtree(st->ctx, st->mem, len, LYD_OPT_CONFIG, "/test-index:c/l[k1='1'][k2='n2']"));
+    assert_null(lyd_lyb_parse_subtree(st->ctx, st->mem, len, LYD_OPT_CONFIG, "/test-index:top[k='t20']"));
+
+    /* no index */
+    free(st->mem);
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    assert_true(lyd_lyb_data_length(st->mem) < len);
+    assert_null(lyd_lyb_parse_subtree(st->ctx, st->mem, lyd_lyb_data_length(st->mem), LYD_OPT_CONFIG, "/test-index:t"));
+
+    /* unknown header flag (the header follows the magic number) */
+    st->mem[3] |= 0x80;
+    assert_null(lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG));
+    assert_int_equal(lyd_lyb_data_length(st->mem), -1);
+}
+
+static void
+test_compact(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+    char path[64], *mem;
+    int i, len;
+    const char *test_compact =
+    "module test-compact {"
+    "   namespace \"urn:test-compact\";"
+    "   prefix tc;"
+    ""
+    "   list l {"
+    "       key \"k\";"
+    "       leaf k { type int32; }"
+    "       leaf state { type enumeration { enum up; enum down; } }"
+    "       leaf descr { type string; }"
+    "       leaf counter { type uint64; }"
+    "   }"
+    "}";
+
+    /* all the types, including the extreme numbers */
+    ly_ctx_set_searchdir(st->ctx, TESTS_DIR"/data/files");
+    assert_non_null(ly_ctx_load_module(st->ctx, "types", NULL));
+
+    st->dt1 = lyd_parse_path(st->ctx, TESTS_DIR"/data/files/types.xml", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_COMPACT), 0);
+
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    lyd_free_withsiblings(st->dt1);
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = NULL;
+    free(st->mem);
+
+    /* repeated strings and small numbers */
+    assert_non_null(lys_parse_mem(st->ctx, test_compact, LYS_YANG));
+    st->dt1 = NULL;
+    for (i = 0; i < 200; ++i) {
+        sprintf(path, "/test-compact:l[k='%d']/state", i - 100);
+        node = lyd_new_path(st->dt1, st->ctx, path, i % 3 ? "up" : "down", 0, 0);
+        assert_non_null(node);
+        if (!st->dt1) {
+            st->dt1 = node;
+        }
+        sprintf(path, "/test-compact:l[k='%d']/descr", i - 100);
+        assert_non_null(lyd_new_path(st->dt1, NULL, path, i % 2 ? "uplink port" : "downlink port", 0, 0));
+        sprintf(path, "/test-compact:l[k='%d']/counter", i - 100);
+        assert_non_null(lyd_new_path(st->dt1, NULL, path, i % 4 ? "12" : "18446744073709551615", 0, 0));
+    }
+    assert_int_equal(lyd_validate(&st->dt1, LYD_OPT_CONFIG, NULL), 0);
+
+    assert_int_equal(lyd_print_mem(&mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    len = lyd_lyb_data_length(mem);
+    free(mem);
+
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_COMPACT | LYP_LYB_INDEX), 0);
+    assert_true(lyd_lyb_data_length(st->mem) > 0);
+    assert_true(lyd_lyb_data_length(st->mem) < len);
+    len = lyd_lyb_data_length(st->mem);
+
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    /* the string table is used for single subtrees as well */
+    node = lyd_lyb_parse_subtree(st->ctx, st->mem, len, LYD_OPT_CONFIG, "/test-compact:l[k='-99']");
+    assert_non_null(node);
+    assert_string_equal(((struct lyd_node_leaf_list *)node->child->next)->value_str, "up");
+    assert_string_equal(((struct lyd_node_leaf_list *)node->child->next->next)->value_str, "uplink port");
+    assert_int_equal(((struct lyd_node_leaf_list *)node->child->next->next->next)->value.uint64, 12);
+    lyd_free(node);
+}
+
+struct stream_arg {
+    char *buf;
+    size_t len;
+    size_t max_write;
+};
+
+static ssize_t
+stream_clb(void *arg, const void *buf, size_t count)
+{
+    struct stream_arg *sarg = arg;
+
+    sarg->buf = realloc(sarg->buf, sarg->len + count);
+    assert_non_null(sarg->buf);
+    memcpy(sarg->buf + sarg->len, buf, count);
+    sarg->len += count;
+    if (count > sarg->max_write) {
+        sarg->max_write = count;
+    }
+
+    return count;
+}
+
+static void
+test_stream(void **state)
+{
+    struct state *st = (*state);
+    struct stream_arg sarg = {NULL, 0, 0};
+    char path[64], value[256];
+    int i, len;
+    const char *test_stream =
+    "module test-stream {"
+    "   namespace \"urn:test-stream\";"
+    "   prefix ts;"
+    ""
+    "   container c {"
+    "       list l {"
+    "           key \"k\";"
+    "           leaf k { type uint32; }"
+    "           container d {"
+    "               leaf v { type string; }"
+    "           }"
+    "       }"
+    "   }"
+    "}";
+
+    assert_non_null(lys_parse_mem(st->ctx, test_stream, LYS_YANG));
+
+    /* a single large top-level subtree */
+    for (i = 0; i < 1000; ++i) {
+        sprintf(path, "/test-stream:c/l[k='%d']/d/v", i);
+        memset(value, 'a' + i % 26, i % 255);
+        value[i % 255] = '\0';
+        if (!st->dt1) {
+            st->dt1 = lyd_new_path(NULL, st->ctx, path, value, 0, 0);
+            assert_non_null(st->dt1);
+        } else {
+            assert_non_null(lyd_new_path(st->dt1, NULL, path, value, 0, 0));
+        }
+    }
+    assert_int_equal(lyd_validate(&st->dt1, LYD_OPT_CONFIG, NULL), 0);
+
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    len = lyd_lyb_data_length(st->mem);
+    assert_true(len > 0);
+
+    /* the same data are written continuously, not buffered until the subtree is finished */
+    assert_int_equal(lyd_print_clb(stream_clb, &sarg, st->dt1, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    assert_int_equal(sarg.len, len);
+    assert_int_equal(memcmp(sarg.buf, st->mem, len), 0);
+    assert_true(sarg.max_write < (size_t)len / 4);
+
+    st->dt2 = lyd_parse_mem(st->ctx, sarg.buf, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+    free(sarg.buf);
+}
+
+static void
+test_diff(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod;
+    struct lyd_node *target, *node;
+    struct lyd_difflist *diff;
+    struct ly_set *set;
+    char path[64], *str1, *str2, *full;
+    int i;
+    const char *test_diff =
+    "module test-diff {"
+    "   namespace \"urn:test-diff\";"
+    "   prefix td;"
+    ""
+    "   container c {"
+    "       leaf name { type string; }"
+    "       list l {"
+    "           key \"k\";"
+    "           leaf k { type uint32; }"
+    "           leaf v { type string; }"
+    "       }"
+    "       leaf-list ul { type string; ordered-by user; }"
+    "       list ol {"
+    "           key \"k\";"
+    "           ordered-by user;"
+    "           leaf k { type string; }"
+    "       }"
+    "   }"
+    "   leaf t { type int32; }"
+    "   leaf u { type string; }"
+    "   anydata a;"
+    "   container r {"
+    "       leaf ref { type leafref { path \"/td:u\"; } }"
+    "   }"
+    "}";
+    LYD_DIFFTYPE types[] = {LYD_DIFF_CREATED, LYD_DIFF_DELETED, LYD_DIFF_END};
+    struct lyd_node *firsts[3] = {NULL}, *seconds[3] = {NULL};
+    struct lyd_difflist crafted = {types, firsts, seconds};
+
+    mod = lys_parse_mem(st->ctx, test_diff, LYS_YANG);
+    assert_non_null(mod);
+
+    st->dt1 = lyd_new_path(NULL, st->ctx, "/test-diff:c/name", "first", 0, 0);
+    assert_non_null(st->dt1);
+    for (i = 0; i < 100; ++i) {
+        sprintf(path, "/test-diff:c/l[k='%d']/v", i);
+        assert_non_null(lyd_new_path(st->dt1, NULL, path, "value", 0, 0));
+    }
+    assert_non_null(lyd_new_path(st->dt1, NULL, "/test-diff:c/ul", "a", 0, 0));
+    assert_non_null(lyd_new_path(st->dt1, NULL, "/test-diff:c/ul", "b", 0, 0));
+    assert_non_null(lyd_new_path(st->dt1, NULL, "/test-diff:c/ul", "c", 0, 0));
+    assert_non_null(lyd_new_path(st->dt1, NULL, "/test-diff:c/ol[k='x']", NULL, 0, 0));
+    assert_non_null(lyd_new_path(st->dt1, NULL, "/test-diff:c/ol[k='y']", NULL, 0, 0));
+    assert_non_null(lyd_new_path(st->dt1, NULL, "/test-diff:t", "5", 0, 0));
+    assert_int_equal(lyd_insert_sibling(&st->dt1, lyd_new_anydata(NULL, mod, "a", "old", LYD_ANYDATA_CONSTSTRING)), 0);
+    assert_int_equal(lyd_validate(&st->dt1, LYD_OPT_CONFIG, NULL), 0);
+
+    /* change, delete, create, and move some nodes */
+    st->dt2 = lyd_dup_withsiblings(st->dt1, LYD_DUP_OPT_RECURSIVE);
+    assert_non_null(st->dt2);
+    set = lyd_find_path(st->dt2, "/test-diff:c/name");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)set->set.d[0], "second"), 0);
+    ly_set_free(set);
+    set = lyd_find_path(st->dt2, "/test-diff:c/l[k='7']/v");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)set->set.d[0], "new value"), 0);
+    ly_set_free(set);
+    set = lyd_find_path(st->dt2, "/test-diff:c/l[k='50']");
+    assert_int_equal(set->number, 1);
+    lyd_free(set->set.d[0]);
+    ly_set_free(set);
+    set = lyd_find_path(st->dt2, "/test-diff:t");
+    assert_int_equal(set->number, 1);
+    lyd_free(set->set.d[0]);
+    ly_set_free(set);
+    assert_non_null(lyd_new_path(st->dt2, NULL, "/test-diff:c/l[k='1000']/v", "created", 0, 0));
+    assert_non_null(lyd_new_path(st->dt2, NULL, "/test-diff:u", "top", 0, 0));
+    set = lyd_find_path(st->dt2, "/test-diff:a");
+    assert_int_equal(set->number, 1);
+    node = set->set.d[0];
+    ly_set_free(set);
+    assert_int_equal(lyd_insert_after(node, lyd_new_anydata(NULL, mod, "a", "new", LYD_ANYDATA_CONSTSTRING)), 0);
+    lyd_free(node);
+    set = lyd_find_path(st->dt2, "/test-diff:c/ul[.='c']");
+    assert_int_equal(set->number, 1);
+    node = set->set.d[0];
+    ly_set_free(set);
+    set = lyd_find_path(st->dt2, "/test-diff:c/ul[.='a']");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(lyd_insert_before(set->set.d[0], node), 0);
+    ly_set_free(set);
+    set = lyd_find_path(st->dt2, "/test-diff:c/ol[k='x']");
+    assert_int_equal(set->number, 1);
+    node = set->set.d[0];
+    ly_set_free(set);
+    set = lyd_find_path(st->dt2, "/test-diff:c/ol[k='y']");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(lyd_insert_after(set->set.d[0], node), 0);
+    ly_set_free(set);
+    assert_non_null(lyd_new_path(st->dt2, NULL, "/test-diff:c/ol[k='z']", NULL, 0, LYD_PATH_OPT_UPDATE));
+    assert_int_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL), 0);
+
+    diff = lyd_diff(st->dt1, st->dt2, 0);
+    assert_non_null(diff);
+    assert_int_equal(lyd_lyb_print_diff(&st->mem, diff), 0);
+    lyd_free_diff(diff);
+
+    /* the change set is much smaller than the data and it is not a data tree */
+    assert_int_equal(lyd_print_mem(&full, st->dt2, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    assert_true(lyd_lyb_data_length(st->mem) > 0);
+    assert_true(lyd_lyb_data_length(st->mem) < lyd_lyb_data_length(full) / 4);
+    free(full);
+    assert_null(lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG));
+
+    /* apply it to another instance of the first tree */
+    target = lyd_dup_withsiblings(st->dt1, LYD_DUP_OPT_RECURSIVE);
+    assert_non_null(target);
+    assert_int_equal(lyd_lyb_apply_diff(&target, NULL, st->mem, LYD_OPT_CONFIG), 0);
+    assert_int_equal(lyd_validate(&target, LYD_OPT_CONFIG, NULL), 0);
+
+    /* only the order of instances of different schema nodes may differ */
+    diff = lyd_diff(st->dt2, target, 0);
+    assert_non_null(diff);
+    assert_int_equal(diff->type[0], LYD_DIFF_END);
+    lyd_free_diff(diff);
+    lyd_free_withsiblings(target);
+
+    /* the whole tree as a change set of an empty one */
+    free(st->mem);
+    diff = lyd_diff(NULL, st->dt2, 0);
+    assert_non_null(diff);
+    assert_int_equal(lyd_lyb_print_diff(&st->mem, diff), 0);
+    lyd_free_diff(diff);
+    target = NULL;
+    assert_int_equal(lyd_lyb_apply_diff(&target, st->ctx, st->mem, LYD_OPT_CONFIG), 0);
+    assert_int_equal(lyd_validate(&target, LYD_OPT_CONFIG, NULL), 0);
+    lyd_print_mem(&str1, st->dt2, LYD_XML, LYP_WITHSIBLINGS);
+    lyd_print_mem(&str2, target, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(str1, str2);
+    free(str1);
+    free(str2);
+    lyd_free_withsiblings(target);
+
+    /* a node with an unresolved leafref created and deleted again by the same change set */
+    free(st->mem);
+    node = lyd_new_path(NULL, st->ctx, "/test-diff:r/ref", "none", 0, 0);
+    assert_non_null(node);
+    seconds[0] = node;
+    firsts[1] = node;
+    assert_int_equal(lyd_lyb_print_diff(&st->mem, &crafted), 0);
+    lyd_free(node);
+    target = lyd_dup_withsiblings(st->dt2, LYD_DUP_OPT_RECURSIVE);
+    assert_non_null(target);
+    assert_int_equal(lyd_lyb_apply_diff(&target, NULL, st->mem, LYD_OPT_CONFIG), 0);
+    set = lyd_find_path(target, "/test-diff:r");
+    assert_int_equal(set->number, 0);
+    ly_set_free(set);
+    lyd_free_withsiblings(target);
+}
+
+static void
+test_threads(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+    struct ly_ctx *ctx;
+    char *xml, *str1, *str2;
+    int i, len = 0;
+    const char *test_threads =
+    "module test-threads {"
+    "   namespace \"urn:test-threads\";"
+    "   prefix tt;"
+    ""
+    "   import ietf-inet-types { prefix inet; }"
+    ""
+    "   container c {"
+    "       list l {"
+    "           key \"k\";"
+    "           leaf k { type uint32; }"
+    "           leaf v { type string; }"
+    "           leaf ref { type leafref { path \"/tt:tl/tt:name\"; } }"
+    "           leaf code { type string { pattern \"[A-Z]{2}-[0-9]+\"; } }"
+    "           leaf addr { type inet:ip-address; }"
+    "           leaf prefix { type inet:ipv6-prefix; }"
+    "           leaf host { type inet:domain-name; }"
+    "       }"
+    "   }"
+    "   list tl {"
+    "       key \"name\";"
+    "       leaf name { type string; }"
+    "       leaf extra { type string; }"
+    "   }"
+    "}";
+    const char *test_threads_old =
+    "module test-threads {"
+    "   namespace \"urn:test-threads\";"
+    "   prefix tt;"
+    ""
+    "   list tl {"
+    "       key \"name\";"
+    "       leaf name { type string; }"
+    "   }"
+    "}";
+
+    assert_non_null(lys_parse_mem(st->ctx, test_threads, LYS_YANG));
+
+    /* do not depend on the number of CPUs */
+    lyb_set_thread_count(4);
+
+    /* many top-level subtrees and a large one with many list instances */
+    xml = malloc(300 * 3000);
+    assert_non_null(xml);
+    for (i = 0; i < 300; ++i) {
+        len += sprintf(xml + len, "<tl xmlns=\"urn:test-threads\"><name>n%d</name><extra>extra value %d</extra></tl>", i, i);
+    }
+    len += sprintf(xml + len, "<c xmlns=\"urn:test-threads\">");
+    for (i = 0; i < 3000; ++i) {
+        len += sprintf(xml + len, "<l><k>%d</k><v>value %d</v><ref>n%d</ref><code>AB-%d</code>", i, i, (i * 7) % 300, i);
+        len += sprintf(xml + len, "<addr>%s</addr><prefix>2001:DB8:%x::/48</prefix><host>h%d.example.com</host></l>",
+                       (i % 2) ? "10.0.0.1" : "FE80::1", i, i);
+    }
+    sprintf(xml + len, "</c>");
+    st->dt1 = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    free(xml);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_THREADS);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    lyd_free_withsiblings(st->dt2);
+    free(st->mem);
+
+    /* the list instances are split among the threads using the index */
+    assert_int_equal(lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS | LYP_LYB_INDEX | LYP_LYB_COMPACT), 0);
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_THREADS);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+
+    /* the leafrefs were resolved */
+    node = st->dt2->prev;
+    assert_string_equal(node->schema->name, "c");
+    assert_ptr_not_equal(((struct lyd_node_leaf_list *)node->child->prev->child->next->next)->value.leafref, NULL);
+
+    /* the schema caches of another context are filled by the threads */
+    ctx = ly_ctx_new(NULL, 0);
+    assert_non_null(ctx);
+    assert_non_null(lys_parse_mem(ctx, test_threads, LYS_YANG));
+    node = lyd_parse_mem(ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_THREADS);
+    assert_non_null(node);
+    assert_int_equal(lyd_print_mem(&str1, st->dt1, LYD_XML, LYP_WITHSIBLINGS), 0);
+    assert_int_equal(lyd_print_mem(&str2, node, LYD_XML, LYP_WITHSIBLINGS), 0);
+    assert_string_equal(str1, str2);
+    free(str1);
+    free(str2);
+    lyd_free_withsiblings(node);
+    ly_ctx_destroy(ctx, NULL);
+
+    /* errors of all the threads are reported */
+    ctx = ly_ctx_new(NULL, 0);
+    assert_non_null(ctx);
+    assert_non_null(lys_parse_mem(ctx, test_threads_old, LYS_YANG));
+    assert_null(lyd_parse_mem(ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_THREADS));
+    assert_int_equal(ly_errno, LY_EVALID);
+    assert_non_null(ly_errmsg(ctx));
+    ly_ctx_destroy(ctx, NULL);
+
+    lyb_set_thread_count(0);
+}
+
 int
 main(void)
 {
@@ -676,6 +1213,11 @@ main(void)
         cmocka_unit_test_setup_teardown(test_submodule_feature, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_coliding_augments, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_leafrefs, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_index, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_compact, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_stream, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_diff, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_threads, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
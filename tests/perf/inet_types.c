@@ -0,0 +1,99 @@
+/**
+ * @file inet_types.c
+ * @brief performance test - parsing ietf-inet-types values.
+ *
+ * Copyright (c) 2020 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+    "module inet-perf {"
+        "namespace urn:libyang:performance:inet;"
+        "prefix ip;"
+        "import ietf-inet-types {prefix inet;}"
+        "container addrs {"
+            "leaf-list addr {type inet:ip-address;}"
+            "leaf-list prefix {type inet:ip-prefix;}"
+        "}"
+    "}";
+
+int main(int argc, char *argv[])
+{
+    int i, count = 1000000, ret = 1;
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *data = NULL;
+    struct timespec start, end;
+    char *xml = NULL, *ptr;
+    double secs;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    /* libyang context */
+    ctx = ly_ctx_new(NULL, 0);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+
+    /* schema */
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    /* data, every fourth value is an IPv6 address, every eighth a prefix */
+    ptr = xml = malloc(count * 64 + 128);
+    if (!xml) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        goto cleanup;
+    }
+    ptr += sprintf(ptr, "<addrs xmlns=\"urn:libyang:performance:inet\">");
+    for (i = 0; i < count; ++i) {
+        switch (i % 8) {
+        case 3:
+            ptr += sprintf(ptr, "<addr>2001:db8:%x::%x:%x</addr>", i >> 16, (i >> 8) & 0xff, i & 0xff);
+            break;
+        case 7:
+            ptr += sprintf(ptr, "<prefix>%d.%d.%d.%d/30</prefix>", (i >> 24) + 10, (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff);
+            break;
+        default:
+            ptr += sprintf(ptr, "<addr>%d.%d.%d.%d%s</addr>", (i >> 24) + 10, (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff,
+                           (i % 8 == 5) ? "%eth0" : "");
+            break;
+        }
+    }
+    sprintf(ptr, "</addrs>");
+
+    printf("Parsing %d addresses...\n", count);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!data) {
+        fprintf(stderr, "Failed to parse data.\n");
+        goto cleanup;
+    }
+
+    secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf(" time  : %.3fs\n per value: %.0fns\n", secs, secs * 1e9 / count);
+    ret = 0;
+
+cleanup:
+    free(xml);
+    lyd_free_withsiblings(data);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
@@ -437,6 +437,48 @@ test_import_augment_leafref_imported(void **state)
     assert_true(module && !module->implemented);
 }
 
+static void
+test_data_after_augment(void **state)
+{
+    const char *base = "module base-wide {namespace urn:base-wide; prefix bw;"
+        "container c {leaf l1 {type string;} leaf l2 {type string;} leaf l3 {type string;} leaf l4 {type string;}"
+        "choice ch {leaf l5 {type string;} leaf l6 {type string;}}}}";
+    const char *aug = "module aug-wide {namespace urn:aug-wide; prefix aw; import base-wide {prefix bw;}"
+        "augment /bw:c {leaf l1 {type string;} leaf a2 {type string;}}}";
+    const char *xml = "<c xmlns=\"urn:base-wide\"><l1>a</l1><l6>b</l6><l1 xmlns=\"urn:aug-wide\">c</l1></c>";
+    const struct lys_module *module;
+    struct lyd_node *data, *node;
+
+    (void)state; /* unused state */
+
+    module = lys_parse_mem(ctx, base, LYS_IN_YANG);
+    assert_non_null(module);
+
+    /* lookups before the augment is applied */
+    data = lyd_new_path(NULL, ctx, "/base-wide:c/l6", "b", 0, 0);
+    assert_non_null(data);
+    assert_null(lyd_new_path(data, NULL, "/base-wide:c/aug-wide:a2", "x", 0, 0));
+    lyd_free_withsiblings(data);
+
+    /* the augment changes the children of the container */
+    module = lys_parse_mem(ctx, aug, LYS_IN_YANG);
+    assert_non_null(module);
+
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_non_null(data);
+    node = data->child->prev;
+    assert_string_equal(node->schema->name, "l1");
+    assert_ptr_equal(lys_node_module(node->schema), module);
+    node = lyd_new_path(data, NULL, "/base-wide:c/aug-wide:a2", "x", 0, 0);
+    assert_non_null(node);
+    assert_ptr_equal(lys_node_module(node->schema), module);
+    lyd_free_withsiblings(data);
+
+    /* and removes them again */
+    assert_int_equal(ly_ctx_remove_module(module, NULL), 0);
+    assert_null(lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT));
+}
+
 static void
 compare_output(void **state)
 {
@@ -497,6 +539,7 @@ main(void)
         cmocka_unit_test_setup_teardown(test_imp_aug, setup_ctx_yang, teardown_ctx),
         cmocka_unit_test_setup_teardown(test_import_augment_leafref_implemented, setup_ctx_yang, teardown_ctx),
         cmocka_unit_test_setup_teardown(test_import_augment_leafref_imported, setup_ctx_yang, teardown_ctx),
+        cmocka_unit_test_setup_teardown(test_data_after_augment, setup_ctx_yang, teardown_ctx),
 
         cmocka_unit_test_teardown(compare_output, teardown_output),
     };
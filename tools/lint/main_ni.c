@@ -66,6 +66,8 @@ help(int shortout)
         "                        has no effect for schemas.\n\n"
         "  -m, --merge           Merge input data files into a single tree and validate at once,\n"
         "                        has no effect for the auto, rpc, rpcreply and notif TYPEs.\n\n"
+        "  -M, --metrics         Print the number of evaluations and cumulative time of the must, when,\n"
+        "                        leafref, and unique constraints in the validated data, the most expensive first.\n\n"
         "  -f FORMAT, --format=FORMAT\n"
         "                        Convert to FORMAT. Supported formats: \n"
         "                        yang, yin, tree, tree-rfc and jsons (JSON) for schemas,\n"
@@ -242,6 +244,29 @@ get_fileformat(const char *filename, LYS_INFORMAT *schema, LYD_FORMAT *data)
     }
 }
 
+static void
+print_vmetrics(struct ly_ctx *ctx)
+{
+    struct lyd_vmetric *vmetrics;
+    uint32_t u, count;
+    const char *types[] = {"must", "when", "leafref", "unique"};
+
+    vmetrics = lyd_vmetrics_get(ctx, &count);
+
+    fprintf(stderr, "Validation metrics:\n");
+    fprintf(stderr, "%12s %10s  %-8s %s\n", "time [us]", "count", "type", "node [expression]");
+    for (u = 0; u < count; ++u) {
+        fprintf(stderr, "%12.1f %10u  %-8s %s", vmetrics[u].time / 1000.0, vmetrics[u].count, types[vmetrics[u].type],
+                vmetrics[u].path);
+        if (vmetrics[u].expr) {
+            fprintf(stderr, " [%s]", vmetrics[u].expr);
+        }
+        fprintf(stderr, "\n");
+    }
+
+    free(vmetrics);
+}
+
 int
 main_ni(int argc, char* argv[])
 {
@@ -263,6 +288,7 @@ main_ni(int argc, char* argv[])
         {"disable-cwd-search", no_argument,     NULL, 'D'},
         {"list",             no_argument,       NULL, 'l'},
         {"merge",            no_argument,       NULL, 'm'},
+        {"metrics",          no_argument,       NULL, 'M'},
         {"output",           required_argument, NULL, 'o'},
         {"path",             required_argument, NULL, 'p'},
         {"running",          required_argument, NULL, 'r'},
@@ -289,7 +315,7 @@ main_ni(int argc, char* argv[])
     struct stat st;
     uint32_t u;
     int options_dflt = 0, options_parser = 0, options_ctx = LY_CTX_NOYANGLIBRARY, envelope = 0, autodetection = 0;
-    int merge = 0, list = 0, outoptions_s = 0, outline_length_s = 0;
+    int merge = 0, list = 0, metrics = 0, outoptions_s = 0, outline_length_s = 0;
     struct dataitem {
         const char *filename;
         struct lyxml_elem *xml;
@@ -306,9 +332,9 @@ main_ni(int argc, char* argv[])
 
     opterr = 0;
 #ifndef NDEBUG
-    while ((opt = getopt_long(argc, argv, "ad:f:F:gunP:L:hHiDlmo:p:r:O:st:vVG:y:", options, &opt_index)) != -1)
+    while ((opt = getopt_long(argc, argv, "ad:f:F:gunP:L:hHiDlmMo:p:r:O:st:vVG:y:", options, &opt_index)) != -1)
 #else
-    while ((opt = getopt_long(argc, argv, "ad:f:F:gunP:L:hHiDlmo:p:r:O:st:vVy:", options, &opt_index)) != -1)
+    while ((opt = getopt_long(argc, argv, "ad:f:F:gunP:L:hHiDlmMo:p:r:O:st:vVy:", options, &opt_index)) != -1)
 #endif
     {
         switch (opt) {
@@ -423,6 +449,9 @@ main_ni(int argc, char* argv[])
         case 'm':
             merge = 1;
             break;
+        case 'M':
+            metrics = 1;
+            break;
         case 'o':
             if (out != stdout) {
                 fclose(out);
@@ -620,6 +649,9 @@ main_ni(int argc, char* argv[])
     if (!ctx) {
         goto cleanup;
     }
+    if (metrics && lyd_vmetrics_enable(ctx, 1)) {
+        goto cleanup;
+    }
 
     /* set searchpaths */
     if (searchpaths) {
@@ -1014,6 +1046,10 @@ parse_reply:
         }
     }
 
+    if (metrics) {
+        print_vmetrics(ctx);
+    }
+
     if (list) {
         print_list(out, ctx, outformat_d);
     }